@@ -6,10 +6,16 @@
 #define LDPC4QKD_CODE_SIMULATION_HELPERS_HPP
 
 #include <filesystem> // C++17
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <sstream>
 
 #include "external/json-6af826d/json.hpp"  // external json parser library
 
 #include "LDPC4QKD/read_ldpc_file_formats.hpp"
+#include "LDPC4QKD/ldpc_file_conversion.hpp"
 #include "LDPC4QKD/rate_adaptive_code.hpp"
 
 
@@ -45,6 +51,124 @@ namespace LDPC4QKD::CodeSimulationHelpers {
     }
 
 
+    /// Percentile `q` (between 0 and 100) of the values `in` (nearest-rank method). `in` must not be empty.
+    template<typename T>
+    T percentile(std::vector<T> in, double q) {
+        const auto rank = static_cast<std::size_t>(std::ceil(q / 100. * static_cast<double>(in.size())));
+        const auto idx = std::min(in.size() - 1, (rank == 0) ? 0 : rank - 1);
+        std::nth_element(in.begin(), in.begin() + static_cast<std::ptrdiff_t>(idx), in.end());
+        return in[idx];
+    }
+
+
+    /// Parses a comma separated list, e.g. "0.01,0.02,0.03" or "20,50".
+    template<typename T>
+    std::vector<T> parse_comma_separated(const std::string &in) {
+        std::vector<T> ret;
+        std::stringstream s(in);
+        std::string item;
+        while (std::getline(s, item, ',')) {
+            std::stringstream item_stream(item);
+            T value{};
+            if (!(item_stream >> value)) {
+                throw std::runtime_error("Failed to parse item '" + item + "' of comma separated list '" + in + "'.");
+            }
+            ret.push_back(value);
+        }
+        return ret;
+    }
+
+
+    /*!
+     * Wilson score interval for the frame error rate (FER), given the number of observed frame errors.
+     * Unlike the naive normal approximation, this also gives a sensible upper bound if no errors were observed.
+     *
+     * @param n_frame_errors number of observed frame errors
+     * @param n_frames number of simulated frames
+     * @param z quantile of the standard normal distribution (1.96 gives a 95% confidence interval)
+     * @return lower and upper end of the confidence interval
+     */
+    inline std::pair<double, double> wilson_score_interval(std::size_t n_frame_errors, std::size_t n_frames,
+                                                           double z = 1.96) {
+        if (n_frames == 0) {
+            return {0., 1.};
+        }
+        const auto n = static_cast<double>(n_frames);
+        const double fer = static_cast<double>(n_frame_errors) / n;
+        const double denominator = 1 + z * z / n;
+        const double center = (fer + z * z / (2 * n)) / denominator;
+        const double half_width = z * std::sqrt(fer * (1 - fer) / n + z * z / (4 * n * n)) / denominator;
+        return {std::max(0., center - half_width), std::min(1., center + half_width)};
+    }
+
+
+    /// Result of a frame error rate (FER) simulation. See `simulate_frame_errors`.
+    struct FrameErrorStatistics {
+        std::size_t n_frames{};
+        std::size_t n_frame_errors{};
+        double decoding_seconds{};  /// time spent inside the decoder only (excludes encoding and channel simulation)
+
+        [[nodiscard]] double fer() const {
+            return (n_frames == 0) ? 0. : static_cast<double>(n_frame_errors) / static_cast<double>(n_frames);
+        }
+
+        FrameErrorStatistics &operator+=(const FrameErrorStatistics &rhs) {
+            n_frames += rhs.n_frames;
+            n_frame_errors += rhs.n_frame_errors;
+            decoding_seconds += rhs.decoding_seconds;
+            return *this;
+        }
+    };
+
+
+    /*!
+     * Simulates frame errors of the code `H` at its current rate on a binary symmetric channel.
+     * Since `H` is not modified, several threads may run this function on the same code concurrently.
+     *
+     * @param H LDPC code. The rate adaption that is currently set is used.
+     * @param p channel parameter (bit flip probability) of the binary symmetric channel
+     * @param decoder_config settings of the decoder
+     * @param max_frames number of frames to simulate
+     * @param max_frame_errors stop early after this many frame errors. Specify zero for 'no condition'.
+     * @param seed seed for the random bit-strings and the channel. Same seed gives the same frames.
+     * @return number of simulated frames, number of frame errors and time spent decoding
+     */
+    template<typename idx_t>
+    FrameErrorStatistics simulate_frame_errors(const LDPC4QKD::RateAdaptiveCode<idx_t> &H,
+                                               double p,
+                                               const LDPC4QKD::DecoderConfig &decoder_config,
+                                               std::size_t max_frames,
+                                               std::size_t max_frame_errors,
+                                               std::uint64_t seed) {
+        std::mt19937_64 rng(seed);
+        FrameErrorStatistics result{};
+
+        std::vector<bool> x(H.getNCols());
+        std::vector<bool> syndrome;
+        std::vector<bool> solution;
+        while (result.n_frames < max_frames
+               && (max_frame_errors == 0 || result.n_frame_errors < max_frame_errors)) {
+            noise_bitstring_inplace(rng, x, 0.5);  // choose the true data randomly.
+            H.encode_at_current_rate(x, syndrome);
+
+            std::vector<bool> x_noised = x; // distorted data
+            noise_bitstring_inplace(rng, x_noised, p);
+            const std::vector<double> llrs = LDPC4QKD::llrs_bsc(x_noised, p);
+
+            auto begin = std::chrono::steady_clock::now();
+            bool success = H.decode_at_current_rate(llrs, syndrome, solution, decoder_config);
+            auto end = std::chrono::steady_clock::now();
+            result.decoding_seconds += std::chrono::duration<double>(end - begin).count();
+
+            result.n_frames++;
+            if (!success || solution != x) {
+                result.n_frame_errors++;
+            }
+        }
+        return result;
+    }
+
+
     /*!
      * Loads LDPC code (and optionally also rate adaption) from files.
      * WARNING: if the templated types are too small, the numbers in the files are static_cast down!
@@ -76,6 +200,33 @@ namespace LDPC4QKD::CodeSimulationHelpers {
         }
     }
 
+    /*!
+     * Creates a rate adaptive code from a binary matrix (see `LDPC4QKD/ldpc_file_conversion.hpp`).
+     * WARNING: if the templated types are too small, the numbers are static_cast down!
+     *
+     * @param matrix binary LDPC matrix (no QC-exponents, use `expand_qc_exponents` first)
+     * @param rate_adaption_file_path Path to load rate adaption from. If unspecified, no rate adaption is available.
+     * @return Rate adaptive code
+     */
+    template<typename colptr_t=std::uint32_t,
+            typename idx_t=std::uint32_t>
+    LDPC4QKD::RateAdaptiveCode<idx_t> code_from_sparse_matrix(
+            const LDPC4QKD::SparseMatrixCSC &matrix, const std::string &rate_adaption_file_path = ""
+    ) {
+        if (matrix.is_qc()) {
+            throw std::runtime_error("Expected a binary matrix, got quasi-cyclic exponents.");
+        }
+        std::vector<colptr_t> colptr(matrix.colptr.begin(), matrix.colptr.end());
+        std::vector<idx_t> rowval(matrix.rowval.begin(), matrix.rowval.end());
+
+        if (rate_adaption_file_path.empty()) {
+            return LDPC4QKD::RateAdaptiveCode<idx_t>(colptr, rowval);
+        } else {
+            std::vector<idx_t> rows_to_combine = read_rate_adaption_from_csv<idx_t>(rate_adaption_file_path);
+            return LDPC4QKD::RateAdaptiveCode<idx_t>(colptr, rowval, rows_to_combine);
+        }
+    }
+
     /*!
      * Loads LDPC code (and optionally also rate adaption) from files.
      * WARNING: if the templated types are too small, the numbers in the files are static_cast down!
@@ -84,7 +235,7 @@ namespace LDPC4QKD::CodeSimulationHelpers {
      * @tparam colptr_t unsigned integer type that fits ("number of non-zero matrix entries" + 1)
      * @tparam idx_t unsigned integer type fitting number of columns N (thus also number of rows M)
      * @param json_file_path path to json file, where the LDPC code is loaded from.
-     *      (no QC-exponents allowed, just binary compressed sparse column (CSC) representation!)
+     *      (`.bincsc.json` or `.qccsc.json`, QC-exponents are expanded)
      * @param rate_adaption_file_path Path to load rate adaption from.
      * (csv file of line index pairs, which are combined at each rate adaption step)
      *      If unspecified, no rate adaption will be available.
@@ -118,11 +269,9 @@ namespace LDPC4QKD::CodeSimulationHelpers {
                     return LDPC4QKD::RateAdaptiveCode<idx_t>(colptr, rowval, rows_to_combine);
                 }
             } else if (data["format"] == "COMPRESSED_SPARSE_COLUMN") { // quasi-cyclic exponents stored
-//                std::vector<std::uint64_t> colptr = data["colptr"];
-//                std::vector<std::uint64_t> rowval = data["rowval"];
-//                std::vector<std::uint64_t> nzval = data["nzval"];
-                    // TODO reconstructing the matrix from qc-exponents and storing as sparse needs some work...
-                throw std::runtime_error("Reading QC-exponents not supported yet! Use LDPCStorage.jl to convert to bincsc.json format!");
+                return code_from_sparse_matrix<colptr_t, idx_t>(
+                        LDPC4QKD::expand_qc_exponents(LDPC4QKD::read_csc_json(json_file_path)),
+                        rate_adaption_file_path);
             } else {
                 throw std::runtime_error("Unexpected format within json file.");
             }
@@ -145,7 +294,7 @@ namespace LDPC4QKD::CodeSimulationHelpers {
      * @tparam colptr_t unsigned integer type that fits ("number of non-zero matrix entries" + 1)
      * @tparam idx_t unsigned integer type fitting number of columns N (thus also number of rows M)
      * @param file_path path to file, where the LDPC code is loaded from.
-     *      (no QC-exponents allowed, just binary compressed sparse column (CSC) representation!)
+     *      (`.cscmat`, `.json`, `.alist` or `.cscbin`, QC-exponents are expanded)
      * @param rate_adaption_file_path Path to load rate adaption from.
      * (csv file of line index pairs, which are combined at each rate adaption step)
      *      If unspecified, no rate adaption will be available.
@@ -162,8 +311,11 @@ namespace LDPC4QKD::CodeSimulationHelpers {
             return load_ldpc_from_cscmat(file_path, rate_adaption_file_path);
         } else if (filePath.extension() == ".json") {
             return load_ldpc_from_json(file_path, rate_adaption_file_path);
+        } else if (filePath.extension() == ".alist" || filePath.extension() == ".cscbin") {
+            return code_from_sparse_matrix<colptr_t, idx_t>(
+                    LDPC4QKD::to_binary_matrix(LDPC4QKD::read_sparse_matrix(file_path)), rate_adaption_file_path);
         } else {
-            throw std::runtime_error("Expected file with extension .cscmat or .json");
+            throw std::runtime_error("Expected file with extension .cscmat, .json, .alist or .cscbin");
         }
     }
 
@@ -0,0 +1,452 @@
+//
+// Created by alice on 18.10.26.
+// Note: Names and meaning of command line parameters are defined below.
+//
+constexpr auto help_text =
+        "Blind Reconciliation Protocol Simulator for Rate Adapted LDPC Codes\n"
+        "\n"
+        "Unlike `critical_rate_simulation` (which searches the minimum rate offline, knowing the key), this program runs "
+        "the interactive protocol between two threads, Alice and Bob, connected by an in-process loopback link with a "
+        "configurable round-trip time:\n"
+        "- Alice computes the mother syndrome of her key and sends the syndrome at the highest rate "
+        "(or `--initial-syndrome-size` bits).\n"
+        "- Bob decodes (with at most `--iter-bp` iterations per round). If the decoder does not converge, Bob requests "
+        "more syndrome bits and Alice reveals the next `--increment` row combinations of the rate adaption "
+        "(one mother syndrome bit each). Bob then decodes at the new rate, starting from the messages of the previous "
+        "round (warm start, see `RateAdaptiveCode::decode_start_warm`), until success or until the mother matrix is "
+        "reached.\n"
+        "\n"
+        "With `--targeted`, Bob instead requests the `--increment` row combinations whose splitting is expected to help "
+        "most (`RateAdaptiveCode::rank_combinations_to_split`, based on the unsatisfied checks and posterior LLRs of "
+        "the failed round), Alice reveals exactly those and Bob continues on the partially split graph. The indices "
+        "sent by Bob are not counted as leaked bits (they depend only on Bob's data, not on Alice's key).\n"
+        "\n"
+        "With `--provisioning`, Alice chooses the initial syndrome size of each frame using the outcomes reported by "
+        "Bob for previous frames (`SyndromeProvisioningPolicy`): lowest expected latency within the leak budget "
+        "`--leak-budget`.\n"
+        "\n"
+        "Frames are reconciled one after the other. For each frame, the number of rounds, the leaked syndrome bits, "
+        "Bob's decoding time and the end-to-end latency (Alice sending the first syndrome until she receives the "
+        "result) are recorded. Distributions are printed at the end and can be saved as csv.";
+
+// Standard library
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <optional>
+
+// Command line argument parser library
+#include "external/CmdParser-91aaa61e/cmdparser.hpp"
+
+// Project scope
+#include "LDPC4QKD/rate_adaptive_code.hpp"
+#include "LDPC4QKD/read_ldpc_file_formats.hpp"
+#include "LDPC4QKD/syndrome_provisioning.hpp"
+#include "code_simulation_helpers.hpp"
+
+using namespace LDPC4QKD::CodeSimulationHelpers;
+
+using Clock = std::chrono::steady_clock;
+
+
+/// One direction of the loopback link. Messages arrive in order, `delay` after being sent.
+template<typename Message>
+class LoopbackLink {
+public:
+    explicit LoopbackLink(Clock::duration delay) : delay(delay) {}
+
+    void send(Message msg) {
+        {
+            std::lock_guard lock(mutex);
+            queue.emplace_back(Clock::now() + delay, std::move(msg));
+        }
+        cv.notify_one();
+    }
+
+    /// Blocks until the next message has arrived.
+    Message receive() {
+        std::unique_lock lock(mutex);
+        cv.wait(lock, [this] { return !queue.empty(); });
+        auto [arrival, msg] = std::move(queue.front());
+        queue.pop_front();
+        lock.unlock();
+        std::this_thread::sleep_until(arrival);
+        return msg;
+    }
+
+private:
+    const Clock::duration delay;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::pair<Clock::time_point, Message>> queue;
+};
+
+/// Alice to Bob: the syndrome at the initial rate, later the mother syndrome bits revealed by each round.
+struct SyndromeMessage {
+    std::vector<bool> bits;
+};
+
+/// Bob to Alice: either a request for more syndrome bits, or the end of the frame (with Bob's statistics).
+struct ReplyMessage {
+    bool done{};
+    bool success{};
+    std::size_t n_iterations{};
+    std::size_t n_rounds{};
+    std::vector<std::size_t> combinations;  // row combinations to split (targeted revelation)
+};
+
+/// Outcome of the protocol for one frame.
+struct FrameRecord {
+    bool success{};
+    std::size_t initial_syndrome_size{};
+    std::size_t n_rounds{};
+    std::size_t leaked_bits{};  // syndrome bits sent by Alice
+    std::size_t n_iterations{};  // decoder iterations, summed over all rounds
+    double decoding_seconds{};  // time Bob spent in the decoder
+    double latency_seconds{};  // Alice sending the first syndrome until receiving Bob's result
+};
+
+struct ProtocolSettings {
+    std::size_t initial_syndrome_size{};
+    std::size_t increment{};  // row combinations undone (syndrome bits revealed) per round
+    bool warm_start{};
+    bool targeted{};  // Bob requests the row combinations to split
+    LDPC4QKD::DecoderConfig decoder_config;
+    std::optional<LDPC4QKD::ProvisioningSettings> provisioning;  // if set, chooses the initial syndrome sizes
+};
+
+
+template<typename idx_t>
+std::vector<FrameRecord> run_protocol(const LDPC4QKD::RateAdaptiveCode<idx_t> &code,
+                                      const std::vector<std::vector<bool>> &keys_alice,
+                                      const std::vector<std::vector<double>> &llrs_bob,
+                                      const ProtocolSettings &settings,
+                                      Clock::duration one_way_delay) {
+    const auto n_frames = keys_alice.size();
+    const auto n_mother_rows = code.get_n_rows_mother_matrix();
+    std::vector<FrameRecord> records(n_frames);
+
+    LoopbackLink<SyndromeMessage> to_bob(one_way_delay);
+    LoopbackLink<ReplyMessage> to_alice(one_way_delay);
+
+    std::thread alice([&] {
+        std::optional<LDPC4QKD::SyndromeProvisioningPolicy> policy;
+        if (settings.provisioning) {
+            policy.emplace(code, *settings.provisioning);
+        }
+        for (std::size_t frame_idx{}; frame_idx < n_frames; ++frame_idx) {
+            const auto begin = Clock::now();
+            std::vector<bool> mother_syndrome;
+            code.encode_no_ra(keys_alice[frame_idx], mother_syndrome);
+
+            auto &record = records[frame_idx];
+            record.initial_syndrome_size = policy ? policy->next_syndrome_size() : settings.initial_syndrome_size;
+            std::vector<bool> syndrome;
+            code.rate_adapt_syndrome(mother_syndrome, syndrome, record.initial_syndrome_size);
+            to_bob.send(SyndromeMessage{std::move(syndrome)});
+            record.leaked_bits = record.initial_syndrome_size;
+
+            while (true) {
+                const auto reply = to_alice.receive();
+                if (reply.done) {
+                    record.latency_seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+                    if (policy) {
+                        policy->report(record.initial_syndrome_size, record.leaked_bits, reply.success,
+                                       reply.n_iterations, reply.n_rounds);
+                    }
+                    break;
+                }
+                if (settings.targeted) {
+                    to_bob.send(SyndromeMessage{
+                            LDPC4QKD::targeted_syndrome_increment(code, mother_syndrome, reply.combinations)});
+                    record.leaked_bits += reply.combinations.size();
+                    continue;
+                }
+                const auto new_size = std::min(n_mother_rows, record.leaked_bits + settings.increment);
+                to_bob.send(SyndromeMessage{
+                        LDPC4QKD::syndrome_increment(code, mother_syndrome, record.leaked_bits, new_size)});
+                record.leaked_bits = new_size;
+            }
+        }
+    });
+
+    std::thread bob([&] {
+        auto H = code;  // Bob changes the rate of his copy of the code
+        LDPC4QKD::DecoderWorkspace workspace;
+        for (std::size_t frame_idx{}; frame_idx < n_frames; ++frame_idx) {
+            const auto &llrs = llrs_bob[frame_idx];
+            auto &record = records[frame_idx];
+            auto msg = to_bob.receive();
+            std::vector<bool> syndrome = std::move(msg.bits);
+            auto combinations = H.combinations_at_rate(n_mother_rows - syndrome.size());
+            auto previous_combinations = combinations;
+            std::vector<bool> out;
+
+            while (true) {
+                record.n_rounds++;
+                const auto begin = Clock::now();
+                H.set_combinations(combinations);
+                if (settings.warm_start && record.n_rounds > 1) {
+                    H.decode_start_warm(llrs, syndrome, workspace, previous_combinations);
+                } else {
+                    H.decode_start(llrs, syndrome, workspace);
+                }
+                const auto status = H.decode_continue(llrs, syndrome, out, settings.decoder_config, workspace,
+                                                      std::numeric_limits<std::size_t>::max());
+                record.decoding_seconds += std::chrono::duration<double>(Clock::now() - begin).count();
+                record.n_iterations += workspace.n_iterations;
+
+                if (status == LDPC4QKD::DecoderStatus::converged || syndrome.size() == n_mother_rows) {
+                    record.success = (status == LDPC4QKD::DecoderStatus::converged);
+                    to_alice.send(ReplyMessage{true, record.success, record.n_iterations, record.n_rounds, {}});
+                    break;
+                }
+                previous_combinations = combinations;
+                if (settings.targeted) {
+                    auto ranked = H.rank_combinations_to_split(llrs, syndrome, workspace);
+                    ranked.resize(std::min(ranked.size(), settings.increment));
+                    to_alice.send(ReplyMessage{false, false, 0, 0, ranked});
+                    msg = to_bob.receive();
+                    LDPC4QKD::apply_targeted_syndrome_increment(H, syndrome, combinations, ranked, msg.bits);
+                } else {
+                    to_alice.send(ReplyMessage{});
+                    msg = to_bob.receive();
+                    LDPC4QKD::apply_syndrome_increment(H, syndrome, msg.bits);
+                    combinations = H.combinations_at_rate(n_mother_rows - syndrome.size());
+                }
+            }
+
+            if (record.success && out != keys_alice[frame_idx]) {
+                std::cerr << "\n\nDECODER CONVERGED TO WRONG CODEWORD!!!!\n" << std::endl;
+                record.success = false;
+            }
+        }
+    });
+
+    alice.join();
+    bob.join();
+    return records;
+}
+
+
+template<typename T>
+void print_distribution(const std::string &name, const std::vector<T> &values) {
+    std::cout << name << ": mean " << avg(values)
+              << ", p50 " << percentile(values, 50)
+              << ", p90 " << percentile(values, 90)
+              << ", p99 " << percentile(values, 99)
+              << ", max " << percentile(values, 100) << '\n';
+}
+
+
+void configure_parser(cli::Parser &parser) {
+    parser.set_optional<std::size_t>(
+            "s", "seed", 42,
+            "Mersenne Twister seed. Used to generate random bit-strings and simulate the noise channel.");
+
+    parser.set_optional<std::size_t>(
+            "nf", "num-frames", 100,
+            "Number of frames to reconcile.");
+
+    parser.set_optional<std::size_t>(
+            "i", "iter-bp", 50,
+            "Maximum number of belief propagation (BP) algorithm iterations per round.");
+
+    parser.set_optional<std::string>(
+            "dc", "decoder-config-path", "",
+            "Path to a decoder profile (json, e.g. created by `decoder_autotune`). "
+            "If specified, all decoder settings (including the maximum number of iterations) are taken from it.");
+
+    parser.set_optional<std::size_t>(
+            "inc", "increment", 64,
+            "Number of syndrome bits revealed by each additional round.");
+
+    parser.set_optional<std::size_t>(
+            "s0", "initial-syndrome-size", 0,
+            "Size of the syndrome sent in the first round. Specify zero to use the highest rate.");
+
+    parser.set_optional<bool>(
+            "tr", "targeted", false,
+            "Reveal the row combinations requested by Bob (`RateAdaptiveCode::rank_combinations_to_split`), "
+            "instead of the next ones of the rate adaption.");
+
+    parser.set_optional<bool>(
+            "pp", "provisioning", false,
+            "Choose the initial syndrome size of each frame from Bob's reports (`SyndromeProvisioningPolicy`), "
+            "instead of `--initial-syndrome-size`.");
+
+    parser.set_optional<double>(
+            "lb", "leak-budget", 0,
+            "Maximum expected number of syndrome bits per frame for `--provisioning` (required by it).");
+
+    parser.set_optional<double>(
+            "rtt", "round-trip-ms", 10,
+            "Round-trip time of the loopback link in milliseconds.");
+
+    parser.set_optional<bool>(
+            "cs", "cold-start", false,
+            "Start each round from the channel LLRs, instead of the messages of the previous round.");
+
+    parser.set_optional<double>(
+            "p", "channel-parameter", 0.02,
+            "Binary Symmetric Channel (BSC) channel parameter. I.e., probability of a bit to be flipped.");
+
+    parser.set_required<std::string>(
+            "cp", "code-path",
+            "Path to file containing LDPC code (`.cscmat`, `.bincsc.json`, `.qccsc.json`, `.alist` or `.cscbin` format)");
+
+    parser.set_required<std::string>(
+            "rp", "rate-adaption-path",
+            "Path to file containing rate adaption for the LDPC code (`csv` format. Two columns of indices).");
+
+    parser.set_optional<std::string>(
+            "o", "output-path", "",
+            "If specified, the records of all frames are saved to this csv file.");
+}
+
+
+int main(int argc, char *argv[]) {
+    // parse command line arguments
+    cli::Parser parser(argc, argv, help_text);
+    configure_parser(parser);
+    parser.run_and_exit_if_error();
+
+    const auto p = parser.get<double>("p");
+    const auto num_frames = parser.get<std::size_t>("nf");
+    const auto rng_seed = parser.get<std::size_t>("s");
+    const auto code_file_path = parser.get<std::string>("cp");
+    const auto rate_adaption_file_path = parser.get<std::string>("rp");
+    const auto decoder_config_path = parser.get<std::string>("dc");
+    const auto round_trip_ms = parser.get<double>("rtt");
+    const auto output_path = parser.get<std::string>("o");
+
+    try {
+        ProtocolSettings settings{};
+        settings.increment = parser.get<std::size_t>("inc");
+        settings.warm_start = !parser.get<bool>("cs");
+        settings.targeted = parser.get<bool>("tr");
+        settings.decoder_config.max_num_iter = parser.get<std::size_t>("i");
+        if (!decoder_config_path.empty()) {
+            settings.decoder_config = LDPC4QKD::read_decoder_config_from_json(decoder_config_path);
+        }
+
+        const auto H = load_ldpc(code_file_path, rate_adaption_file_path);
+        const auto min_syndrome_size = H.get_n_rows_mother_matrix() - H.get_max_ra_steps();
+        settings.initial_syndrome_size = parser.get<std::size_t>("s0");
+        if (settings.initial_syndrome_size == 0) {
+            settings.initial_syndrome_size = min_syndrome_size;
+        }
+        if (settings.initial_syndrome_size < min_syndrome_size ||
+            settings.initial_syndrome_size > H.get_n_rows_mother_matrix()) {
+            throw std::runtime_error("Initial syndrome size is not supported by the rate adaption.");
+        }
+        if (settings.increment == 0) {
+            throw std::runtime_error("Increment must be positive.");
+        }
+        if (parser.get<bool>("pp")) {
+            LDPC4QKD::ProvisioningSettings provisioning{};
+            provisioning.increment = settings.increment;
+            provisioning.round_trip_seconds = round_trip_ms / 1e3;
+            provisioning.leak_budget = parser.get<double>("lb");
+            if (!(provisioning.leak_budget > 0)) {
+                throw std::runtime_error("`--provisioning` requires a positive `--leak-budget`.");
+            }
+            settings.provisioning = provisioning;
+        }
+
+        std::cout << std::endl;
+        std::cout << "Code path: '" << code_file_path << "'\n";
+        std::cout << "Rate adaption path: '" << rate_adaption_file_path << "'\n";
+        std::cout << "Code size: " << H.get_n_rows_mother_matrix() << " x " << H.getNCols() << '\n';
+        std::cout << "Channel parameter p: " << p << '\n';
+        std::cout << "Decoder profile path: '" << decoder_config_path << "'\n";
+        std::cout << "Max number of BP decoder iterations per round: " << settings.decoder_config.max_num_iter << '\n';
+        if (settings.provisioning) {
+            std::cout << "Initial syndrome size: chosen by provisioning policy (leak budget "
+                      << settings.provisioning->leak_budget << ")\n";
+        } else {
+            std::cout << "Initial syndrome size: " << settings.initial_syndrome_size << '\n';
+        }
+        std::cout << "Increment (syndrome bits per round): " << settings.increment << '\n';
+        std::cout << "Warm start: " << (settings.warm_start ? "yes" : "no") << '\n';
+        std::cout << "Targeted revelation: " << (settings.targeted ? "yes" : "no") << '\n';
+        std::cout << "Round-trip time: " << round_trip_ms << " ms\n";
+        std::cout << "Number of frames: " << num_frames << '\n';
+        std::cout << "PRNG seed: " << rng_seed << "\n\n" << std::endl;
+
+        // Alice's keys and Bob's LLRs are generated up front, such that only the protocol is timed.
+        std::mt19937_64 rng(rng_seed);
+        std::vector<std::vector<bool>> keys(num_frames);
+        std::vector<std::vector<double>> llrs(num_frames);
+        for (std::size_t i{}; i < num_frames; ++i) {
+            keys[i].resize(H.getNCols());
+            noise_bitstring_inplace(rng, keys[i], 0.5);
+            std::vector<bool> noised = keys[i];
+            noise_bitstring_inplace(rng, noised, p);
+            llrs[i] = LDPC4QKD::llrs_bsc(noised, p);
+        }
+
+        const auto one_way_delay = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double, std::milli>(round_trip_ms / 2));
+        const auto begin = Clock::now();
+        const auto records = run_protocol(H, keys, llrs, settings, one_way_delay);
+        const double total_seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+        std::vector<std::size_t> initial_sizes, rounds, leaked_bits, iterations;
+        std::vector<double> decoding_ms, latency_ms;
+        std::map<std::size_t, std::size_t> rounds_histogram;
+        std::size_t n_failed{};
+        for (const auto &r: records) {
+            initial_sizes.push_back(r.initial_syndrome_size);
+            rounds.push_back(r.n_rounds);
+            leaked_bits.push_back(r.leaked_bits);
+            iterations.push_back(r.n_iterations);
+            decoding_ms.push_back(1e3 * r.decoding_seconds);
+            latency_ms.push_back(1e3 * r.latency_seconds);
+            rounds_histogram[r.n_rounds]++;
+            n_failed += !r.success;
+        }
+
+        std::cout << "DONE! Simulation time: " << total_seconds << " seconds ("
+                  << static_cast<double>(num_frames) / total_seconds << " frames per second).\n";
+        std::cout << "Failed frames (not decoded at the mother matrix): " << n_failed << " out of " << num_frames
+                  << "\n\n";
+        print_distribution("Initial syndrome size", initial_sizes);
+        print_distribution("Rounds", rounds);
+        print_distribution("Leaked bits", leaked_bits);
+        print_distribution("Decoder iterations", iterations);
+        print_distribution("Decoding time (ms)", decoding_ms);
+        print_distribution("Latency (ms)", latency_ms);
+
+        const double avg_rate = avg(leaked_bits) / static_cast<double>(H.getNCols());
+        std::cout << "\nAverage rate: " << avg_rate << " (inefficiency f = " << avg_rate / h2(p) << ")\n";
+        std::cout << "\nRounds histogram (rounds: frames):\n";
+        for (const auto &[n, count]: rounds_histogram) {
+            std::cout << n << ": " << count << '\n';
+        }
+        std::cout << std::flush;
+
+        if (!output_path.empty()) {
+            std::ofstream out(output_path);
+            out << "frame,success,initial_syndrome_size,rounds,leaked_bits,iterations,decoding_ms,latency_ms\n";
+            for (std::size_t i{}; i < records.size(); ++i) {
+                out << i << ',' << records[i].success << ',' << records[i].initial_syndrome_size << ','
+                    << records[i].n_rounds << ','
+                    << records[i].leaked_bits << ',' << records[i].n_iterations << ',' << decoding_ms[i] << ','
+                    << latency_ms[i] << '\n';
+            }
+            std::cout << "Saved frame records to '" << output_path << "'." << std::endl;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    exit(EXIT_SUCCESS);
+}
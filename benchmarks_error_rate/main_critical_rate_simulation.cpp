@@ -28,7 +28,7 @@ std::vector<std::size_t> run_simulation(RateAdaptiveCodeTemplate &H,
                                         double p,
                                         std::size_t num_frames_to_test,
                                         std::mt19937_64 &rng,
-                                        std::size_t max_num_iter = 50,
+                                        const LDPC4QKD::DecoderConfig &decoder_config,
                                         std::size_t update_console_every_n_frames = 100) {
     // assume whole codeword leaked unless decoding success
     std::vector<std::size_t> succesful_syndrome_sizes(num_frames_to_test, H.getNCols());
@@ -59,7 +59,7 @@ std::vector<std::size_t> run_simulation(RateAdaptiveCodeTemplate &H,
             }
 
             std::vector<bool> solution;
-            bool success = H.decode_infer_rate(llrs, syndrome, solution, max_num_iter);
+            bool success = H.decode_infer_rate(llrs, syndrome, solution, decoder_config);
 
             if (success && solution == x) {
                 succesful_syndrome_sizes.at(frame_idx) = syndrome.size();
@@ -98,6 +98,11 @@ void configure_parser(cli::Parser &parser) {
             "i", "iter-bp", 50,
             "Maximum number of belief propagation (BP) algorithm iterations.");
 
+    parser.set_optional<std::string>(
+            "dc", "decoder-config-path", "",
+            "Path to a decoder profile (json, e.g. created by `decoder_autotune`). "
+            "If specified, all decoder settings (including the maximum number of iterations) are taken from it.");
+
     parser.set_optional<std::size_t>(
             "me", "max-frame-errors", 50,
             "Number of frame errors at which to quit the simulation. Specify zero for 'no condition'.");
@@ -108,7 +113,7 @@ void configure_parser(cli::Parser &parser) {
 
     parser.set_required<std::string>(
             "cp", "code-path",
-            "Path to file containing LDPC code (`.cscmat` or `.bincsc.json` format. Note: does not accept QC exponents!)");
+            "Path to file containing LDPC code (`.cscmat`, `.bincsc.json`, `.qccsc.json`, `.alist` or `.cscbin` format)");
 
     parser.set_required<std::string>(
             "rp", "rate-adaption-path",
@@ -129,6 +134,13 @@ int main(int argc, char *argv[]) {
     auto update_console_every_n_frames = parser.get<std::size_t>("upn");
     auto code_file_path = parser.get<std::string>("cp");;
     auto rate_adaption_file_path = parser.get<std::string>("rp");;
+    auto decoder_config_path = parser.get<std::string>("dc");
+
+    LDPC4QKD::DecoderConfig decoder_config{};
+    decoder_config.max_num_iter = max_bp_iter;
+    if (!decoder_config_path.empty()) {
+        decoder_config = LDPC4QKD::read_decoder_config_from_json(decoder_config_path);
+    }
 
     auto H = load_ldpc(code_file_path, rate_adaption_file_path);
 
@@ -137,7 +149,8 @@ int main(int argc, char *argv[]) {
     std::cout << "Rate adaption loaded from file: " << rate_adaption_file_path << '\n';
     std::cout << "Code size: " << H.get_n_rows_after_rate_adaption() << " x " << H.getNCols() << '\n';
     std::cout << "Running FER decoding test on channel parameter p : " << p << '\n';
-    std::cout << "Max number decoder iterations: " << static_cast<int>(max_bp_iter) << '\n';
+    std::cout << "Decoder profile path: '" << decoder_config_path << "'\n";
+    std::cout << "Max number decoder iterations: " << decoder_config.max_num_iter << '\n';
     std::cout << "Number of frames to simulate: " << num_frames_to_test << '\n';
     std::cout << "PRNG seed: " << rng_seed << '\n';
     std::cout << "\n" << std::endl;
@@ -147,7 +160,7 @@ int main(int argc, char *argv[]) {
 
     auto syndrome_size_success = run_simulation(
             H, p, num_frames_to_test, rng,
-            max_bp_iter, update_console_every_n_frames);
+            decoder_config, update_console_every_n_frames);
 
     auto now = std::chrono::steady_clock::now();
     std::cout << "\n\nDONE! Simulation time: " <<
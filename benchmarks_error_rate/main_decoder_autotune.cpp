@@ -0,0 +1,383 @@
+//
+// Created by alice on 18.10.26.
+// Note: Names and meaning of command line parameters are defined below.
+//
+constexpr auto help_text =
+        "Decoder Configuration Auto-Tuner for Rate Adapted LDPC Codes\n"
+        "\n"
+        "This software is used to \n"
+        "- load an LDPC code and (optionally) rate adaption (same file formats as `rate_adapted_fer`)\n"
+        "- evaluate candidate decoder configurations (iteration cap, vsat, check node rule, min-sum normalization, "
+        "damping) at each combination of the given rate adaption steps and channel parameters (in parallel)\n"
+        "- measure the FER (with 95% confidence intervals) and the decoding throughput of each configuration\n"
+        "- write the Pareto front (worst-case FER vs. throughput) to a csv file and the chosen configuration to a "
+        "decoder profile file, which can be loaded by the other simulators (option `--decoder-config-path`) "
+        "or by `LDPC4QKD::read_decoder_config_from_json`.\n"
+        "\n"
+        "All candidates are tested on the same frames (same seed for each operating point).";
+
+// Standard library
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+// Command line argument parser library
+#include "external/CmdParser-91aaa61e/cmdparser.hpp"
+
+// Project scope
+#include "LDPC4QKD/rate_adaptive_code.hpp"
+#include "LDPC4QKD/read_ldpc_file_formats.hpp"
+#include "code_simulation_helpers.hpp"
+
+using namespace LDPC4QKD::CodeSimulationHelpers;
+using LDPC4QKD::DecoderConfig;
+using LDPC4QKD::CheckNodeRule;
+
+
+/// Combination of rate adaption and channel parameter at which candidate configurations are evaluated.
+struct OperatingPoint {
+    std::size_t n_line_combs{};
+    double p{};
+};
+
+/// Summary of one candidate configuration over all operating points.
+struct CandidateResult {
+    DecoderConfig config{};
+    FrameErrorStatistics total{};
+    double worst_fer{};  // largest FER over all operating points
+    double worst_fer_ci_low{};
+    double worst_fer_ci_high{};
+    double throughput_bits_per_second{};  // decoded bits per second of decoding time (single thread)
+};
+
+
+std::vector<DecoderConfig> candidate_configs(const std::vector<std::size_t> &iterations,
+                                             const std::vector<double> &vsats,
+                                             const std::vector<std::string> &rules,
+                                             const std::vector<double> &normalizations,
+                                             const std::vector<double> &dampings) {
+    std::vector<DecoderConfig> candidates;
+    for (auto rule_name: rules) {
+        const auto rule = LDPC4QKD::check_node_rule_from_string(rule_name);
+        // the normalization only matters for the min-sum rule.
+        const auto rule_normalizations = (rule == CheckNodeRule::normalized_min_sum)
+                                         ? normalizations : std::vector<double>{DecoderConfig{}.min_sum_normalization};
+        for (auto n_iter: iterations) {
+            for (auto vsat: vsats) {
+                for (auto normalization: rule_normalizations) {
+                    for (auto damping: dampings) {
+                        DecoderConfig config{};
+                        config.max_num_iter = n_iter;
+                        config.vsat = vsat;
+                        config.check_node_rule = rule;
+                        config.min_sum_normalization = normalization;
+                        config.damping = damping;
+                        candidates.push_back(config);
+                    }
+                }
+            }
+        }
+    }
+    return candidates;
+}
+
+
+/// `a` dominates `b` if it is at least as good in both objectives and strictly better in one.
+bool dominates(const CandidateResult &a, const CandidateResult &b) {
+    const bool not_worse = a.worst_fer <= b.worst_fer && a.throughput_bits_per_second >= b.throughput_bits_per_second;
+    const bool better = a.worst_fer < b.worst_fer || a.throughput_bits_per_second > b.throughput_bits_per_second;
+    return not_worse && better;
+}
+
+
+std::vector<std::size_t> pareto_front(const std::vector<CandidateResult> &results) {
+    std::vector<std::size_t> front;
+    for (std::size_t i{}; i < results.size(); ++i) {
+        bool dominated = false;
+        for (std::size_t j{}; j < results.size() && !dominated; ++j) {
+            dominated = (i != j) && dominates(results[j], results[i]);
+        }
+        if (!dominated) {
+            front.push_back(i);
+        }
+    }
+    std::sort(front.begin(), front.end(), [&results](auto lhs, auto rhs) {
+        return results[lhs].worst_fer < results[rhs].worst_fer;
+    });
+    return front;
+}
+
+
+/// Fastest candidate whose worst-case FER is below `target_fer` with 95% confidence.
+/// If there is none, the candidate with the smallest worst-case FER is chosen.
+std::size_t choose_profile(const std::vector<CandidateResult> &results, double target_fer) {
+    std::size_t best_idx{};
+    bool found_acceptable = false;
+    for (std::size_t i{}; i < results.size(); ++i) {
+        if (results[i].worst_fer_ci_high <= target_fer) {
+            if (!found_acceptable
+                || results[i].throughput_bits_per_second > results[best_idx].throughput_bits_per_second) {
+                best_idx = i;
+            }
+            found_acceptable = true;
+        }
+    }
+    if (found_acceptable) {
+        return best_idx;
+    }
+
+    std::cout << "WARNING: no candidate reaches the target FER " << target_fer << " with 95% confidence. "
+              << "Choosing the candidate with the smallest FER.\n";
+    for (std::size_t i{}; i < results.size(); ++i) {
+        const auto &r = results[i];
+        const auto &best = results[best_idx];
+        if (r.worst_fer < best.worst_fer
+            || (r.worst_fer == best.worst_fer && r.throughput_bits_per_second > best.throughput_bits_per_second)) {
+            best_idx = i;
+        }
+    }
+    return best_idx;
+}
+
+
+std::ostream &operator<<(std::ostream &s, const DecoderConfig &config) {
+    s << LDPC4QKD::check_node_rule_to_string(config.check_node_rule)
+      << " (max_num_iter=" << config.max_num_iter << ", vsat=" << config.vsat;
+    if (config.check_node_rule == CheckNodeRule::normalized_min_sum) {
+        s << ", normalization=" << config.min_sum_normalization;
+    }
+    s << ", damping=" << config.damping << ")";
+    return s;
+}
+
+
+void configure_parser(cli::Parser &parser) {
+    parser.set_optional<std::size_t>(
+            "s", "seed", 42,
+            "Mersenne Twister seed. Used to generate random bit-strings and simulate the noise channel.");
+
+    parser.set_optional<std::size_t>(
+            "mf", "max-frames", 1000,
+            "Maximum number of frames to test per candidate configuration and operating point.");
+
+    parser.set_optional<std::size_t>(
+            "me", "max-frame-errors", 50,
+            "Number of frame errors at which to stop testing a candidate at an operating point. "
+            "Specify zero for 'no condition'.");
+
+    parser.set_optional<std::size_t>(
+            "t", "threads", 0,
+            "Number of threads used for the simulation. Specify zero to use all available cores.");
+
+    parser.set_optional<std::string>(
+            "p", "channel-parameters", "0.02",
+            "Comma separated list of Binary Symmetric Channel (BSC) channel parameters (QBER range to tune for).");
+
+    parser.set_optional<std::string>(
+            "rn", "rate-adaption-steps", "0",
+            "Comma separated list of amounts of rate adaption (number of row combinations) to tune for. "
+            "Non-zero values require a rate adaption file.");
+
+    parser.set_optional<std::string>(
+            "it", "iterations", "20,50",
+            "Comma separated list of candidate maximum numbers of BP iterations.");
+
+    parser.set_optional<std::string>(
+            "vs", "vsat", "25,100",
+            "Comma separated list of candidate message cut-off values.");
+
+    parser.set_optional<std::string>(
+            "cn", "check-node-rules", "sum_product,normalized_min_sum",
+            "Comma separated list of candidate check node rules (`sum_product`, `normalized_min_sum`).");
+
+    parser.set_optional<std::string>(
+            "ms", "min-sum-normalizations", "0.7,0.8,0.9",
+            "Comma separated list of candidate normalization factors (only used by `normalized_min_sum`).");
+
+    parser.set_optional<std::string>(
+            "da", "damping", "0,0.2",
+            "Comma separated list of candidate damping factors.");
+
+    parser.set_optional<double>(
+            "tf", "target-fer", 0.01,
+            "The chosen profile is the fastest configuration whose FER (at every operating point) is below this "
+            "value with 95% confidence.");
+
+    parser.set_optional<std::string>(
+            "o", "output-profile-path", "decoder_profile.json",
+            "Path at which the chosen decoder configuration is saved.");
+
+    parser.set_optional<std::string>(
+            "po", "pareto-path", "decoder_autotune_pareto.csv",
+            "Path at which the Pareto front (csv) is saved.");
+
+    parser.set_required<std::string>(
+            "cp", "code-path",
+            "Path to file containing LDPC code (`.cscmat`, `.bincsc.json`, `.qccsc.json`, `.alist` or `.cscbin` format)");
+
+    parser.set_optional<std::string>(
+            "rp", "rate-adaption-path", "",
+            "Path to file containing rate adaption for the LDPC code (`csv` format. Two columns of indices). "
+            "If unspecified, no rate adaption is available.");
+}
+
+
+int main(int argc, char *argv[]) {
+    // parse command line arguments
+    cli::Parser parser(argc, argv, help_text);
+    configure_parser(parser);
+    parser.run_and_exit_if_error();
+
+    auto rng_seed = parser.get<std::size_t>("s");
+    auto max_frames = parser.get<std::size_t>("mf");
+    auto max_frame_errors = parser.get<std::size_t>("me");
+    auto n_threads = parser.get<std::size_t>("t");
+    auto channel_parameters = parse_comma_separated<double>(parser.get<std::string>("p"));
+    auto rate_adaption_steps = parse_comma_separated<std::size_t>(parser.get<std::string>("rn"));
+    auto target_fer = parser.get<double>("tf");
+    auto output_profile_path = parser.get<std::string>("o");
+    auto pareto_path = parser.get<std::string>("po");
+    auto code_file_path = parser.get<std::string>("cp");
+    auto rate_adaption_file_path = parser.get<std::string>("rp");
+
+    const auto candidates = candidate_configs(
+            parse_comma_separated<std::size_t>(parser.get<std::string>("it")),
+            parse_comma_separated<double>(parser.get<std::string>("vs")),
+            parse_comma_separated<std::string>(parser.get<std::string>("cn")),
+            parse_comma_separated<double>(parser.get<std::string>("ms")),
+            parse_comma_separated<double>(parser.get<std::string>("da")));
+
+    if (n_threads == 0) {
+        n_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // One rate adapted code per rate. These are only read (not modified) by the simulation threads.
+    auto H_mother = load_ldpc(code_file_path, rate_adaption_file_path);
+    std::vector<decltype(H_mother)> codes_at_rate;
+    for (auto n_line_combs: rate_adaption_steps) {
+        codes_at_rate.push_back(H_mother);
+        codes_at_rate.back().set_rate(n_line_combs);
+    }
+
+    std::vector<OperatingPoint> operating_points;
+    std::vector<std::size_t> operating_point_code;  // index into `codes_at_rate`
+    for (std::size_t r{}; r < rate_adaption_steps.size(); ++r) {
+        for (auto p: channel_parameters) {
+            operating_points.push_back({rate_adaption_steps[r], p});
+            operating_point_code.push_back(r);
+        }
+    }
+
+    // print received arguments (simulation parameters)
+    std::cout << std::endl;
+    std::cout << "Code path: '" << code_file_path << "'\n";
+    std::cout << "Rate adaption path: '" << rate_adaption_file_path << "'\n";
+    std::cout << "Code size before rate adaption: " << H_mother.get_n_rows_mother_matrix() << " x "
+              << H_mother.getNCols() << '\n';
+    std::cout << "Number of candidate configurations: " << candidates.size() << '\n';
+    std::cout << "Number of operating points (rate, channel parameter): " << operating_points.size() << '\n';
+    std::cout << "Max number of frames per candidate and operating point: " << max_frames << '\n';
+    std::cout << "Quit at n frame errors: " << max_frame_errors << '\n';
+    std::cout << "Target FER: " << target_fer << '\n';
+    std::cout << "Threads: " << n_threads << '\n';
+    std::cout << "PRNG seed: " << rng_seed << "\n\n" << std::endl;
+
+    auto begin = std::chrono::steady_clock::now();
+
+    // Each work item is one candidate at one operating point. Threads take the next unprocessed work item.
+    const std::size_t n_work_items = candidates.size() * operating_points.size();
+    std::vector<FrameErrorStatistics> item_results(n_work_items);
+    std::atomic<std::size_t> next_item{0};
+    std::mutex console_mutex;
+    std::size_t n_items_done{};
+
+    auto worker = [&]() {
+        for (std::size_t item = next_item++; item < n_work_items; item = next_item++) {
+            const std::size_t candidate_idx = item / operating_points.size();
+            const std::size_t op_idx = item % operating_points.size();
+            // same seed for all candidates at an operating point: all candidates see the same frames.
+            item_results[item] = simulate_frame_errors(
+                    codes_at_rate[operating_point_code[op_idx]], operating_points[op_idx].p,
+                    candidates[candidate_idx], max_frames, max_frame_errors, rng_seed + op_idx);
+
+            std::lock_guard<std::mutex> lock(console_mutex);
+            n_items_done++;
+            std::cout << "\rdone " << n_items_done << " out of " << n_work_items << " work items..." << std::flush;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i{}; i < n_threads; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (auto &t: threads) {
+        t.join();
+    }
+    std::cout << std::endl;
+
+    // summarize the results of each candidate
+    std::vector<CandidateResult> results(candidates.size());
+    for (std::size_t c{}; c < candidates.size(); ++c) {
+        auto &r = results[c];
+        r.config = candidates[c];
+        r.worst_fer = -1;
+        for (std::size_t op_idx{}; op_idx < operating_points.size(); ++op_idx) {
+            const auto &stats = item_results[c * operating_points.size() + op_idx];
+            r.total += stats;
+            if (stats.fer() > r.worst_fer) {
+                r.worst_fer = stats.fer();
+                std::tie(r.worst_fer_ci_low, r.worst_fer_ci_high) = wilson_score_interval(
+                        stats.n_frame_errors, stats.n_frames);
+            }
+        }
+        r.throughput_bits_per_second = static_cast<double>(r.total.n_frames * H_mother.getNCols())
+                                       / r.total.decoding_seconds;
+    }
+
+    const auto front = pareto_front(results);
+    const auto chosen_idx = choose_profile(results, target_fer);
+    const auto &chosen = results[chosen_idx];
+
+    auto now = std::chrono::steady_clock::now();
+    std::cout << "\n\nDONE! Simulation time: " <<
+              std::chrono::duration_cast<std::chrono::seconds>(now - begin).count() << " seconds." << '\n';
+
+    std::ofstream pareto_file(pareto_path);
+    pareto_file << "check_node_rule,max_num_iter,vsat,min_sum_normalization,damping,"
+                   "worst_fer,worst_fer_ci_low,worst_fer_ci_high,throughput_bits_per_second\n";
+    std::cout << "\nPareto front (worst-case FER vs. single-thread decoding throughput):\n";
+    for (auto i: front) {
+        const auto &r = results[i];
+        pareto_file << LDPC4QKD::check_node_rule_to_string(r.config.check_node_rule) << ','
+                    << r.config.max_num_iter << ',' << r.config.vsat << ','
+                    << r.config.min_sum_normalization << ',' << r.config.damping << ','
+                    << r.worst_fer << ',' << r.worst_fer_ci_low << ',' << r.worst_fer_ci_high << ','
+                    << r.throughput_bits_per_second << '\n';
+        std::cout << "  FER~" << r.worst_fer << " [" << r.worst_fer_ci_low << ", " << r.worst_fer_ci_high << "], "
+                  << r.throughput_bits_per_second / 1e6 << " Mbit/s: " << r.config << '\n';
+    }
+    std::cout << "Pareto front saved to '" << pareto_path << "'\n";
+
+    auto profile = LDPC4QKD::decoder_config_to_json(chosen.config);
+    profile["autotune"] = {
+            {"code_path", code_file_path},
+            {"rate_adaption_path", rate_adaption_file_path},
+            {"rate_adaption_steps", rate_adaption_steps},
+            {"channel_parameters", channel_parameters},
+            {"target_fer", target_fer},
+            {"worst_fer", chosen.worst_fer},
+            {"worst_fer_ci", {chosen.worst_fer_ci_low, chosen.worst_fer_ci_high}},
+            {"throughput_bits_per_second", chosen.throughput_bits_per_second}
+    };
+    std::ofstream profile_file(output_profile_path);
+    profile_file << profile.dump(4) << std::endl;
+
+    std::cout << "\nChosen profile: " << chosen.config << '\n';
+    std::cout << "Decoder profile saved to '" << output_profile_path << "'" << std::endl;
+
+    exit(EXIT_SUCCESS);
+}
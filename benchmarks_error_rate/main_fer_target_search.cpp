@@ -0,0 +1,470 @@
+//
+// Created by alice on 18.10.26.
+// Note: Names and meaning of command line parameters are defined below.
+//
+constexpr auto help_text =
+        "Target FER Search for Rate Adapted LDPC Codes\n"
+        "\n"
+        "This software is used to \n"
+        "- load an LDPC code and (optionally) rate adaption (same file formats as `rate_adapted_fer`)\n"
+        "- find the Binary Symmetric Channel (BSC) channel parameter (at a fixed rate), or the amount of rate adaption "
+        "(at a fixed channel parameter), at which the code reaches a target frame error rate (FER)\n"
+        "- report the located operating point together with an interval that contains it with high confidence.\n"
+        "\n"
+        "The search keeps a bracket [lower, upper] of points at which the FER is known (with confidence) to be below "
+        "and above the target, respectively. New probes are placed by regula falsi (Illinois variant) on the logit of "
+        "the FER. Each probe simulates frames in growing batches (in parallel) only until its confidence interval "
+        "excludes the target, so probes far from the target are cheap. The frame budget per probe grows as the "
+        "bracket narrows. The search stops when the bracket is narrow enough, or when a probe is statistically "
+        "indistinguishable from the target at the maximum frame budget.\n"
+        "\n"
+        "Instead of a target FER, a percentile of the critical rate can be given: if q percent of the frames must be "
+        "decodable at the located rate, the target FER is 1 - q/100 "
+        "(assuming that a frame which decodes at some rate also decodes at all lower rates).";
+
+// Standard library
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <optional>
+
+// Command line argument parser library
+#include "external/CmdParser-91aaa61e/cmdparser.hpp"
+
+// Project scope
+#include "LDPC4QKD/rate_adaptive_code.hpp"
+#include "LDPC4QKD/read_ldpc_file_formats.hpp"
+#include "code_simulation_helpers.hpp"
+
+using namespace LDPC4QKD::CodeSimulationHelpers;
+using LDPC4QKD::DecoderConfig;
+
+using Code = LDPC4QKD::RateAdaptiveCode<std::uint32_t>;
+
+
+/// Result of simulating frames at one point of the search.
+struct Probe {
+    double x{};  // search variable: log(p) when searching the channel parameter, else number of row combinations
+    FrameErrorStatistics stats{};
+    double ci_low{};
+    double ci_high{};
+    int side{};  // -1: FER below target, +1: FER above target, 0: not distinguishable from the target
+
+    /// logit of the FER estimate, with a continuity correction so that it is finite for zero (or only) errors.
+    [[nodiscard]] double logit_fer() const {
+        const double fer = (static_cast<double>(stats.n_frame_errors) + 0.5)
+                           / (static_cast<double>(stats.n_frames) + 1.);
+        return std::log(fer / (1. - fer));
+    }
+};
+
+
+/// Parameters of the search which are the same for every probe.
+struct SearchSettings {
+    double target_fer{};
+    double z{};  // quantile of the standard normal distribution for the confidence intervals
+    bool search_rate{};  // search the amount of rate adaption (else the channel parameter)
+    double fixed_p{};  // channel parameter when searching the rate
+    std::size_t min_batch{};
+    std::size_t n_threads{};
+    std::uint64_t seed{};
+    DecoderConfig decoder_config{};
+};
+
+
+/// Simulates `n_frames` frames, split evenly between `n_threads` threads (each with its own seed).
+FrameErrorStatistics simulate_parallel(const Code &H, double p, const DecoderConfig &decoder_config,
+                                       std::size_t n_frames, std::size_t n_threads, std::uint64_t seed) {
+    n_threads = std::min(n_threads, n_frames);
+    std::vector<FrameErrorStatistics> results(n_threads);
+    std::vector<std::thread> threads;
+    for (std::size_t t{}; t < n_threads; ++t) {
+        const std::size_t n_thread_frames = n_frames / n_threads + (t < n_frames % n_threads);
+        threads.emplace_back([&, t, n_thread_frames]() {
+            results[t] = simulate_frame_errors(H, p, decoder_config, n_thread_frames, 0, seed + t);
+        });
+    }
+    FrameErrorStatistics total{};
+    for (std::size_t t{}; t < n_threads; ++t) {
+        threads[t].join();
+        total += results[t];
+    }
+    return total;
+}
+
+
+/*!
+ * Simulates frames at the point `x` until the confidence interval of the FER excludes the target,
+ * or `frame_budget` frames were simulated.
+ * Batches double in size, such that the overhead of checking the stopping rule stays small.
+ */
+Probe run_probe(const Code &H_mother, double x, std::size_t frame_budget, std::uint64_t probe_seed,
+                const SearchSettings &settings) {
+    Code H = H_mother;
+    double p = settings.fixed_p;
+    if (settings.search_rate) {
+        H.set_rate(static_cast<std::size_t>(std::lround(x)));
+    } else {
+        p = std::exp(x);
+    }
+
+    Probe probe{};
+    probe.x = x;
+    std::size_t batch = settings.min_batch;
+    for (std::uint64_t batch_idx{}; probe.stats.n_frames < frame_budget; ++batch_idx) {
+        batch = std::min(batch, frame_budget - probe.stats.n_frames);
+        probe.stats += simulate_parallel(H, p, settings.decoder_config, batch, settings.n_threads,
+                                         probe_seed + batch_idx * settings.n_threads);
+        std::tie(probe.ci_low, probe.ci_high) = wilson_score_interval(
+                probe.stats.n_frame_errors, probe.stats.n_frames, settings.z);
+        if (probe.ci_high < settings.target_fer) {
+            probe.side = -1;
+            break;
+        }
+        if (probe.ci_low > settings.target_fer) {
+            probe.side = +1;
+            break;
+        }
+        batch *= 2;
+    }
+    return probe;
+}
+
+
+/// Regula falsi step on the logit of the FER, with weights `w_*` for the Illinois modification.
+double next_probe_position(const Probe &lower, const Probe &upper, double w_lower, double w_upper,
+                           double target_logit, bool integer) {
+    const double g_lower = w_lower * (lower.logit_fer() - target_logit);  // negative
+    const double g_upper = w_upper * (upper.logit_fer() - target_logit);  // positive
+    const double width = upper.x - lower.x;
+    double x = lower.x - g_lower * width / (g_upper - g_lower);
+    if (!std::isfinite(x)) {
+        x = lower.x + width / 2;
+    }
+
+    // keep the probe away from the bracket ends, such that the bracket shrinks by a useful amount.
+    x = std::clamp(x, lower.x + 0.1 * width, upper.x - 0.1 * width);
+    if (integer) {
+        x = std::clamp(std::round(x), lower.x + 1, upper.x - 1);
+    }
+    return x;
+}
+
+
+std::string format_point(double x, bool search_rate) {
+    std::stringstream s;
+    if (search_rate) {
+        s << "n_line_combs=" << x;
+    } else {
+        s << "p=" << std::exp(x);
+    }
+    return s.str();
+}
+
+
+void configure_parser(cli::Parser &parser) {
+    parser.set_optional<std::size_t>(
+            "s", "seed", 42,
+            "Mersenne Twister seed. Used to generate random bit-strings and simulate the noise channel.");
+
+    parser.set_optional<double>(
+            "tf", "target-fer", 1e-3,
+            "Frame error rate (FER) at which the operating point is searched.");
+
+    parser.set_optional<double>(
+            "pct", "critical-rate-percentile", 0,
+            "If non-zero, search the rate at which this percentage of frames is decodable "
+            "(replaces the target FER by 1 - pct/100).");
+
+    parser.set_optional<std::string>(
+            "sv", "search-variable", "p",
+            "Variable to search: `p` (channel parameter at fixed rate adaption `rn`) "
+            "or `rn` (rate adaption steps at fixed channel parameter `p`).");
+
+    parser.set_optional<double>(
+            "p", "channel-parameter", 0.02,
+            "Binary Symmetric Channel (BSC) channel parameter. Only used when searching the rate adaption steps.");
+
+    parser.set_optional<std::size_t>(
+            "rn", "rate-adaption-steps", 0,
+            "Amount of rate adaption (number of row combinations). Only used when searching the channel parameter.");
+
+    parser.set_optional<double>(
+            "pl", "p-lower", 1e-3,
+            "Lower end of the initial bracket of channel parameters.");
+
+    parser.set_optional<double>(
+            "pu", "p-upper", 0.15,
+            "Upper end of the initial bracket of channel parameters.");
+
+    parser.set_optional<double>(
+            "tol", "relative-tolerance", 0.01,
+            "Stop when the bracket of channel parameters satisfies upper/lower - 1 < tol. "
+            "(The rate adaption search stops when the bracket contains no more integers.)");
+
+    parser.set_optional<std::size_t>(
+            "mb", "min-batch", 64,
+            "Number of frames simulated in the first batch of every probe (batches double in size).");
+
+    parser.set_optional<std::size_t>(
+            "if", "initial-frame-budget", 2000,
+            "Maximum number of frames per probe while the bracket is at its initial width. "
+            "The budget grows in proportion to how much the bracket has shrunk.");
+
+    parser.set_optional<std::size_t>(
+            "mf", "max-frames", 200000,
+            "Maximum number of frames per probe.");
+
+    parser.set_optional<std::size_t>(
+            "mp", "max-probes", 30,
+            "Maximum number of probes (excluding the two bracket ends).");
+
+    parser.set_optional<double>(
+            "z", "z-score", 1.96,
+            "Quantile of the standard normal distribution used for the confidence intervals (1.96: 95% confidence).");
+
+    parser.set_optional<std::size_t>(
+            "t", "threads", 0,
+            "Number of threads used for the simulation. Specify zero to use all available cores.");
+
+    parser.set_optional<std::size_t>(
+            "i", "iter-bp", 50,
+            "Maximum number of belief propagation (BP) algorithm iterations.");
+
+    parser.set_optional<std::string>(
+            "dc", "decoder-config-path", "",
+            "Path to a decoder profile (json, e.g. created by `decoder_autotune`). "
+            "If specified, all decoder settings (including the maximum number of iterations) are taken from it.");
+
+    parser.set_optional<std::string>(
+            "o", "output-path", "",
+            "If specified, every probe is saved to this csv file.");
+
+    parser.set_required<std::string>(
+            "cp", "code-path",
+            "Path to file containing LDPC code (`.cscmat`, `.bincsc.json`, `.qccsc.json`, `.alist` or `.cscbin` format)");
+
+    parser.set_optional<std::string>(
+            "rp", "rate-adaption-path", "",
+            "Path to file containing rate adaption for the LDPC code (`csv` format. Two columns of indices). "
+            "If unspecified, no rate adaption is available.");
+}
+
+
+int main(int argc, char *argv[]) {
+    // parse command line arguments
+    cli::Parser parser(argc, argv, help_text);
+    configure_parser(parser);
+    parser.run_and_exit_if_error();
+
+    SearchSettings settings{};
+    settings.seed = parser.get<std::size_t>("s");
+    settings.target_fer = parser.get<double>("tf");
+    auto percentile = parser.get<double>("pct");
+    auto search_variable = parser.get<std::string>("sv");
+    settings.fixed_p = parser.get<double>("p");
+    auto n_line_combs = parser.get<std::size_t>("rn");
+    auto p_lower = parser.get<double>("pl");
+    auto p_upper = parser.get<double>("pu");
+    auto tolerance = parser.get<double>("tol");
+    settings.min_batch = std::max<std::size_t>(1, parser.get<std::size_t>("mb"));
+    auto initial_frame_budget = parser.get<std::size_t>("if");
+    auto max_frames = parser.get<std::size_t>("mf");
+    auto max_probes = parser.get<std::size_t>("mp");
+    settings.z = parser.get<double>("z");
+    settings.n_threads = parser.get<std::size_t>("t");
+    auto max_bp_iter = parser.get<std::size_t>("i");
+    auto decoder_config_path = parser.get<std::string>("dc");
+    auto output_path = parser.get<std::string>("o");
+    auto code_file_path = parser.get<std::string>("cp");
+    auto rate_adaption_file_path = parser.get<std::string>("rp");
+
+    if (percentile != 0) {
+        settings.target_fer = 1. - percentile / 100.;
+    }
+    if (!(settings.target_fer > 0 && settings.target_fer < 1)) {
+        std::cerr << "Target FER must be strictly between zero and one." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    if (search_variable != "p" && search_variable != "rn") {
+        std::cerr << "Unknown search variable '" << search_variable << "'. Expected `p` or `rn`." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    settings.search_rate = (search_variable == "rn");
+    if (settings.n_threads == 0) {
+        settings.n_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    settings.decoder_config.max_num_iter = max_bp_iter;
+    if (!decoder_config_path.empty()) {
+        settings.decoder_config = LDPC4QKD::read_decoder_config_from_json(decoder_config_path);
+    }
+
+    auto H_mother = load_ldpc(code_file_path, rate_adaption_file_path);
+    if (!settings.search_rate) {
+        H_mother.set_rate(n_line_combs);
+    }
+
+    // initial bracket. The FER increases with the channel parameter and with the amount of rate adaption.
+    double x_lower = std::log(p_lower);
+    double x_upper = std::log(p_upper);
+    if (settings.search_rate) {
+        x_lower = 0;
+        x_upper = static_cast<double>(H_mother.get_max_ra_steps());
+    }
+
+    // print received arguments (simulation parameters)
+    std::cout << std::endl;
+    std::cout << "Code path: '" << code_file_path << "'\n";
+    std::cout << "Rate adaption path: '" << rate_adaption_file_path << "'\n";
+    std::cout << "Code size before rate adaption: " << H_mother.get_n_rows_mother_matrix() << " x "
+              << H_mother.getNCols() << '\n';
+    std::cout << "Target FER: " << settings.target_fer << '\n';
+    if (settings.search_rate) {
+        std::cout << "Searching rate adaption steps in [" << x_lower << ", " << x_upper << "] at p = "
+                  << settings.fixed_p << '\n';
+    } else {
+        std::cout << "Searching channel parameter in [" << p_lower << ", " << p_upper << "] at "
+                  << n_line_combs << " rate adaption steps\n";
+    }
+    std::cout << "Decoder profile path: '" << decoder_config_path << "'\n";
+    std::cout << "Max number of BP decoder iterations: " << settings.decoder_config.max_num_iter << '\n';
+    std::cout << "Frames per probe: initial budget " << initial_frame_budget << ", max " << max_frames << '\n';
+    std::cout << "Threads: " << settings.n_threads << '\n';
+    std::cout << "PRNG seed: " << settings.seed << "\n\n" << std::endl;
+
+    const double target_logit = std::log(settings.target_fer / (1. - settings.target_fer));
+    const double initial_width = x_upper - x_lower;
+    auto begin = std::chrono::steady_clock::now();
+
+    std::vector<Probe> probes;
+    auto probe_at = [&](double x, std::size_t frame_budget) {
+        // every probe gets its own range of seeds.
+        const std::uint64_t probe_seed = settings.seed + (probes.size() << 32u);
+        probes.push_back(run_probe(H_mother, x, frame_budget, probe_seed, settings));
+        const auto &probe = probes.back();
+        std::cout << "probe " << probes.size() << ": " << format_point(x, settings.search_rate) << " -> "
+                  << probe.stats.n_frame_errors << " frame errors out of " << probe.stats.n_frames
+                  << " (FER~" << probe.stats.fer() << " [" << probe.ci_low << ", " << probe.ci_high << "]), "
+                  << (probe.side < 0 ? "below target" : (probe.side > 0 ? "above target" : "undecided"))
+                  << std::endl;
+        return probe;
+    };
+
+    Probe lower = probe_at(x_lower, max_frames);
+    Probe upper = probe_at(x_upper, max_frames);
+    if (lower.side >= 0 || upper.side <= 0) {
+        std::cerr << "\nThe initial bracket does not contain the target FER (with confidence). "
+                     "Widen the bracket or increase the maximum number of frames." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // Illinois weights: halve the weight of a bracket end that is retained twice in a row.
+    double w_lower = 1.;
+    double w_upper = 1.;
+    int last_side = 0;
+    std::optional<Probe> undecided;
+    std::size_t n_probes{};
+    auto bracket_is_narrow = [&]() {
+        if (settings.search_rate) {
+            return upper.x - lower.x <= 1;
+        }
+        return std::exp(upper.x - lower.x) - 1 < tolerance;
+    };
+    for (; n_probes < max_probes && !bracket_is_narrow(); ++n_probes) {
+        const double x = next_probe_position(lower, upper, w_lower, w_upper, target_logit, settings.search_rate);
+        const double shrink = initial_width / (upper.x - lower.x);
+        const auto frame_budget = std::min<std::size_t>(
+                max_frames, static_cast<std::size_t>(static_cast<double>(initial_frame_budget) * shrink));
+
+        const Probe probe = probe_at(x, frame_budget);
+        if (probe.side < 0) {
+            lower = probe;
+            w_lower = 1.;
+            w_upper = (last_side < 0) ? w_upper / 2 : 1.;
+        } else if (probe.side > 0) {
+            upper = probe;
+            w_upper = 1.;
+            w_lower = (last_side > 0) ? w_lower / 2 : 1.;
+        } else if (frame_budget < max_frames) {
+            // close to the target: the budget of subsequent probes grows, but the position does not change.
+            // Probing the same point again with the maximum budget is what the next iteration would end up doing.
+            const Probe retry = probe_at(x, max_frames);
+            ++n_probes;
+            if (retry.side == 0) {
+                undecided = retry;
+                break;
+            }
+            (retry.side < 0 ? lower : upper) = retry;
+            w_lower = w_upper = 1.;
+        } else {
+            undecided = probe;
+            break;
+        }
+        last_side = probe.side;
+    }
+
+    // located point: the undecided probe, or interpolation in the final bracket.
+    double x_located{};
+    if (undecided) {
+        x_located = undecided->x;
+    } else {
+        x_located = next_probe_position(lower, upper, 1., 1., target_logit, false);
+        if (settings.search_rate) {
+            // the largest amount of rate adaption at which the FER is below the target.
+            x_located = lower.x;
+        }
+    }
+
+    std::size_t total_frames{};
+    double total_decoding_seconds{};
+    for (const auto &probe: probes) {
+        total_frames += probe.stats.n_frames;
+        total_decoding_seconds += probe.stats.decoding_seconds;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    std::cout << "\n\nDONE! Simulation time: " <<
+              std::chrono::duration_cast<std::chrono::seconds>(now - begin).count() << " seconds." << '\n';
+    std::cout << "Probes: " << probes.size() << ", frames simulated: " << total_frames
+              << ", decoding time (all threads): " << total_decoding_seconds << " seconds\n";
+    if (undecided) {
+        std::cout << "Stopped at a probe that is statistically indistinguishable from the target FER "
+                  << "at the maximum frame budget.\n";
+    } else if (!bracket_is_narrow()) {
+        std::cout << "WARNING: stopped after the maximum number of probes before reaching the tolerance.\n";
+    }
+
+    std::cout << "\nTarget FER " << settings.target_fer << " reached at " << format_point(x_located, settings.search_rate)
+              << '\n';
+    std::cout << "Interval (FER below target with confidence at the lower end, above at the upper end): ["
+              << format_point(lower.x, settings.search_rate) << ", " << format_point(upper.x, settings.search_rate)
+              << "]\n";
+
+    const auto n_rows_mother = static_cast<double>(H_mother.get_n_rows_mother_matrix());
+    const auto n_cols = static_cast<double>(H_mother.getNCols());
+    if (settings.search_rate) {
+        const double rate = (n_rows_mother - x_located) / n_cols;
+        std::cout << "Rate " << rate << " (efficiency f = rate / h2(p) = " << rate / h2(settings.fixed_p) << ")\n";
+    } else {
+        const double rate = (n_rows_mother - static_cast<double>(n_line_combs)) / n_cols;
+        std::cout << "Rate " << rate << " (efficiency f = rate / h2(p) = " << rate / h2(std::exp(x_located)) << ")\n";
+    }
+
+    if (!output_path.empty()) {
+        std::ofstream file(output_path);
+        file << (settings.search_rate ? "n_line_combs" : "p")
+             << ",n_frames,n_frame_errors,fer,fer_ci_low,fer_ci_high,side\n";
+        for (const auto &probe: probes) {
+            file << (settings.search_rate ? probe.x : std::exp(probe.x)) << ',' << probe.stats.n_frames << ','
+                 << probe.stats.n_frame_errors << ',' << probe.stats.fer() << ',' << probe.ci_low << ','
+                 << probe.ci_high << ',' << probe.side << '\n';
+        }
+        std::cout << "Probes saved to '" << output_path << "'\n";
+    }
+    std::cout << std::flush;
+
+    exit(EXIT_SUCCESS);
+}
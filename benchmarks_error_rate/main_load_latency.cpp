@@ -0,0 +1,491 @@
+//
+// Created by alice on 18.10.26.
+// Note: Names and meaning of command line parameters are defined below.
+//
+constexpr auto help_text =
+        "Open-Loop Load Benchmark of the Decoding Service\n"
+        "\n"
+        "Closed-loop benchmarks (decoding as fast as possible) measure throughput, but not the latency of frames "
+        "that wait for a thread. This program generates frame arrivals from several QKD links according to an "
+        "arrival process (`--arrivals`) and feeds them to `DecodingService`, at several offered loads:\n"
+        "- Every link uses its own code and syndrome size (`--code-ids`, `--syndrome-sizes`). Its true QBER drifts "
+        "sinusoidally around the QBER assumed by the decoder (`--qber`, `--qber-drift`, `--drift-period`).\n"
+        "- First, the capacity (frames per second) of the mix of links is measured closed-loop. The offered loads "
+        "(`--loads`) are fractions of this capacity.\n"
+        "- The arrival times of all frames are fixed in advance. The latency of a frame is measured from its "
+        "scheduled arrival until its decoding is done, and arrivals never wait for earlier frames. Hence, if the "
+        "generator falls behind, this is included in the latency (no coordinated omission).\n"
+        "- Frames arriving while `--max-in-system` frames are in the system (queued or decoding) are dropped.\n"
+        "\n"
+        "For every load, the latency percentiles, the number of frames in the system at arrival, "
+        "the dropped and failed frames and the achieved throughput are printed. Per-frame records can be saved as csv.";
+
+// Standard library
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <random>
+#include <thread>
+
+// Project scope
+#include "LDPC4QKD/decoding_service.hpp"
+#include "LDPC4QKD/read_ldpc_file_formats.hpp"
+#include "tools/tool_helpers.hpp"
+
+using namespace LDPC4QKD::CodeSimulationHelpers;
+using idx_t = std::uint32_t;
+using Clock = std::chrono::steady_clock;
+
+
+/// A QKD link delivering frames of one code and rate.
+struct Link {
+    std::size_t code_id{};
+    std::size_t syndrome_size{};
+    double qber{};  // assumed by the decoder (LLRs)
+    double qber_drift{};  // amplitude of the drift of the true QBER around `qber`
+    double drift_phase{};  // links drift with different phases
+};
+
+enum class ArrivalProcess {
+    poisson,  // exponentially distributed inter-arrival times
+    bursty,  // bursts arrive as a Poisson process, all frames of a burst at the same time
+    periodic  // constant inter-arrival time
+};
+
+/// A frame as it arrives at the decoder.
+struct Frame {
+    std::size_t link{};
+    double arrival_seconds{};  // scheduled arrival, relative to the start of the run
+    std::vector<double> llrs;  // of the noisy key, computed in advance
+    std::vector<std::uint8_t> syndrome;
+};
+
+/// Outcome of a frame.
+struct FrameRecord {
+    bool dropped{};
+    bool success{};
+    double latency_seconds{};  // from the scheduled arrival until decoding is done
+    double completion_seconds{};  // relative to the start of the run
+    std::size_t n_in_system{};  // frames in the system when the frame arrived (including itself)
+    std::size_t n_queued_tasks{};  // tasks waiting for a thread when the frame arrived
+};
+
+
+/// True QBER of `link` at time `t` (seconds).
+double true_qber(const Link &link, double t, double drift_period) {
+    constexpr double pi = 3.14159265358979323846;
+    const double q = link.qber + link.qber_drift * std::sin(2 * pi * t / drift_period + link.drift_phase);
+    return std::clamp(q, 0., 0.5);
+}
+
+
+/// Arrival times (seconds, non-decreasing) of `n` frames with the average rate `frames_per_second`.
+std::vector<double> arrival_times(ArrivalProcess process, double frames_per_second, std::size_t n,
+                                  double mean_burst_size, std::mt19937_64 &rng) {
+    std::vector<double> times;
+    times.reserve(n);
+    double t{};
+    if (process == ArrivalProcess::periodic) {
+        for (std::size_t i{}; i < n; ++i) {
+            times.push_back(static_cast<double>(i) / frames_per_second);
+        }
+    } else if (process == ArrivalProcess::poisson) {
+        std::exponential_distribution<double> inter_arrival(frames_per_second);
+        for (std::size_t i{}; i < n; ++i) {
+            t += inter_arrival(rng);
+            times.push_back(t);
+        }
+    } else {
+        // burst sizes are geometric (at least one frame) with mean `mean_burst_size`
+        std::exponential_distribution<double> inter_burst(frames_per_second / mean_burst_size);
+        std::geometric_distribution<std::size_t> extra_frames(1. / mean_burst_size);
+        while (times.size() < n) {
+            t += inter_burst(rng);
+            const auto burst_size = std::min(n - times.size(), 1 + extra_frames(rng));
+            times.insert(times.end(), burst_size, t);
+        }
+    }
+    return times;
+}
+
+
+/// Frames of all links, sorted by arrival time. Every link offers `frames_per_second / links.size()` on average.
+template<typename Registry>
+std::vector<Frame> generate_frames(Registry &registry, const std::vector<Link> &links, ArrivalProcess process,
+                                   double frames_per_second, std::size_t n_frames, double mean_burst_size,
+                                   double drift_period, std::mt19937_64 &rng) {
+    std::vector<Frame> frames;
+    for (std::size_t l{}; l < links.size(); ++l) {
+        const auto n_link = n_frames / links.size() + ((l < n_frames % links.size()) ? 1 : 0);
+        const auto times = arrival_times(process, frames_per_second / static_cast<double>(links.size()),
+                                         n_link, mean_burst_size, rng);
+        const auto code = registry.get_mother_code(links[l].code_id);
+        for (const double t: times) {
+            Frame frame;
+            frame.link = l;
+            frame.arrival_seconds = t;
+            std::vector<std::uint8_t> key(code->getNCols());
+            noise_bitstring_inplace(rng, key, 0.5);
+            code->encode_with_ra(key, frame.syndrome, links[l].syndrome_size);
+            noise_bitstring_inplace(rng, key, true_qber(links[l], t, drift_period));
+            frame.llrs = LDPC4QKD::llrs_bsc(key, links[l].qber);
+            frames.push_back(std::move(frame));
+        }
+    }
+    std::stable_sort(frames.begin(), frames.end(), [](const Frame &lhs, const Frame &rhs) {
+        return lhs.arrival_seconds < rhs.arrival_seconds;
+    });
+    return frames;
+}
+
+
+/*!
+ * Submits every frame at its scheduled arrival time (open loop) and waits until all are done.
+ * Frames are submitted through `DecodingService::submit`, i.e., with the priorities and time slicing of its schedule.
+ *
+ * @param max_in_system frames arriving while this many frames are in the system are dropped (zero: never drop)
+ */
+std::vector<FrameRecord> run_open_loop(LDPC4QKD::DecodingService<idx_t> &service, const std::vector<Link> &links,
+                                       const std::vector<Frame> &frames, std::size_t max_in_system) {
+    auto &pool = service.get_thread_pool();
+    std::vector<FrameRecord> records(frames.size());
+    std::vector<std::future<LDPC4QKD::DecodingResult>> results(frames.size());
+    std::vector<std::size_t> in_system;  // frames that were not done at the previous arrival
+
+    const auto start = Clock::now();
+    auto scheduled = [&](std::size_t i) {
+        return start + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(frames[i].arrival_seconds));
+    };
+    for (std::size_t i{}; i < frames.size(); ++i) {
+        std::this_thread::sleep_until(scheduled(i));
+
+        in_system.erase(std::remove_if(in_system.begin(), in_system.end(), [&results](std::size_t j) {
+            return results[j].wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        }), in_system.end());
+        auto &record = records[i];
+        record.n_in_system = in_system.size() + 1;
+        record.n_queued_tasks = pool.queue_size();
+        if (max_in_system != 0 && record.n_in_system > max_in_system) {
+            record.dropped = true;
+            continue;
+        }
+
+        const auto &frame = frames[i];
+        results[i] = service.submit(links[frame.link].code_id, frame.llrs, frame.syndrome);
+        in_system.push_back(i);
+    }
+    for (std::size_t i{}; i < frames.size(); ++i) {
+        if (records[i].dropped) {
+            continue;
+        }
+        const auto result = results[i].get();
+        records[i].success = result.success;
+        records[i].latency_seconds = std::chrono::duration<double>(result.finished - scheduled(i)).count();
+        records[i].completion_seconds = std::chrono::duration<double>(result.finished - start).count();
+    }
+    return records;
+}
+
+
+template<typename T>
+void print_distribution(const std::string &name, const std::vector<T> &values) {
+    if (values.empty()) {
+        std::cout << name << ": no values\n";
+        return;
+    }
+    std::cout << name << ": mean " << avg(values)
+              << ", p50 " << percentile(values, 50)
+              << ", p90 " << percentile(values, 90)
+              << ", p99 " << percentile(values, 99)
+              << ", p99.9 " << percentile(values, 99.9)
+              << ", max " << percentile(values, 100) << '\n';
+}
+
+
+/// Value of a comma separated option for every link (a single value is used for all links).
+template<typename T>
+std::vector<T> per_link(const std::string &option, std::size_t n_links, const std::string &name) {
+    auto values = parse_comma_separated<T>(option);
+    if (values.size() == 1) {
+        values.resize(n_links, values[0]);
+    }
+    if (values.size() != n_links) {
+        throw std::runtime_error("Expected one value of `--" + name + "` per link (or a single value).");
+    }
+    return values;
+}
+
+
+void configure_parser(cli::Parser &parser) {
+    parser.set_optional<std::size_t>(
+            "s", "seed", 42,
+            "Mersenne Twister seed. Used to generate random bit-strings, noise and arrival times.");
+
+    parser.set_optional<std::string>(
+            "c", "code-ids", "0,3",
+            "Comma separated code_ids, one per link. Embedded codes come first, followed by `--code-paths`.");
+
+    parser.set_optional<std::string>(
+            "ss", "syndrome-sizes", "0",
+            "Comma separated syndrome sizes, one per link (or one for all). Zero means no rate adaption.");
+
+    parser.set_optional<std::string>(
+            "q", "qber", "0.02",
+            "Comma separated QBERs assumed by the decoder, one per link (or one for all).");
+
+    parser.set_optional<double>(
+            "qd", "qber-drift", 0.005,
+            "Amplitude of the sinusoidal drift of the true QBER of every link around `--qber`.");
+
+    parser.set_optional<double>(
+            "dp", "drift-period", 2,
+            "Period of the QBER drift in seconds.");
+
+    parser.set_optional<std::string>(
+            "a", "arrivals", "poisson",
+            "Arrival process of every link: `poisson`, `bursty` (Poisson arrivals of bursts with geometric size, "
+            "see `--burst-size`) or `periodic`.");
+
+    parser.set_optional<double>(
+            "bs", "burst-size", 8,
+            "Mean number of frames per burst for `--arrivals bursty`.");
+
+    parser.set_optional<std::string>(
+            "l", "loads", "0.3,0.5,0.7,0.9",
+            "Comma separated offered loads, as fractions of the measured capacity.");
+
+    parser.set_optional<std::size_t>(
+            "nf", "frames-per-load", 400,
+            "Number of frames (of all links together) offered at each load.");
+
+    parser.set_optional<std::size_t>(
+            "cf", "calibration-frames", 40,
+            "Number of frames decoded closed-loop to measure the capacity.");
+
+    parser.set_optional<std::size_t>(
+            "mis", "max-in-system", 256,
+            "Frames arriving while this many frames are queued or decoding are dropped. Zero never drops.");
+
+    parser.set_optional<std::size_t>(
+            "i", "max-iterations", 50,
+            "Maximum number of iterations for the decoder.");
+
+    parser.set_optional<std::string>(
+            "dc", "decoder-config-path", "",
+            "Path to a decoder profile (json, e.g. written by `decoder_autotune`). Overrides `--max-iterations`.");
+
+    parser.set_optional<std::string>(
+            "x", "execution", "frame_parallel",
+            "How threads are used: `frame_parallel`, `intra_frame` or `adaptive` (see `ExecutionMode`).");
+
+    parser.set_optional<std::size_t>(
+            "ts", "iterations-per-slice", 0,
+            "If non-zero, frames give up their thread after this many decoder iterations and continue later, "
+            "such that small frames do not wait for large ones. Zero decodes every frame in one go.");
+
+    parser.set_optional<std::size_t>(
+            "hp", "high-priority-max-frame-size", 0,
+            "Frames of codes with at most this many bits are decoded before larger frames that are waiting.");
+
+    parser.set_optional<std::size_t>(
+            "t", "threads", 0,
+            "Number of worker threads. Specify zero to use all available cores.");
+
+    parser.set_optional<std::string>(
+            "cp", "code-paths", "",
+            "Comma separated list of files containing additional LDPC codes "
+            "(`.cscmat`, `.bincsc.json`, `.qccsc.json`, `.alist` or `.cscbin` format). "
+            "These get the code_ids following the embedded codes.");
+
+    parser.set_optional<std::string>(
+            "rp", "rate-adaption-paths", "",
+            "Comma separated list of rate adaption files (`csv` format), one for each of `--code-paths`.");
+
+    parser.set_optional<std::string>(
+            "o", "output-path", "",
+            "If specified, the records of all frames (of all loads) are saved to this csv file.");
+}
+
+
+int main(int argc, char *argv[]) {
+    // parse command line arguments
+    cli::Parser parser(argc, argv, help_text);
+    configure_parser(parser);
+    parser.run_and_exit_if_error();
+
+    const auto rng_seed = parser.get<std::size_t>("s");
+    const auto drift_period = parser.get<double>("dp");
+    const auto mean_burst_size = parser.get<double>("bs");
+    const auto frames_per_load = parser.get<std::size_t>("nf");
+    const auto calibration_frames = parser.get<std::size_t>("cf");
+    const auto max_in_system = parser.get<std::size_t>("mis");
+    const auto decoder_config_path = parser.get<std::string>("dc");
+    const auto arrivals = parser.get<std::string>("a");
+    const auto execution = parser.get<std::string>("x");
+    const auto output_path = parser.get<std::string>("o");
+
+    try {
+        ArrivalProcess process{};
+        if (arrivals == "poisson") {
+            process = ArrivalProcess::poisson;
+        } else if (arrivals == "bursty") {
+            process = ArrivalProcess::bursty;
+        } else if (arrivals == "periodic") {
+            process = ArrivalProcess::periodic;
+        } else {
+            throw std::runtime_error("Unknown arrival process '" + arrivals + "'.");
+        }
+        if (!(mean_burst_size >= 1) || !(drift_period > 0)) {
+            throw std::runtime_error("Burst size must be at least one and the drift period positive.");
+        }
+        const auto loads = parse_comma_separated<double>(parser.get<std::string>("l"));
+        for (const double load: loads) {
+            if (!(load > 0)) {
+                throw std::runtime_error("Loads must be positive.");
+            }
+        }
+        if (frames_per_load == 0 || calibration_frames == 0) {
+            throw std::runtime_error("Specify at least one frame per load and one calibration frame.");
+        }
+
+        LDPC4QKD::DecoderConfig decoder_config{};
+        decoder_config.max_num_iter = parser.get<std::size_t>("i");
+        if (!decoder_config_path.empty()) {
+            decoder_config = LDPC4QKD::read_decoder_config_from_json(decoder_config_path);
+        }
+        LDPC4QKD::DecodingSchedule schedule{};
+        schedule.iterations_per_slice = parser.get<std::size_t>("ts");
+        schedule.high_priority_max_frame_size = parser.get<std::size_t>("hp");
+        if (execution == "frame_parallel") {
+            schedule.execution = LDPC4QKD::ExecutionMode::frame_parallel;
+        } else if (execution == "intra_frame") {
+            schedule.execution = LDPC4QKD::ExecutionMode::intra_frame;
+        } else if (execution == "adaptive") {
+            schedule.execution = LDPC4QKD::ExecutionMode::adaptive;
+        } else {
+            throw std::runtime_error("Unknown execution mode '" + execution + "'.");
+        }
+
+        LDPC4QKD::CodeRegistry<idx_t> registry;
+        LDPC4QKD::ToolHelpers::add_codes_from_options(parser, registry);
+        LDPC4QKD::ThreadPool pool(parser.get<std::size_t>("t"));
+        LDPC4QKD::DecodingService<idx_t> service(registry, pool, decoder_config, schedule);
+
+        const auto code_ids = parse_comma_separated<std::size_t>(parser.get<std::string>("c"));
+        const auto syndrome_sizes = per_link<std::size_t>(parser.get<std::string>("ss"), code_ids.size(),
+                                                          "syndrome-sizes");
+        const auto qbers = per_link<double>(parser.get<std::string>("q"), code_ids.size(), "qber");
+        std::vector<Link> links(code_ids.size());
+        std::vector<LDPC4QKD::ToolHelpers::FrameSpec> specs;
+        for (std::size_t l{}; l < links.size(); ++l) {
+            const auto code = registry.get_mother_code(code_ids[l]);
+            links[l].code_id = code_ids[l];
+            links[l].syndrome_size = (syndrome_sizes[l] == 0) ? code->get_n_rows_mother_matrix() : syndrome_sizes[l];
+            links[l].qber = qbers[l];
+            links[l].qber_drift = parser.get<double>("qd");
+            links[l].drift_phase = 2 * 3.14159265358979323846 * static_cast<double>(l)
+                                   / static_cast<double>(links.size());
+            if (!(links[l].qber > 0 && links[l].qber < 0.5)) {
+                throw std::runtime_error("QBERs must be strictly between 0 and 0.5.");
+            }
+            specs.push_back({links[l].code_id, links[l].syndrome_size});
+        }
+        for (auto &f: registry.preload(pool, LDPC4QKD::ToolHelpers::preload_options_for_frames(specs, true,
+                                                                                               pool.size()))) {
+            f.get();
+        }
+
+        std::cout << "Links:\n";
+        for (std::size_t l{}; l < links.size(); ++l) {
+            std::cout << "  " << l << ": code '" << registry.get_name(links[l].code_id) << "', syndrome size "
+                      << links[l].syndrome_size << ", QBER " << links[l].qber << " (drift +-" << links[l].qber_drift
+                      << ")\n";
+        }
+        std::cout << "Arrivals: " << arrivals << ", threads: " << pool.size() << " (execution: " << execution
+                  << "), max iterations: " << decoder_config.max_num_iter << ", iterations per slice: "
+                  << schedule.iterations_per_slice << ", max in system: " << max_in_system << '\n';
+
+        // closed loop: all calibration frames arrive at once
+        std::mt19937_64 rng(rng_seed);
+        const auto calibration = generate_frames(registry, links, ArrivalProcess::periodic, 1e9, calibration_frames,
+                                                 1, drift_period, rng);
+        const auto calibration_records = run_open_loop(service, links, calibration, 0);
+        double calibration_seconds{};
+        for (const auto &r: calibration_records) {
+            calibration_seconds = std::max(calibration_seconds, r.completion_seconds);
+        }
+        const double capacity = static_cast<double>(calibration_frames) / calibration_seconds;
+        std::cout << "Capacity (closed loop): " << capacity << " frames per second\n" << std::endl;
+
+        std::ofstream out;
+        if (!output_path.empty()) {
+            out.open(output_path);
+            if (!out) {
+                throw std::runtime_error("Failed to open output file '" + output_path + "'.");
+            }
+            out << "load,frame,link,arrival_seconds,dropped,success,latency_ms,in_system,queued_tasks\n";
+        }
+
+        for (const double load: loads) {
+            const double offered = load * capacity;
+            const auto frames = generate_frames(registry, links, process, offered, frames_per_load, mean_burst_size,
+                                                drift_period, rng);
+            const auto records = run_open_loop(service, links, frames, max_in_system);
+
+            std::vector<double> latency_ms;
+            std::vector<std::vector<double>> link_latency_ms(links.size());
+            std::vector<std::size_t> in_system, queued_tasks;
+            std::size_t n_dropped{};
+            std::size_t n_failed{};
+            double last_completion{};
+            for (std::size_t i{}; i < records.size(); ++i) {
+                const auto &r = records[i];
+                in_system.push_back(r.n_in_system);
+                queued_tasks.push_back(r.n_queued_tasks);
+                if (r.dropped) {
+                    n_dropped++;
+                    continue;
+                }
+                latency_ms.push_back(1e3 * r.latency_seconds);
+                link_latency_ms[frames[i].link].push_back(1e3 * r.latency_seconds);
+                n_failed += !r.success;
+                last_completion = std::max(last_completion, r.completion_seconds);
+            }
+            const double span = frames.empty() ? 0 : frames.back().arrival_seconds;
+
+            const double achieved = (last_completion > 0) ? static_cast<double>(latency_ms.size()) / last_completion : 0;
+            std::cout << "Load " << load << ": offered " << offered << " frames per second, achieved "
+                      << achieved << " (" << frames.size()
+                      << " frames arriving over " << span << " seconds)\n";
+            std::cout << "Dropped frames: " << n_dropped << ", failed frames: " << n_failed << '\n';
+            print_distribution("Latency (ms)", latency_ms);
+            for (std::size_t l{}; l < links.size(); ++l) {
+                print_distribution("  link " + std::to_string(l), link_latency_ms[l]);
+            }
+            print_distribution("Frames in system at arrival", in_system);
+            print_distribution("Queued tasks at arrival", queued_tasks);
+            std::cout << std::endl;
+
+            if (out) {
+                for (std::size_t i{}; i < records.size(); ++i) {
+                    const auto &r = records[i];
+                    out << load << ',' << i << ',' << frames[i].link << ',' << frames[i].arrival_seconds << ','
+                        << r.dropped << ',' << r.success << ',' << 1e3 * r.latency_seconds << ',' << r.n_in_system
+                        << ',' << r.n_queued_tasks << '\n';
+                }
+            }
+        }
+        if (out) {
+            std::cout << "Saved frame records to '" << output_path << "'." << std::endl;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    exit(EXIT_SUCCESS);
+}
@@ -6,10 +6,12 @@ constexpr auto help_text =
         "Frame Error Rate (FER) Simulator for Rate Adapted LDPC Codes\n"
         "\n"
         "This software is used to \n"
-        "- load an LDPC code (from a .cscmat or bincsc.json file storing the full binary LDPC matrix in compressed sparse column (CSC) format, no QC exponents allowed!)\n"
+        "- load an LDPC code (from a `.cscmat`, `.bincsc.json`, `.qccsc.json`, `.alist` or `.cscbin` file; "
+        "QC exponents are expanded)\n"
         "- load rate adaption (from a csv file, list of pairs of row indices combined at each rate adaption step) "
         "   (this is optional; without rate adaption, only FER of the LDPC code can be simulated)\n"
-        "- Simulate the FER of the given LDPC code at specified amount of rate adaption.";
+        "- Simulate the FER of the given LDPC code at specified amount of rate adaption, "
+        "using the belief propagation (BP) decoder or the finite alphabet iterative decoder (FAID).";
 
 // Standard library
 #include <iostream>
@@ -21,18 +23,20 @@ constexpr auto help_text =
 
 // Project scope
 #include "LDPC4QKD/rate_adaptive_code.hpp"
+#include "LDPC4QKD/read_faid_rule.hpp"
 #include "code_simulation_helpers.hpp"
 
 using namespace LDPC4QKD::CodeSimulationHelpers;
 
 
-template<typename idx_t=std::uint16_t>
+/// `decode(llrs, syndrome, solution)` decodes a frame and returns whether the decoder converged.
+template<typename idx_t, typename Decode>
 std::pair<size_t, size_t> run_simulation(
         const LDPC4QKD::RateAdaptiveCode<idx_t> &H,
         double p,
         std::size_t num_frames_to_test,
         std::mt19937_64 &rng,
-        std::size_t max_num_iter = 50,
+        Decode decode,
         std::size_t update_console_every_n_frames = 100,
         std::size_t quit_at_n_errors = 100) {
     std::size_t num_frame_errors{};
@@ -54,7 +58,7 @@ std::pair<size_t, size_t> run_simulation(
         }
 
         std::vector<bool> solution;
-        bool success = H.decode_at_current_rate(llrs, syndrome, solution, max_num_iter);
+        bool success = decode(llrs, syndrome, solution);
 
         if (success) {
             if (solution != x) {
@@ -99,6 +103,34 @@ void configure_parser(cli::Parser &parser) {
             "i", "iter-bp", 50,
             "Maximum number of belief propagation (BP) algorithm iterations.");
 
+    parser.set_optional<std::string>(
+            "d", "decoder", "bp",
+            "Decoder: `bp` (belief propagation, settings below) or `faid` (finite alphabet iterative decoder).");
+
+    parser.set_optional<std::string>(
+            "fr", "faid-rule-path", "",
+            "Path to the rule (lookup tables) of the FAID decoder (json, see `read_faid_rule_from_json`). "
+            "If unspecified, the default rule is used, with the maximum number of iterations given by `--iter-bp`.");
+
+    parser.set_optional<std::size_t>(
+            "dr", "decimation-rounds", 0,
+            "Maximum number of decimation rounds when BP stalls (fixing the most reliable bits, "
+            "see `DecoderConfig::decimation_rounds`). Specify zero to disable decimation.");
+
+    parser.set_optional<double>(
+            "df", "decimation-fraction", 0.01,
+            "Fraction of the bits fixed by each decimation round.");
+
+    parser.set_optional<std::size_t>(
+            "rs", "restarts", 0,
+            "Maximum number of restarts with perturbed channel LLRs when BP stalls "
+            "(see `DecoderConfig::restarts`). Specify zero to disable restarts.");
+
+    parser.set_optional<std::string>(
+            "dc", "decoder-config-path", "",
+            "Path to a decoder profile (json, e.g. created by `decoder_autotune`). "
+            "If specified, all decoder settings (including the maximum number of iterations) are taken from it.");
+
     parser.set_optional<std::size_t>(
             "me", "max-frame-errors", 50,
             "Number of frame errors at which to quit the simulation. Specify zero for 'no condition'.");
@@ -109,7 +141,7 @@ void configure_parser(cli::Parser &parser) {
 
     parser.set_required<std::string>(
             "cp", "code-path",
-            "Path to file containing LDPC code (`.cscmat` or `bincsc.json` format. Note: does not accept QC exponents!)");
+            "Path to file containing LDPC code (`.cscmat`, `.bincsc.json`, `.qccsc.json`, `.alist` or `.cscbin` format)");
 
     parser.set_optional<std::string>(
             "rp", "rate-adaption-path", "",
@@ -138,6 +170,27 @@ int main(int argc, char *argv[]) {
     auto code_file_path = parser.get<std::string>("cp");
     auto rate_adaption_file_path = parser.get<std::string>("rp");
     auto n_line_combs = parser.get<std::size_t>("rn");
+    auto decoder_config_path = parser.get<std::string>("dc");
+    auto decoder_name = parser.get<std::string>("d");
+    auto faid_rule_path = parser.get<std::string>("fr");
+    if (decoder_name != "bp" && decoder_name != "faid") {
+        std::cerr << "ERROR: Unknown decoder '" << decoder_name << "'. Expected `bp` or `faid`." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    LDPC4QKD::DecoderConfig decoder_config{};
+    decoder_config.max_num_iter = max_bp_iter;
+    decoder_config.decimation_rounds = parser.get<std::size_t>("dr");
+    decoder_config.decimation_fraction = parser.get<double>("df");
+    decoder_config.restarts = parser.get<std::size_t>("rs");
+    if (!decoder_config_path.empty()) {
+        decoder_config = LDPC4QKD::read_decoder_config_from_json(decoder_config_path);
+    }
+    LDPC4QKD::FaidRule faid_rule{};
+    faid_rule.max_num_iter = max_bp_iter;
+    if (!faid_rule_path.empty()) {
+        faid_rule = LDPC4QKD::read_faid_rule_from_json(faid_rule_path);
+    }
 
     // create LDPC code, with rate adaption if specified.
     auto H = load_ldpc(code_file_path, rate_adaption_file_path);
@@ -149,7 +202,18 @@ int main(int argc, char *argv[]) {
     std::cout << "Code path: '" << code_file_path << "'\n";
     std::cout << "Rate adaption path: '" << rate_adaption_file_path << "'\n";
     std::cout << "Running FER decoding test on channel parameter p : " << p << '\n';
-    std::cout << "Max number of BP decoder iterations: " << static_cast<int>(max_bp_iter) << '\n';
+    std::cout << "Decoder: " << decoder_name << '\n';
+    if (decoder_name == "faid") {
+        std::cout << "FAID rule path: '" << faid_rule_path << "'\n";
+        std::cout << "Max number of FAID decoder iterations: " << faid_rule.max_num_iter << '\n';
+    } else {
+        std::cout << "Decoder profile path: '" << decoder_config_path << "'\n";
+        std::cout << "Max number of BP decoder iterations: " << decoder_config.max_num_iter << '\n';
+        std::cout << "Decimation rounds (fraction of bits fixed per round): " << decoder_config.decimation_rounds
+                  << " (" << decoder_config.decimation_fraction << ")\n";
+        std::cout << "Restarts (additional iterations per restart): " << decoder_config.restarts
+                  << " (" << decoder_config.restart_max_iter << ")\n";
+    }
     std::cout << "Max number of frames to simulate: " << max_num_frames_to_test << '\n';
     std::cout << "Quit at n frame errors: " << quit_at_n_errors << '\n';
     std::cout << "PRNG seed: " << rng_seed << '\n';
@@ -162,9 +226,30 @@ int main(int argc, char *argv[]) {
     auto begin = std::chrono::steady_clock::now();
 
     // perform frame error rate simulation.
-    std::pair<std::size_t, std::size_t> result = run_simulation(H, p, max_num_frames_to_test, rng,
-                                                                max_bp_iter,
-                                                                update_console_every_n_frames, quit_at_n_errors);
+    std::pair<std::size_t, std::size_t> result;
+    std::size_t n_restarted_frames{};  // frames for which the BP decoder restarted at least once
+    std::size_t n_converged_after_restart{};
+    if (decoder_name == "faid") {
+        const LDPC4QKD::FaidDecoder<std::uint32_t> faid(H, faid_rule);
+        LDPC4QKD::FaidWorkspace workspace;
+        auto decode = [&](const auto &llrs, const auto &syndrome, auto &solution) {
+            return faid.decode(llrs, syndrome, solution, workspace);
+        };
+        result = run_simulation(H, p, max_num_frames_to_test, rng, decode,
+                                update_console_every_n_frames, quit_at_n_errors);
+    } else {
+        LDPC4QKD::DecoderWorkspace workspace;
+        auto decode = [&](const auto &llrs, const auto &syndrome, auto &solution) {
+            const bool success = H.decode_at_current_rate(llrs, syndrome, solution, decoder_config, workspace);
+            if (workspace.n_restarts > 0) {
+                n_restarted_frames++;
+                n_converged_after_restart += success;
+            }
+            return success;
+        };
+        result = run_simulation(H, p, max_num_frames_to_test, rng, decode,
+                                update_console_every_n_frames, quit_at_n_errors);
+    }
     std::size_t num_frame_errors = result.first;
     std::size_t num_frames_tested = result.second;
     double naive_fer = static_cast<double>(num_frame_errors) / static_cast<double>(num_frames_tested);
@@ -175,6 +260,10 @@ int main(int argc, char *argv[]) {
 
     std::cout << "Recorded " << num_frame_errors << " frame errors out of " << num_frames_tested
               << " (FER~" << naive_fer << ")..." << std::endl;
+    if (decoder_name == "bp" && decoder_config.restarts > 0) {
+        std::cout << "Restarted " << n_restarted_frames << " frames, of which " << n_converged_after_restart
+                  << " converged after a restart." << std::endl;
+    }
 
     exit(EXIT_SUCCESS);
 }
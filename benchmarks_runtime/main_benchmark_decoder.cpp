@@ -10,10 +10,10 @@
 #include <benchmark/benchmark.h>
 
 // Project scope
-#include "rate_adaptive_code.hpp"
+#include "LDPC4QKD/rate_adaptive_code.hpp"
 
 // Test cases test against constants known to be correct for the LDPC-matrix defined here:
-#include "autogen_ldpc_matrix_csc.hpp"
+#include "fortest_autogen_ldpc_matrix_csc.hpp"
 
 
 template<typename T>
@@ -32,10 +32,10 @@ void noise_bitstring_inplace(std::vector<T> &src, double err_prob, unsigned int
 }
 
 
-LDPC4QKD::RateAdaptiveCode get_code_big_nora() {
+LDPC4QKD::RateAdaptiveCode<std::uint16_t> get_code_big_nora() {
     std::vector<std::uint32_t> colptr(AutogenLDPC::colptr.begin(), AutogenLDPC::colptr.end());
     std::vector<std::uint16_t> row_idx(AutogenLDPC::row_idx.begin(), AutogenLDPC::row_idx.end());
-    return LDPC4QKD::RateAdaptiveCode(colptr, row_idx);
+    return LDPC4QKD::RateAdaptiveCode<std::uint16_t>(colptr, row_idx);
 }
 
 
@@ -10,7 +10,10 @@
 #include <benchmark/benchmark.h>
 
 // Project scope
-#include "encoder.hpp"
+// LDPC matrix and rate adaption used by the encoder (the same as used by the unit tests):
+#include "fortest_autogen_ldpc_matrix_csc.hpp"
+#include "fortest_autogen_rate_adaption.hpp"
+#include "LDPC4QKD/encoder.hpp"
 
 
 template<typename T, std::size_t N>
@@ -0,0 +1,371 @@
+//
+// Created by alice on 18.10.26.
+//
+// Microbenchmarks of the single kernels of the decoder (check node update, variable node update, hard decision,
+// syndrome check), the encoder and rate adaption, on the embedded codes and on synthetic Tanner graphs.
+//
+// Besides time, every benchmark reports
+//  - `edges/s`: Tanner graph edges processed per second,
+//  - `bytes/s`: memory traffic per second, according to a simple model of the bytes each kernel reads and writes
+//               per edge and per node (see `KernelCost`), ignoring caches,
+//  - `peak_fraction`: `bytes/s` divided by the peak memory bandwidth of the machine, measured at startup using the
+//                     STREAM triad kernel (a simple roofline: kernels close to 1 are memory bound).
+//                     Google Benchmark displays it with a "/s" suffix. Codes that fit into the caches can exceed 1.
+//
+// Additional synthetic graphs can be specified on the command line, e.g.
+//      benchmark_kernels --graphs=regular:65536:3:6,qc:8:24:3:512 --benchmark_filter=regular
+// where `regular:<N>:<dv>:<dc>` is a random (dv, dc)-regular graph with N columns
+// and `qc:<rows>:<cols>:<dv>:<Z>` is a random quasi-cyclic graph (base matrix of size rows x cols with dv
+// non-zero entries per column, expansion factor Z).
+//
+
+// Standard library
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Google Benchmark library
+#include <benchmark/benchmark.h>
+
+// Project scope
+#include "LDPC4QKD/rate_adaptive_code.hpp"
+#include "LDPC4QKD/embedded_codes.hpp"
+#include "benchmarks_error_rate/code_simulation_helpers.hpp"
+
+
+using idx_t = std::uint32_t;
+using Code = LDPC4QKD::RateAdaptiveCode<idx_t>;
+using Bit = std::uint8_t;
+
+namespace {
+
+    /// Peak memory bandwidth (bytes per second), measured by `measure_peak_bandwidth`.
+    double peak_bandwidth = 1;
+
+    /// STREAM triad `a = b + s * c`, best of several runs. Counts 24 bytes per element (no write allocate).
+    double measure_peak_bandwidth() {
+        constexpr std::size_t n = std::size_t{1} << 23;
+        std::vector<double> a(n, 0.), b(n, 1.), c(n, 2.);
+        constexpr double s = 3.;
+        double best_seconds = std::numeric_limits<double>::infinity();
+        for (int run{}; run < 10; ++run) {
+            const auto begin = std::chrono::steady_clock::now();
+            for (std::size_t i{}; i < n; ++i) {
+                a[i] = b[i] + s * c[i];
+            }
+            benchmark::DoNotOptimize(a.data());
+            benchmark::ClobberMemory();
+            best_seconds = std::min(
+                    best_seconds, std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+        }
+        return static_cast<double>(3 * sizeof(double) * n) / best_seconds;
+    }
+
+    // ------------------------------------------------------------------------------------------------ Tanner graphs
+
+    /// Pairs of distinct rows to combine for rate adaption (random, each row used at most once).
+    std::vector<idx_t> random_rows_to_combine(std::size_t n_rows, std::mt19937_64 &rng) {
+        std::vector<idx_t> rows(n_rows - n_rows % 2);
+        std::iota(rows.begin(), rows.end(), idx_t{0});
+        std::shuffle(rows.begin(), rows.end(), rng);
+        return rows;
+    }
+
+    /// Random (dv, dc)-regular graph with `n_cols` columns (socket construction; rare double edges are removed).
+    Code make_regular_code(std::size_t n_cols, std::size_t dv, std::size_t dc) {
+        std::mt19937_64 rng(n_cols * 31 + dv * 7 + dc);
+        const std::size_t n_rows = n_cols * dv / dc;
+        std::vector<idx_t> sockets(n_cols * dv);
+        for (std::size_t i{}; i < sockets.size(); ++i) {
+            sockets[i] = static_cast<idx_t>(i / dv);  // column of each socket
+        }
+        std::shuffle(sockets.begin(), sockets.end(), rng);
+
+        std::vector<std::vector<idx_t>> pos_varn(n_rows);
+        for (std::size_t i{}; i < sockets.size(); ++i) {
+            pos_varn[i % n_rows].push_back(sockets[i]);
+        }
+        for (auto &row: pos_varn) {
+            std::sort(row.begin(), row.end());
+            row.erase(std::unique(row.begin(), row.end()), row.end());
+        }
+        return Code(std::move(pos_varn), random_rows_to_combine(n_rows, rng));
+    }
+
+    /// Random quasi-cyclic graph: base matrix with `dv` circulant permutation matrices of size `z` per column.
+    Code make_qc_code(std::size_t base_rows, std::size_t base_cols, std::size_t dv, std::size_t z) {
+        std::mt19937_64 rng(base_rows * 131 + base_cols * 17 + dv * 3 + z);
+        std::uniform_int_distribution<std::size_t> shift_dist(0, z - 1);
+        std::vector<std::vector<idx_t>> pos_varn(base_rows * z);
+        std::vector<std::size_t> base_row_indices(base_rows);
+        std::iota(base_row_indices.begin(), base_row_indices.end(), std::size_t{0});
+
+        for (std::size_t bc{}; bc < base_cols; ++bc) {
+            std::shuffle(base_row_indices.begin(), base_row_indices.end(), rng);
+            for (std::size_t j{}; j < std::min(dv, base_rows); ++j) {
+                const auto br = base_row_indices[j];
+                const auto shift = shift_dist(rng);
+                for (std::size_t k{}; k < z; ++k) {
+                    pos_varn[br * z + (k + shift) % z].push_back(static_cast<idx_t>(bc * z + k));
+                }
+            }
+        }
+        for (auto &row: pos_varn) {
+            std::sort(row.begin(), row.end());
+        }
+        return Code(std::move(pos_varn), random_rows_to_combine(base_rows * z, rng));
+    }
+
+    /// Graph specification as given on the command line (see top of file) or "embedded:<code_id>".
+    Code make_code(const std::string &spec) {
+        std::stringstream s(spec);
+        std::string kind;
+        std::getline(s, kind, ':');
+        std::vector<std::size_t> params;
+        for (std::string p; std::getline(s, p, ':');) {
+            params.push_back(std::stoul(p));
+        }
+
+        if (kind == "embedded" && params.size() == 1) {
+            return LDPC4QKD::get_embedded_code<idx_t>(params[0]);
+        } else if (kind == "regular" && params.size() == 3) {
+            return make_regular_code(params[0], params[1], params[2]);
+        } else if (kind == "qc" && params.size() == 4) {
+            return make_qc_code(params[0], params[1], params[2], params[3]);
+        }
+        throw std::invalid_argument("Invalid graph specification '" + spec + "'.");
+    }
+
+    /// Codes are built once per graph specification (building the large ones takes a while).
+    const Code &get_code(const std::string &spec) {
+        static std::map<std::string, std::unique_ptr<Code>> codes;
+        auto &code = codes[spec];
+        if (!code) {
+            code = std::make_unique<Code>(make_code(spec));
+        }
+        return *code;
+    }
+
+    std::size_t count_edges(const Code &code) {
+        std::size_t n_edges{};
+        for (const auto &row: code.getPosVarn()) {
+            n_edges += row.size();
+        }
+        return n_edges;
+    }
+
+    // ------------------------------------------------------------------------------------------------------ kernels
+
+    /// Bytes read or written by a kernel, per edge, per variable node and per check node.
+    struct KernelCost {
+        double per_edge{};
+        double per_var_node{};
+        double per_check_node{};
+    };
+
+    /// Inputs and message buffers for a code, in the state after one decoder iteration.
+    struct DecoderState {
+        explicit DecoderState(const Code &code) {
+            std::mt19937_64 rng(42);
+            constexpr double p = 0.03;
+            key.resize(code.getNCols());
+            LDPC4QKD::CodeSimulationHelpers::noise_bitstring_inplace(rng, key, 0.5);
+            code.encode_at_current_rate(key, syndrome);
+            auto noisy_key = key;
+            LDPC4QKD::CodeSimulationHelpers::noise_bitstring_inplace(rng, noisy_key, p);
+            llrs = LDPC4QKD::llrs_bsc(noisy_key, p);
+            decision.resize(key.size());
+
+            code.prepare_workspace(workspace);
+            for (std::size_t i{}; i < workspace.msg_v.size(); ++i) {
+                for (std::size_t j{}; j < workspace.msg_v[i].size(); ++j) {
+                    workspace.msg_v[i][j] = llrs[code.getPosVarn()[i][j]];
+                }
+            }
+            code.check_node_update(workspace.msg_c, workspace.msg_v, syndrome);
+        }
+
+        std::vector<Bit> key;
+        std::vector<Bit> syndrome;
+        std::vector<double> llrs;
+        std::vector<Bit> decision;
+        LDPC4QKD::DecoderWorkspace workspace;
+    };
+
+    void set_counters(benchmark::State &state, const Code &code, const KernelCost &cost) {
+        const auto n_edges = static_cast<double>(count_edges(code));
+        const auto bytes = cost.per_edge * n_edges
+                           + cost.per_var_node * static_cast<double>(code.getNCols())
+                           + cost.per_check_node * static_cast<double>(code.get_n_rows_after_rate_adaption());
+        const auto iterations = static_cast<double>(state.iterations());
+        state.counters["edges/s"] = benchmark::Counter(n_edges * iterations, benchmark::Counter::kIsRate);
+        state.counters["bytes/s"] = benchmark::Counter(bytes * iterations, benchmark::Counter::kIsRate,
+                                                       benchmark::Counter::kIs1024);
+        state.counters["peak_fraction"] = benchmark::Counter(bytes * iterations / peak_bandwidth,
+                                                             benchmark::Counter::kIsRate);
+    }
+
+    constexpr double msg = sizeof(double);
+    constexpr double idx = sizeof(idx_t);
+
+    void BM_check_node_update(benchmark::State &state, const std::string &spec) {
+        const auto &code = get_code(spec);
+        DecoderState s(code);
+        for (auto _: state) {
+            code.check_node_update(s.workspace.msg_c, s.workspace.msg_v, s.syndrome);
+            benchmark::ClobberMemory();
+        }
+        // read msg_v, read pos_varn, write msg_c, read + write output position; read syndrome
+        set_counters(state, code, {2 * msg + 3 * idx, 0, 1});
+    }
+
+    void BM_check_node_update_min_sum(benchmark::State &state, const std::string &spec) {
+        const auto &code = get_code(spec);
+        DecoderState s(code);
+        for (auto _: state) {
+            code.check_node_update_min_sum(s.workspace.msg_c, s.workspace.msg_v, s.syndrome, 0.8);
+            benchmark::ClobberMemory();
+        }
+        set_counters(state, code, {2 * msg + 3 * idx, 0, 1});
+    }
+
+    void BM_var_node_update(benchmark::State &state, const std::string &spec) {
+        const auto &code = get_code(spec);
+        DecoderState s(code);
+        for (auto _: state) {
+            code.var_node_update(s.workspace.msg_v, s.workspace.msg_c, s.llrs);
+            benchmark::ClobberMemory();
+        }
+        // read msg_c, read pos_checkn, write msg_v, read + write output position; read llrs
+        set_counters(state, code, {2 * msg + 3 * idx, msg, 0});
+    }
+
+    void BM_saturate(benchmark::State &state, const std::string &spec) {
+        const auto &code = get_code(spec);
+        DecoderState s(code);
+        for (auto _: state) {
+            Code::saturate(s.workspace.msg_c, 100.);
+            benchmark::ClobberMemory();
+        }
+        set_counters(state, code, {2 * msg, 0, 0});
+    }
+
+    void BM_hard_decision(benchmark::State &state, const std::string &spec) {
+        const auto &code = get_code(spec);
+        DecoderState s(code);
+        for (auto _: state) {
+            code.hard_decision(s.decision, s.llrs, s.workspace.msg_c);
+            benchmark::ClobberMemory();
+        }
+        // read msg_c; read llrs, write decision
+        set_counters(state, code, {msg, msg + sizeof(Bit), 0});
+    }
+
+    void BM_syndrome_check(benchmark::State &state, const std::string &spec) {
+        const auto &code = get_code(spec);
+        DecoderState s(code);
+        for (auto _: state) {
+            benchmark::DoNotOptimize(code.syndrome_matches(s.key, s.syndrome));
+        }
+        // read pos_varn, gather key bit; read syndrome
+        set_counters(state, code, {idx + sizeof(Bit), 0, sizeof(Bit)});
+    }
+
+    void BM_encode_no_ra(benchmark::State &state, const std::string &spec) {
+        const auto &code = get_code(spec);
+        DecoderState s(code);
+        std::vector<Bit> syndrome;
+        for (auto _: state) {
+            code.encode_no_ra(s.key, syndrome);
+            benchmark::DoNotOptimize(syndrome.data());
+            benchmark::ClobberMemory();
+        }
+        // read pos_varn, gather key bit; write syndrome
+        set_counters(state, code, {idx + sizeof(Bit), 0, sizeof(Bit)});
+    }
+
+    void BM_encode_with_ra(benchmark::State &state, const std::string &spec) {
+        const auto &code = get_code(spec);
+        DecoderState s(code);
+        std::vector<Bit> syndrome;
+        const auto syndrome_size = code.get_n_rows_mother_matrix() - code.get_max_ra_steps() / 2;
+        for (auto _: state) {
+            code.encode_with_ra(s.key, syndrome, syndrome_size);
+            benchmark::DoNotOptimize(syndrome.data());
+            benchmark::ClobberMemory();
+        }
+        // as `encode_no_ra`, plus temporary syndrome (write, read) and combined rows (read)
+        set_counters(state, code, {idx + sizeof(Bit), 0, 3 * sizeof(Bit) + idx});
+    }
+
+    void BM_set_rate(benchmark::State &state, const std::string &spec) {
+        auto code = get_code(spec);
+        const auto n_line_combs = code.get_max_ra_steps() / 2;
+        for (auto _: state) {
+            code.set_rate(n_line_combs);
+            benchmark::DoNotOptimize(code.getPosVarn().data());
+            state.PauseTiming();
+            code.set_rate(0);
+            state.ResumeTiming();
+        }
+        // copy mother rows, write pos_varn and pos_checkn (allocation dominated, rough estimate)
+        set_counters(state, code, {4 * idx, 0, 0});
+    }
+
+    void register_benchmarks(const std::string &spec) {
+        using Fn = void (*)(benchmark::State &, const std::string &);
+        const std::vector<std::pair<std::string, Fn>> kernels{
+                {"check_node_update",         BM_check_node_update},
+                {"check_node_update_min_sum", BM_check_node_update_min_sum},
+                {"var_node_update",           BM_var_node_update},
+                {"saturate",                  BM_saturate},
+                {"hard_decision",             BM_hard_decision},
+                {"syndrome_check",            BM_syndrome_check},
+                {"encode_no_ra",              BM_encode_no_ra},
+                {"encode_with_ra",            BM_encode_with_ra},
+                {"set_rate",                  BM_set_rate},
+        };
+        for (const auto &[name, fn]: kernels) {
+            benchmark::RegisterBenchmark((name + "/" + spec).c_str(), fn, spec)->Unit(benchmark::kMicrosecond);
+        }
+    }
+
+}
+
+
+int main(int argc, char **argv) {
+    benchmark::Initialize(&argc, argv);
+
+    // Real codes (the largest embedded codes are omitted by default; add e.g. `--graphs=embedded:2`)
+    std::vector<std::string> graphs{"embedded:0", "embedded:3", "embedded:1", "embedded:4",
+                                    "regular:65536:3:6", "regular:65536:3:12", "qc:8:24:3:1024"};
+    for (int i = 1; i < argc; ++i) {
+        constexpr auto prefix = "--graphs=";
+        if (std::strncmp(argv[i], prefix, std::strlen(prefix)) == 0) {
+            const auto extra = LDPC4QKD::CodeSimulationHelpers::parse_comma_separated<std::string>(
+                    argv[i] + std::strlen(prefix));
+            graphs.insert(graphs.end(), extra.begin(), extra.end());
+        } else {
+            std::cerr << "Unknown argument '" << argv[i] << "'." << std::endl;
+            return 1;
+        }
+    }
+    for (const auto &spec: graphs) {
+        register_benchmarks(spec);
+    }
+
+    peak_bandwidth = measure_peak_bandwidth();
+    std::cout << "Measured peak memory bandwidth (STREAM triad): " << peak_bandwidth / (1 << 30) << " GiB/s\n";
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
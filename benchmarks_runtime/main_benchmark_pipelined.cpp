@@ -0,0 +1,131 @@
+//
+// Created by alice on 18.10.26.
+//
+// Throughput of pipelined batch decoding (`PipelinedDecoder`, check and variable node updates of different frames
+// on two threads) compared to frame-parallel decoding (`DecodingService`, one frame per thread),
+// on the embedded codes of medium size (16384 and 24576 bits), where the working set of the two pipelined frames
+// may fit into a shared cache while that of one frame per thread does not.
+//
+// Both use the same total number of threads (the benchmark argument): `n_threads / 2` pipelined decoders
+// receiving the frames in turn, or a thread pool with `n_threads` workers.
+// Every iteration decodes a batch of frames at the mother rate and reports `frames/s` and `bits/s`.
+//
+
+// Standard library
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Google Benchmark library
+#include <benchmark/benchmark.h>
+
+// Project scope
+#include "LDPC4QKD/code_registry.hpp"
+#include "LDPC4QKD/decoding_service.hpp"
+#include "LDPC4QKD/pipelined_decoding.hpp"
+#include "LDPC4QKD/embedded_codes.hpp"
+#include "benchmarks_error_rate/code_simulation_helpers.hpp"
+
+
+using idx_t = std::uint32_t;
+using Bit = std::uint8_t;
+
+namespace {
+
+    constexpr std::size_t frames_per_batch = 32;
+    constexpr double qber = 0.03;
+
+    /// Noisy keys (as LLRs) and syndromes of a batch of random frames at the mother rate of the code.
+    struct Batch {
+        std::vector<std::vector<double>> llrs;
+        std::vector<std::vector<Bit>> syndromes;
+    };
+
+    Batch make_batch(const LDPC4QKD::RateAdaptiveCode<idx_t> &code) {
+        std::mt19937_64 rng(code.getNCols());
+        Batch batch;
+        for (std::size_t i{}; i < frames_per_batch; ++i) {
+            std::vector<Bit> key(code.getNCols());
+            LDPC4QKD::CodeSimulationHelpers::noise_bitstring_inplace(rng, key, 0.5);
+            batch.syndromes.emplace_back();
+            code.encode_no_ra(key, batch.syndromes.back());
+            LDPC4QKD::CodeSimulationHelpers::noise_bitstring_inplace(rng, key, qber);
+            batch.llrs.push_back(LDPC4QKD::llrs_bsc(key, qber));
+        }
+        return batch;
+    }
+
+    void set_counters(benchmark::State &state, std::size_t n_bits, std::size_t n_failed) {
+        const auto n_frames = static_cast<double>(state.iterations()) * static_cast<double>(frames_per_batch);
+        state.counters["frames/s"] = benchmark::Counter(n_frames, benchmark::Counter::kIsRate);
+        state.counters["bits/s"] = benchmark::Counter(n_frames * static_cast<double>(n_bits),
+                                                      benchmark::Counter::kIsRate);
+        state.counters["failed"] = static_cast<double>(n_failed);
+    }
+
+    void BM_pipelined(benchmark::State &state, std::size_t code_id) {
+        const auto code = std::make_shared<const LDPC4QKD::RateAdaptiveCode<idx_t>>(
+                LDPC4QKD::get_embedded_code<idx_t>(code_id));
+        const auto batch = make_batch(*code);
+        std::vector<std::unique_ptr<LDPC4QKD::PipelinedDecoder<idx_t>>> decoders;
+        for (std::int64_t i{}; i < std::max<std::int64_t>(1, state.range(0) / 2); ++i) {
+            decoders.push_back(std::make_unique<LDPC4QKD::PipelinedDecoder<idx_t>>(code));
+        }
+
+        std::size_t n_failed{};
+        std::vector<std::future<LDPC4QKD::DecodingResult>> results;
+        for (auto _: state) {
+            results.clear();
+            for (std::size_t i{}; i < frames_per_batch; ++i) {
+                results.push_back(decoders[i % decoders.size()]->submit(batch.llrs[i], batch.syndromes[i]));
+            }
+            for (auto &result: results) {
+                n_failed += !result.get().success;
+            }
+        }
+        set_counters(state, code->getNCols(), n_failed);
+    }
+
+    void BM_frame_parallel(benchmark::State &state, std::size_t code_id) {
+        LDPC4QKD::CodeRegistry<idx_t> registry;
+        LDPC4QKD::add_embedded_codes(registry);
+        LDPC4QKD::ThreadPool pool(static_cast<std::size_t>(state.range(0)));
+        LDPC4QKD::DecodingService<idx_t> service(registry, pool);
+        const auto code = registry.get_mother_code(code_id);
+        const auto batch = make_batch(*code);
+
+        std::size_t n_failed{};
+        std::vector<std::future<LDPC4QKD::DecodingResult>> results;
+        for (auto _: state) {
+            results.clear();
+            for (std::size_t i{}; i < frames_per_batch; ++i) {
+                results.push_back(service.submit(code_id, batch.llrs[i], batch.syndromes[i]));
+            }
+            for (auto &result: results) {
+                n_failed += !result.get().success;
+            }
+        }
+        set_counters(state, code->getNCols(), n_failed);
+    }
+
+}
+
+
+int main(int argc, char **argv) {
+    benchmark::Initialize(&argc, argv);
+
+    for (const std::size_t code_id: {4u, 1u}) {  // 8192x16384 and 8192x24576
+        const auto name = LDPC4QKD::get_embedded_code_name(code_id);
+        benchmark::RegisterBenchmark(("pipelined/" + name).c_str(), BM_pipelined, code_id)
+                ->Arg(2)->Arg(4)->UseRealTime()->Unit(benchmark::kMillisecond);
+        benchmark::RegisterBenchmark(("frame_parallel/" + name).c_str(), BM_frame_parallel, code_id)
+                ->Arg(2)->Arg(4)->UseRealTime()->Unit(benchmark::kMillisecond);
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
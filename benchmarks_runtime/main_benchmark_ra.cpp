@@ -10,17 +10,17 @@
 #include <benchmark/benchmark.h>
 
 // Project scope
-#include "rate_adaptive_code.hpp"
+#include "LDPC4QKD/rate_adaptive_code.hpp"
 // Test cases test against constants known to be correct for the LDPC-matrix defined here:
-#include "autogen_ldpc_matrix_csc.hpp"
-#include "autogen_rate_adaption.hpp"
+#include "fortest_autogen_ldpc_matrix_csc.hpp"
+#include "fortest_autogen_rate_adaption.hpp"
 
 
-LDPC4QKD::RateAdaptiveCode get_code_big_wra() {
+LDPC4QKD::RateAdaptiveCode<std::uint16_t> get_code_big_wra() {
     std::vector<std::uint32_t> colptr(AutogenLDPC::colptr.begin(), AutogenLDPC::colptr.end());
     std::vector<std::uint16_t> row_idx(AutogenLDPC::row_idx.begin(), AutogenLDPC::row_idx.end());
     std::vector<std::uint16_t> rows_to_combine(AutogenRateAdapt::rows.begin(), AutogenRateAdapt::rows.end());
-    return LDPC4QKD::RateAdaptiveCode(colptr, row_idx, rows_to_combine);
+    return LDPC4QKD::RateAdaptiveCode<std::uint16_t>(colptr, row_idx, rows_to_combine);
 }
 
 
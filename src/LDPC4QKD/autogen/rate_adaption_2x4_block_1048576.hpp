@@ -3,6 +3,9 @@
 // of an LDPC code in a rate-adaptive manner.
 // These row indices are obtained via optimization of the particular LDPC matrix.
 
+#ifndef LDPC4QKD_AUTOGEN_RATE_ADAPTION_2X4_BLOCK_1048576_HPP
+#define LDPC4QKD_AUTOGEN_RATE_ADAPTION_2X4_BLOCK_1048576_HPP
+
 #include <cstdint>
 #include <array>
 
@@ -5257,3 +5260,5 @@ constexpr inline std::array<std::uint32_t, num_combined_rows> rows = {
 };
 
 } // namespace RALDPC
+
+#endif //LDPC4QKD_AUTOGEN_RATE_ADAPTION_2X4_BLOCK_1048576_HPP
@@ -3,6 +3,9 @@
 // of an LDPC code in a rate-adaptive manner.
 // These row indices are obtained via optimization of the particular LDPC matrix.
 
+#ifndef LDPC4QKD_AUTOGEN_RATE_ADAPTION_2X6_BLOCK_6144_HPP
+#define LDPC4QKD_AUTOGEN_RATE_ADAPTION_2X6_BLOCK_6144_HPP
+
 #include <cstdint>
 #include <array>
 
@@ -35,3 +38,5 @@ constexpr inline std::array<std::uint16_t, num_combined_rows> rows = {
 };
 
 } // namespace RALDPC
+
+#endif //LDPC4QKD_AUTOGEN_RATE_ADAPTION_2X6_BLOCK_6144_HPP
@@ -0,0 +1,404 @@
+//
+// Created by alice on 18.10.26.
+//
+// Registry of LDPC codes shared by several decoding threads.
+// Codes are identified by an integer `code_id` (in the order in which they were added) and built on first use,
+// or in the background using `CodeRegistry::preload`.
+
+#ifndef LDPC4QKD_CODE_REGISTRY_HPP
+#define LDPC4QKD_CODE_REGISTRY_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rate_adaptive_code.hpp"
+#include "thread_pool.hpp"
+
+
+namespace LDPC4QKD {
+
+    /*!
+     * Thread-safe collection of `DecoderWorkspace`s for one code at one rate.
+     *
+     * Decoding threads take a workspace (`acquire`) and give it back automatically when the `Lease` is destroyed,
+     * so that the message buffers are allocated only once per thread instead of once per frame.
+     */
+    class DecoderWorkspacePool {
+    public:
+        /// Exclusive access to a workspace. Returns the workspace to the pool on destruction.
+        class Lease {
+        public:
+            Lease(DecoderWorkspacePool &pool, std::unique_ptr<DecoderWorkspace> workspace)
+                    : pool(&pool), workspace(std::move(workspace)) {}
+
+            Lease(Lease &&) noexcept = default;
+
+            Lease &operator=(Lease &&) = delete;
+
+            ~Lease() {
+                if (workspace) {
+                    pool->release(std::move(workspace));
+                }
+            }
+
+            DecoderWorkspace &operator*() const {
+                return *workspace;
+            }
+
+            DecoderWorkspace *operator->() const {
+                return workspace.get();
+            }
+
+        private:
+            DecoderWorkspacePool *pool;
+            std::unique_ptr<DecoderWorkspace> workspace;
+        };
+
+        DecoderWorkspacePool() = default;
+
+        DecoderWorkspacePool(const DecoderWorkspacePool &) = delete;
+
+        DecoderWorkspacePool &operator=(const DecoderWorkspacePool &) = delete;
+
+        /// Take a workspace from the pool (or a new, empty one if none is available).
+        Lease acquire() {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (available.empty()) {
+                lock.unlock();
+                return Lease(*this, std::make_unique<DecoderWorkspace>());
+            }
+            auto workspace = std::move(available.back());
+            available.pop_back();
+            return Lease(*this, std::move(workspace));
+        }
+
+        /// Allocate workspaces for `code` until at least `n` are available.
+        template<typename Code>
+        void fill(std::size_t n, const Code &code) {
+            while (n_available() < n) {
+                auto workspace = std::make_unique<DecoderWorkspace>();
+                code.prepare_workspace(*workspace);
+                release(std::move(workspace));
+            }
+        }
+
+        [[nodiscard]] std::size_t n_available() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return available.size();
+        }
+
+    private:
+        void release(std::unique_ptr<DecoderWorkspace> workspace) {
+            std::lock_guard<std::mutex> lock(mutex);
+            available.push_back(std::move(workspace));
+        }
+
+        mutable std::mutex mutex;
+        std::vector<std::unique_ptr<DecoderWorkspace>> available;
+    };
+
+
+    /*!
+     * Specifies what `CodeRegistry::preload` builds in the background.
+     */
+    struct PreloadOptions {
+        /// Codes whose mother code is built. Empty means all registered codes.
+        std::vector<std::size_t> code_ids;
+
+        /// Rate adapted codes to build, as pairs (code_id, syndrome_size). Each is built after its mother code.
+        std::vector<std::pair<std::size_t, std::size_t>> rates;
+
+        /// Number of decoder workspaces allocated for each entry of `rates`.
+        std::size_t workspaces_per_rate{};
+
+        /// Codes with at least this size hint (see `CodeRegistry::add_code`) are built at `TaskPriority::low`,
+        /// so that the builds of smaller codes and frames submitted meanwhile do not wait for them.
+        std::size_t low_priority_size_hint = std::size_t{1} << 17;
+    };
+
+
+    /*!
+     * Thread-safe collection of rate adaptive LDPC codes.
+     *
+     * `RateAdaptiveCode::set_rate` modifies the code, so a single code object cannot be shared by threads decoding
+     * at different rates. Instead, the registry keeps one immutable code object per (code, rate) pair that has been
+     * requested so far. These are handed out as `shared_ptr<const RateAdaptiveCode>`, on which
+     * `decode_at_current_rate` and the encoding functions can be called concurrently.
+     *
+     * Every (code, rate) pair is built exactly once, by the first thread requesting it (or by `preload`).
+     * Other threads requesting it in the meantime wait for the result, while codes at other rates remain available.
+     * If building fails, the exception is rethrown to everyone requesting that code.
+     *
+     * Note: every rate adapted code object holds a copy of the mother matrix.
+     * For the largest codes, only request the rates that are actually used.
+     *
+     * @tparam idx_t unsigned integer type fitting number of columns N of every code (see `RateAdaptiveCode`)
+     */
+    template<typename idx_t=std::uint32_t>
+    class CodeRegistry {
+    public:
+        using Code = RateAdaptiveCode<idx_t>;
+
+        /// Creates the code without rate adaption applied (called at most once per code).
+        using CodeFactory = std::function<Code()>;
+
+        CodeRegistry() = default;
+
+        CodeRegistry(const CodeRegistry &) = delete;
+
+        CodeRegistry &operator=(const CodeRegistry &) = delete;
+
+        /*!
+         * Add a code to the registry. The code is not built until it is first requested (or preloaded).
+         *
+         * @param name human readable name (e.g. the file path or name of the embedded code)
+         * @param factory function that creates the code (with rate adaption specification, at the mother rate)
+         * @param size_hint estimated cost of building the code (e.g. number of columns). `preload` builds codes
+         *      with small hints first, so that they become available early.
+         * @return code_id used to refer to this code
+         */
+        std::size_t add_code(std::string name, CodeFactory factory, std::size_t size_hint = 0) {
+            std::lock_guard<std::mutex> lock(entries_mutex);
+            auto entry = std::make_unique<Entry>();
+            entry->name = std::move(name);
+            entry->factory = std::move(factory);
+            entry->size_hint = size_hint;
+            entries.push_back(std::move(entry));
+            return entries.size() - 1;
+        }
+
+        [[nodiscard]] std::size_t size() const {
+            std::lock_guard<std::mutex> lock(entries_mutex);
+            return entries.size();
+        }
+
+        [[nodiscard]] std::string get_name(std::size_t code_id) const {
+            return get_entry(code_id).name;
+        }
+
+        /// Code without rate adaption. Builds the code if necessary.
+        std::shared_ptr<const Code> get_mother_code(std::size_t code_id) {
+            return get(code_id, 0);
+        }
+
+        /*!
+         * Code with the requested rate adaption. Builds the code (or the rate adapted version) if necessary.
+         *
+         * @param code_id id returned by `add_code`
+         * @param n_line_combs number of line combinations (rate adaption steps, see `RateAdaptiveCode::set_rate`)
+         */
+        std::shared_ptr<const Code> get(std::size_t code_id, std::size_t n_line_combs) {
+            auto code = get_rate_entry(code_id, n_line_combs).code;  // copy, so `get` is not called concurrently
+            return code.get();
+        }
+
+        /// Code at the rate that produces syndromes of size `syndrome_size` (as in `RateAdaptiveCode::decode_infer_rate`).
+        std::shared_ptr<const Code> get_for_syndrome_size(std::size_t code_id, std::size_t syndrome_size) {
+            return get(code_id, n_line_combs_for_syndrome_size(code_id, syndrome_size));
+        }
+
+        /*!
+         * Decoder workspaces for the code with the requested rate adaption.
+         * Builds the code if necessary. The returned reference is valid for the lifetime of the registry.
+         */
+        DecoderWorkspacePool &get_workspace_pool(std::size_t code_id, std::size_t n_line_combs) {
+            auto &rate_entry = get_rate_entry(code_id, n_line_combs);
+            auto code = rate_entry.code;
+            code.wait();
+            return rate_entry.workspaces;
+        }
+
+        /// True if the code with the requested rate adaption has been built (successfully or not). Never blocks.
+        [[nodiscard]] bool is_ready(std::size_t code_id, std::size_t n_line_combs = 0) const {
+            auto &entry = get_entry(code_id);
+            std::lock_guard<std::mutex> lock(entry.mutex);
+            const auto it = entry.rates.find(n_line_combs);
+            return it != entry.rates.end()
+                   && it->second.code.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        }
+
+        /*!
+         * Build codes in the background, using the worker threads of `pool`.
+         *
+         * Mother codes are built concurrently, in order of increasing size hint (see `add_code`), so small codes
+         * become available first. Codes with large size hints are built at low priority.
+         * When a mother code is built, the requested rate adapted codes of it and their decoder workspaces are queued,
+         * such that no worker waits for the build of another code.
+         * Codes can be requested while preloading is in progress; requests for codes that are not ready yet
+         * either wait for the background build or build the code on the calling thread.
+         *
+         * @param pool thread pool executing the build tasks (must outlive them)
+         * @param options codes and rates to build
+         * @return one future per mother code, followed by one future per entry of `options.rates`.
+         *      Exceptions thrown while building are stored in these.
+         */
+        std::vector<std::future<void>> preload(ThreadPool &pool, const PreloadOptions &options = {}) {
+            auto code_ids = options.code_ids;
+            if (code_ids.empty()) {
+                code_ids.resize(size());
+                for (std::size_t i{}; i < code_ids.size(); ++i) {
+                    code_ids[i] = i;
+                }
+            }
+
+            // rates are built by tasks queued at the end of the build of their mother code
+            std::map<std::size_t, std::vector<RateBuild>> rate_builds;
+            std::vector<std::future<void>> rate_results;
+            for (auto [code_id, syndrome_size]: options.rates) {
+                RateBuild build{syndrome_size, std::make_shared<std::promise<void>>()};
+                rate_results.push_back(build.done->get_future());
+                rate_builds[code_id].push_back(std::move(build));
+                if (std::find(code_ids.begin(), code_ids.end(), code_id) == code_ids.end()) {
+                    code_ids.push_back(code_id);
+                }
+            }
+            std::stable_sort(code_ids.begin(), code_ids.end(), [this](std::size_t lhs, std::size_t rhs) {
+                return get_entry(lhs).size_hint < get_entry(rhs).size_hint;
+            });
+
+            std::vector<std::future<void>> results;
+            for (auto code_id: code_ids) {
+                const auto priority = (get_entry(code_id).size_hint >= options.low_priority_size_hint)
+                                      ? TaskPriority::low : TaskPriority::normal;
+                auto builds = std::move(rate_builds[code_id]);
+                results.push_back(pool.submit(
+                        [this, &pool, code_id, builds = std::move(builds), priority,
+                                n_workspaces = options.workspaces_per_rate]() {
+                            try {
+                                get_mother_code(code_id);
+                            } catch (...) {
+                                for (const auto &build: builds) {
+                                    build.done->set_exception(std::current_exception());
+                                }
+                                throw;
+                            }
+                            for (const auto &build: builds) {
+                                submit_rate_build(pool, code_id, build, n_workspaces, priority);
+                            }
+                        }, priority));
+            }
+            std::move(rate_results.begin(), rate_results.end(), std::back_inserter(results));
+            return results;
+        }
+
+    private:
+        /// A rate adapted code to build in the background (see `preload`).
+        struct RateBuild {
+            std::size_t syndrome_size{};
+            std::shared_ptr<std::promise<void>> done;
+        };
+
+        void submit_rate_build(ThreadPool &pool, std::size_t code_id, const RateBuild &build,
+                               std::size_t n_workspaces, TaskPriority priority) {
+            try {
+                pool.submit([this, code_id, build, n_workspaces]() {
+                    try {
+                        const auto n_line_combs = n_line_combs_for_syndrome_size(code_id, build.syndrome_size);
+                        get_workspace_pool(code_id, n_line_combs).fill(n_workspaces, *get(code_id, n_line_combs));
+                        build.done->set_value();
+                    } catch (...) {
+                        build.done->set_exception(std::current_exception());
+                    }
+                }, priority);
+            } catch (...) {
+                build.done->set_exception(std::current_exception());  // the pool is stopping
+            }
+        }
+
+        /// A code at one rate. Built by the thread that sets `build_started`.
+        struct RateEntry {
+            RateEntry() : code(promise.get_future().share()) {}
+
+            bool build_started{};
+            std::promise<std::shared_ptr<const Code>> promise;
+            std::shared_future<std::shared_ptr<const Code>> code;
+            DecoderWorkspacePool workspaces;
+        };
+
+        struct Entry {
+            std::string name;
+            CodeFactory factory;
+            std::size_t size_hint{};
+            mutable std::mutex mutex;  // protects `rates` and `build_started` of its elements
+            std::map<std::size_t, RateEntry> rates;  // key: number of line combinations. Zero is the mother code.
+        };
+
+        Entry &get_entry(std::size_t code_id) const {
+            std::lock_guard<std::mutex> lock(entries_mutex);
+            if (code_id >= entries.size()) {
+                std::stringstream s;
+                s << "CodeRegistry: unknown code_id " << code_id << " (number of registered codes: "
+                  << entries.size() << ").";
+                throw std::out_of_range(s.str());
+            }
+            return *entries[code_id];
+        }
+
+        std::size_t n_line_combs_for_syndrome_size(std::size_t code_id, std::size_t syndrome_size) {
+            auto mother = get_mother_code(code_id);
+            if (syndrome_size > mother->get_n_rows_mother_matrix()) {
+                throw std::domain_error("CodeRegistry: syndrome size is larger than the number of mother matrix rows.");
+            }
+            return mother->get_n_rows_mother_matrix() - syndrome_size;
+        }
+
+        /// Returns the entry for the requested rate. Builds the code on the calling thread, if nobody else has started.
+        RateEntry &get_rate_entry(std::size_t code_id, std::size_t n_line_combs) {
+            auto &entry = get_entry(code_id);
+
+            std::shared_ptr<const Code> mother;
+            if (n_line_combs > 0) {
+                mother = get_mother_code(code_id);
+                if (n_line_combs > mother->get_max_ra_steps()) {
+                    std::stringstream s;
+                    s << "CodeRegistry: code '" << entry.name << "' supports at most " << mother->get_max_ra_steps()
+                      << " rate adaption steps (requested " << n_line_combs << ").";
+                    throw std::domain_error(s.str());
+                }
+            }
+
+            RateEntry *rate_entry;
+            {
+                std::lock_guard<std::mutex> lock(entry.mutex);
+                rate_entry = &entry.rates[n_line_combs];  // references to `std::map` elements remain valid
+                if (rate_entry->build_started) {
+                    return *rate_entry;
+                }
+                rate_entry->build_started = true;
+            }
+
+            // build without holding the lock, so other rates of the same code remain available.
+            try {
+                if (n_line_combs == 0) {
+                    rate_entry->promise.set_value(std::make_shared<const Code>(entry.factory()));
+                } else {
+                    auto code = std::make_shared<Code>(*mother);
+                    code->set_rate(n_line_combs);
+                    rate_entry->promise.set_value(std::move(code));
+                }
+            } catch (...) {
+                rate_entry->promise.set_exception(std::current_exception());
+            }
+            return *rate_entry;
+        }
+
+        mutable std::mutex entries_mutex;  // protects `entries` (not the entries themselves)
+        std::vector<std::unique_ptr<Entry>> entries;  // `unique_ptr` keeps references to entries valid
+    };
+
+}
+
+#endif //LDPC4QKD_CODE_REGISTRY_HPP
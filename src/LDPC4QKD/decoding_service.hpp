@@ -0,0 +1,411 @@
+//
+// Created by alice on 18.10.26.
+//
+// Decodes frames for several codes and rates concurrently, using a shared `ThreadPool` and `CodeRegistry`.
+
+#ifndef LDPC4QKD_DECODING_SERVICE_HPP
+#define LDPC4QKD_DECODING_SERVICE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "rate_adaptive_code.hpp"
+#include "code_registry.hpp"
+#include "thread_pool.hpp"
+#include "intra_frame_decoding.hpp"
+
+
+namespace LDPC4QKD {
+
+    /// Outcome of decoding a single frame. See `DecodingService`.
+    struct DecodingResult {
+        bool success{};  /// true if and only if the decoded key matches the syndrome
+        std::vector<std::uint8_t> key;  /// decoder's prediction of the key (one bit per entry)
+        double decoding_seconds{};  /// time spent inside the decoder
+        std::size_t n_iterations{};  /// number of BP iterations
+        std::size_t n_threads = 1;  /// number of threads used for the frame (see `ExecutionMode`)
+        std::chrono::steady_clock::time_point finished;  /// when decoding of the frame was done
+    };
+
+    /// How `DecodingService` uses the worker threads of the pool for each frame.
+    enum class ExecutionMode {
+        frame_parallel,  /// every frame is decoded by a single thread, different frames are decoded in parallel
+        intra_frame,  /// every frame is decoded by several threads together (see `decode_intra_frame`)
+        adaptive  /// chosen per frame, from the state of the pool and the `ExecutionCostModel` of the code
+    };
+
+    /*!
+     * Calibrated decoding time of one code, used by `ExecutionMode::adaptive`.
+     * Updated from the measured decoding time of every frame (exponentially weighted moving averages),
+     * so it follows changes of the load (e.g. memory bandwidth shared with other frames).
+     */
+    struct ExecutionCostModel {
+        /// Time of single-threaded decoding per Tanner graph edge and iteration. Zero until a frame was decoded.
+        double seconds_per_edge_iteration{};
+
+        /// Time per iteration of intra-frame decoding, in addition to the single-threaded time divided by the number
+        /// of threads (synchronization of the threads after every phase, shared caches and memory bandwidth).
+        double overhead_seconds_per_iteration{};
+
+        std::size_t n_frames_single{};  /// frames decoded single-threaded so far
+        std::size_t n_frames_intra{};  /// frames decoded intra-frame parallel so far
+
+        /// Predicted decoding time per iteration for a frame with `n_edges` edges using `n_threads` threads.
+        [[nodiscard]] double seconds_per_iteration(std::size_t n_edges, std::size_t n_threads) const {
+            const double single = seconds_per_edge_iteration * static_cast<double>(n_edges);
+            return (n_threads <= 1) ? single : single / static_cast<double>(n_threads) + overhead_seconds_per_iteration;
+        }
+    };
+
+    /// How `DecodingService` schedules frames on the thread pool.
+    struct DecodingSchedule {
+        /// If non-zero, a frame gives up its worker thread after this many decoder iterations and is queued again.
+        /// Its decoder state stays in its workspace, so it may continue on any worker.
+        /// This bounds how long frames queued behind a large frame have to wait for a worker.
+        std::size_t iterations_per_slice = 0;
+
+        /// Frames with at most this many bits are queued with `TaskPriority::high`, all others with `priority`.
+        std::size_t high_priority_max_frame_size = 0;
+
+        TaskPriority priority = TaskPriority::normal;
+
+        /// Frames decoded in time slices (`iterations_per_slice`) always use a single thread.
+        ExecutionMode execution = ExecutionMode::frame_parallel;
+
+        /// Maximum number of threads decoding a single frame. Zero means all workers of the pool.
+        std::size_t max_threads_per_frame = 0;
+
+        /// Initial `ExecutionCostModel::overhead_seconds_per_iteration` of every code, used until a frame of the code
+        /// was decoded intra-frame parallel.
+        double initial_intra_frame_overhead = 50e-6;
+
+        /// Weight of the newest frame in the moving averages of the `ExecutionCostModel`.
+        double calibration_weight = 0.1;
+
+        /// With `ExecutionMode::adaptive`, every `calibration_period`-th frame that could use several threads is
+        /// decoded in the mode that was not chosen, to re-calibrate the cost model of that mode.
+        /// This is skipped if the predicted time of that mode is more than twice that of the chosen mode.
+        /// Zero disables re-calibration.
+        std::size_t calibration_period = 50;
+    };
+
+    /*!
+     * Parallel decoding of many frames, possibly using different codes and rates.
+     *
+     * Each submitted frame is decoded on one of the worker threads of the thread pool.
+     * Depending on `DecodingSchedule::execution`, other (idle) workers help decoding the frame.
+     * With `ExecutionMode::adaptive`, a frame uses several threads only if no other frame is waiting for a worker and
+     * the cost model of its code (calibrated at runtime, see `get_cost_model`) predicts that this is faster.
+     * Thus, small frames and frames arriving under load are decoded single-threaded, while a large frame arriving
+     * at an idle pool is decoded by all workers.
+     * The rate is inferred from the syndrome size and the corresponding code is taken from the registry,
+     * so frames at different rates never share a mutable code object.
+     * Decoder message buffers are reused across frames (see `DecoderWorkspacePool`).
+     *
+     * With time slicing enabled (see `DecodingSchedule`), a large frame yields its worker every few iterations,
+     * such that small (high priority) frames submitted later are decoded without waiting for it to finish.
+     *
+     * The registry and the thread pool must outlive the service (and all futures obtained from it).
+     *
+     * @tparam idx_t index type of the codes in the registry
+     */
+    template<typename idx_t=std::uint32_t>
+    class DecodingService {
+    public:
+        using Bit = std::uint8_t;
+
+        DecodingService(CodeRegistry<idx_t> &registry, ThreadPool &pool, DecoderConfig decoder_config = {},
+                        DecodingSchedule schedule = {})
+                : registry(registry), pool(pool), decoder_config(decoder_config), schedule(schedule) {}
+
+        /// Decode asynchronously using the decoder settings of the service.
+        std::future<DecodingResult> submit(std::size_t code_id, std::vector<double> llrs, std::vector<Bit> syndrome) {
+            return submit(code_id, std::move(llrs), std::move(syndrome), decoder_config);
+        }
+
+        /// Decode asynchronously using the given decoder settings.
+        std::future<DecodingResult> submit(std::size_t code_id, std::vector<double> llrs, std::vector<Bit> syndrome,
+                                           const DecoderConfig &config) {
+            const auto priority = get_priority(llrs.size());
+            if (schedule.iterations_per_slice == 0) {
+                return pool.submit([this, code_id, llrs = std::move(llrs), syndrome = std::move(syndrome), config,
+                                           priority]() {
+                    return decode(code_id, llrs, syndrome, config, priority);
+                }, priority);
+            }
+
+            auto job = std::make_shared<SlicedJob>();
+            job->code_id = code_id;
+            job->llrs = std::move(llrs);
+            job->syndrome = std::move(syndrome);
+            job->config = config;
+            job->priority = priority;
+            job->iterations_per_slice = schedule.iterations_per_slice;
+            auto result = job->promise.get_future();
+            submit_slice(std::move(job));
+            return result;
+        }
+
+        /// Priority of the tasks decoding a frame of `n_bits` bits (see `DecodingSchedule::priority`).
+        /// Work preparing such a frame (e.g. reading it) can be queued with the same priority.
+        [[nodiscard]] TaskPriority get_priority(std::size_t n_bits) const {
+            return (n_bits <= schedule.high_priority_max_frame_size) ? TaskPriority::high : schedule.priority;
+        }
+
+        /*!
+         * Decode a single frame on the calling thread. May be called concurrently.
+         * Workers of the pool may help, according to `DecodingSchedule::execution`.
+         *
+         * @param code_id id of the code in the registry
+         * @param llrs log likelihood ratios of the noisy key (one per code column)
+         * @param syndrome syndrome of the key. Its size determines the rate.
+         * @param config decoder settings
+         * @param priority priority of the tasks of helping workers
+         */
+        DecodingResult decode(std::size_t code_id, const std::vector<double> &llrs, const std::vector<Bit> &syndrome,
+                              const DecoderConfig &config, TaskPriority priority = TaskPriority::normal) {
+            const auto code = registry.get_for_syndrome_size(code_id, syndrome.size());
+            auto workspace = registry.get_workspace_pool(
+                    code_id, code->get_n_rows_mother_matrix() - code->get_n_rows_after_rate_adaption()).acquire();
+            const auto &layout = get_layout(*code);
+
+            DecodingResult result;
+            result.n_threads = choose_n_threads(code_id, layout.n_edges, config);
+            const auto begin = std::chrono::steady_clock::now();
+            if (result.n_threads > 1) {
+                result.success = decode_intra_frame(*code, get_edge_slots(*code), llrs, syndrome, result.key, config,
+                                                    *workspace, pool, result.n_threads - 1, priority);
+            } else {
+                result.success = code->decode_at_current_rate(llrs, syndrome, result.key, config, *workspace);
+            }
+            result.finished = std::chrono::steady_clock::now();
+            result.decoding_seconds = std::chrono::duration<double>(result.finished - begin).count();
+            result.n_iterations = workspace->n_iterations;
+            calibrate(code_id, layout.n_edges, result);
+            return result;
+        }
+
+        /// Calibrated decoding time of the code (see `ExecutionMode::adaptive`). Thread-safe.
+        [[nodiscard]] ExecutionCostModel get_cost_model(std::size_t code_id) const {
+            std::lock_guard<std::mutex> lock(mutex);
+            const auto it = calibrations.find(code_id);
+            return (it == calibrations.end()) ? initial_cost_model() : it->second.model;
+        }
+
+        [[nodiscard]] const DecoderConfig &get_decoder_config() const {
+            return decoder_config;
+        }
+
+        /// Only affects frames submitted after the call. Not thread-safe with respect to concurrent `submit` calls.
+        void set_decoder_config(const DecoderConfig &config) {
+            decoder_config = config;
+        }
+
+        [[nodiscard]] const DecodingSchedule &get_schedule() const {
+            return schedule;
+        }
+
+        /// Only affects frames submitted after the call. Not thread-safe with respect to concurrent `submit` calls.
+        void set_schedule(const DecodingSchedule &new_schedule) {
+            schedule = new_schedule;
+        }
+
+        [[nodiscard]] CodeRegistry<idx_t> &get_registry() const {
+            return registry;
+        }
+
+        [[nodiscard]] ThreadPool &get_thread_pool() const {
+            return pool;
+        }
+
+    private:
+        /// A frame decoded in time slices. Moves between worker threads, but is only used by one at a time.
+        struct SlicedJob {
+            std::size_t code_id{};
+            std::vector<double> llrs;
+            std::vector<Bit> syndrome;
+            DecoderConfig config;
+            TaskPriority priority{};
+            std::size_t iterations_per_slice{};
+            std::shared_ptr<const RateAdaptiveCode<idx_t>> code;  // set by the first slice
+            std::optional<DecoderWorkspacePool::Lease> workspace;
+            DecodingResult result;
+            std::promise<DecodingResult> promise;
+        };
+
+        void submit_slice(std::shared_ptr<SlicedJob> job) {
+            const auto priority = job->priority;
+            pool.submit([this, job = std::move(job)]() mutable { run_slices(std::move(job)); }, priority);
+        }
+
+        /// Runs slices of the frame until it is done, or until other tasks are waiting (then the frame is queued again).
+        void run_slices(std::shared_ptr<SlicedJob> job) {
+            try {
+                while (run_slice(*job)) {
+                    if (pool.queue_size() == 0) {
+                        continue;  // nobody is waiting for this worker
+                    }
+                    try {
+                        submit_slice(job);
+                        return;
+                    } catch (const std::runtime_error &) {
+                        // the pool is stopping and accepts no more tasks: finish the frame on this worker.
+                    }
+                }
+                job->workspace.reset();
+                job->result.finished = std::chrono::steady_clock::now();
+                job->promise.set_value(std::move(job->result));
+            } catch (...) {
+                job->promise.set_exception(std::current_exception());
+            }
+        }
+
+        /// Decodes the next `iterations_per_slice` iterations of the frame. Returns true if it is not done yet.
+        bool run_slice(SlicedJob &job) const {
+            if (!job.code) {
+                job.code = registry.get_for_syndrome_size(job.code_id, job.syndrome.size());
+                job.workspace.emplace(registry.get_workspace_pool(
+                        job.code_id,
+                        job.code->get_n_rows_mother_matrix() - job.code->get_n_rows_after_rate_adaption()).acquire());
+                job.code->decode_start(job.llrs, job.syndrome, **job.workspace);
+            }
+
+            const auto begin = std::chrono::steady_clock::now();
+            const auto status = job.code->decode_continue(job.llrs, job.syndrome, job.result.key, job.config,
+                                                          **job.workspace, job.iterations_per_slice);
+            job.result.decoding_seconds += std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - begin).count();
+            job.result.success = (status == DecoderStatus::converged);
+            job.result.n_iterations = (*job.workspace)->n_iterations;
+            return status == DecoderStatus::suspended;
+        }
+
+        /// Per code and rate: number of edges, and edge positions for intra-frame decoding (built on first use).
+        struct Layout {
+            std::size_t n_edges{};
+            std::shared_ptr<const EdgeSlots<idx_t>> slots;
+        };
+
+        struct Calibration {
+            ExecutionCostModel model;
+            std::size_t n_decisions{};  // frames that could have used several threads
+        };
+
+        [[nodiscard]] ExecutionCostModel initial_cost_model() const {
+            ExecutionCostModel model;
+            model.overhead_seconds_per_iteration = schedule.initial_intra_frame_overhead;
+            return model;
+        }
+
+        /// Code objects of the registry are never destroyed, so they can be identified by their address.
+        const Layout &get_layout(const RateAdaptiveCode<idx_t> &code) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto [it, inserted] = layouts.try_emplace(&code);
+            if (inserted) {
+                for (const auto &row: code.getPosVarn()) {
+                    it->second.n_edges += row.size();
+                }
+            }
+            return it->second;  // references to `std::map` elements remain valid
+        }
+
+        const EdgeSlots<idx_t> &get_edge_slots(const RateAdaptiveCode<idx_t> &code) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto &layout = layouts.at(&code);
+            if (!layout.slots) {
+                layout.slots = std::make_shared<const EdgeSlots<idx_t>>(code);
+            }
+            return *layout.slots;
+        }
+
+        /// Number of threads for decoding a frame with `n_edges` edges, according to `schedule.execution`.
+        std::size_t choose_n_threads(std::size_t code_id, std::size_t n_edges, const DecoderConfig &config) {
+            auto max_threads = pool.size();
+            if (schedule.max_threads_per_frame != 0) {
+                max_threads = std::min(max_threads, schedule.max_threads_per_frame);
+            }
+            if (schedule.execution == ExecutionMode::frame_parallel || max_threads <= 1
+                || config.decimation_rounds != 0 || config.restarts != 0) {
+                return 1;  // not supported by `decode_intra_frame`
+            }
+            if (schedule.execution == ExecutionMode::intra_frame) {
+                return max_threads;
+            }
+
+            if (pool.queue_size() > 0) {
+                return 1;  // other frames are waiting for a worker
+            }
+            const auto n_threads = std::min(max_threads, 1 + pool.n_idle());
+            if (n_threads <= 1) {
+                return 1;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            auto &calibration = get_calibration(code_id);
+            const auto &model = calibration.model;
+            if (model.n_frames_single == 0) {
+                return 1;  // calibrate single-threaded decoding first
+            }
+            const double single = model.seconds_per_iteration(n_edges, 1);
+            const double intra = model.seconds_per_iteration(n_edges, n_threads);
+            bool use_intra = intra < single;
+            if (schedule.calibration_period != 0 && ++calibration.n_decisions % schedule.calibration_period == 0
+                && std::max(single, intra) <= 2 * std::min(single, intra)) {
+                use_intra = !use_intra;
+            }
+            return use_intra ? n_threads : 1;
+        }
+
+        /// Updates the cost model of the code with the measured decoding time of a frame.
+        void calibrate(std::size_t code_id, std::size_t n_edges, const DecodingResult &result) {
+            if (result.n_iterations == 0 || n_edges == 0) {
+                return;
+            }
+            const double seconds_per_iteration = result.decoding_seconds / static_cast<double>(result.n_iterations);
+            const auto average = [this](double &value, double sample, std::size_t n_samples) {
+                value = (n_samples == 0) ? sample
+                                         : (1 - schedule.calibration_weight) * value
+                                           + schedule.calibration_weight * sample;
+            };
+
+            std::lock_guard<std::mutex> lock(mutex);
+            auto &model = get_calibration(code_id).model;
+            if (result.n_threads <= 1) {
+                average(model.seconds_per_edge_iteration,
+                        seconds_per_iteration / static_cast<double>(n_edges), model.n_frames_single++);
+            } else if (model.n_frames_single > 0) {
+                const double overhead = seconds_per_iteration - model.seconds_per_iteration(n_edges, 1)
+                                                                / static_cast<double>(result.n_threads);
+                average(model.overhead_seconds_per_iteration, std::max(0., overhead), model.n_frames_intra++);
+            }
+        }
+
+        /// Requires `mutex` to be locked.
+        Calibration &get_calibration(std::size_t code_id) {
+            auto [it, inserted] = calibrations.try_emplace(code_id);
+            if (inserted) {
+                it->second.model = initial_cost_model();
+            }
+            return it->second;
+        }
+
+        CodeRegistry<idx_t> &registry;
+        ThreadPool &pool;
+        DecoderConfig decoder_config;
+        DecodingSchedule schedule;
+
+        mutable std::mutex mutex;  // protects `layouts` and `calibrations`
+        std::map<const RateAdaptiveCode<idx_t> *, Layout> layouts;
+        std::map<std::size_t, Calibration> calibrations;  // key: code_id
+    };
+
+}
+
+#endif //LDPC4QKD_DECODING_SERVICE_HPP
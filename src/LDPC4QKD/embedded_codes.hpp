@@ -0,0 +1,111 @@
+//
+// Created by alice on 18.10.26.
+//
+// Rate adaptive codes built from the LDPC codes embedded into the binary (`all_encoders_tuple` in
+// `encoder_advanced.hpp`) together with their rate adaption (headers in `autogen/`).
+// Note: this file uses C++20 features!
+
+#ifndef LDPC4QKD_EMBEDDED_CODES_HPP
+#define LDPC4QKD_EMBEDDED_CODES_HPP
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "encoder_advanced.hpp"
+#include "rate_adaptive_code.hpp"
+#include "code_registry.hpp"
+
+#include "autogen/rate_adaption_2x6_block_6144.hpp"
+#include "autogen/rate_adaption_2x6_block_24576.hpp"
+#include "autogen/rate_adaption_2x6_block_1572864.hpp"
+#include "autogen/rate_adaption_2x4_block_4096.hpp"
+#include "autogen/rate_adaption_2x4_block_16384.hpp"
+#include "autogen/rate_adaption_2x4_block_1048576.hpp"
+
+
+namespace LDPC4QKD {
+
+    /// Number of embedded codes. Valid `code_id`s are `0, ..., n_embedded_codes - 1` (as for `encode_with`).
+    constexpr std::size_t n_embedded_codes = std::tuple_size_v<decltype(all_encoders_tuple)>;
+
+    namespace HelpersEmbeddedCodes {
+        /// Rate adaption belonging to the code at the same index of `all_encoders_tuple`.
+        /// `AutogenRateAdapt_<proto>_block_<N>` belongs to the code with `N` columns.
+        inline const auto all_rate_adaptions_tuple = std::tie(
+                AutogenRateAdapt_2x6_block_6144::rows,
+                AutogenRateAdapt_2x6_block_24576::rows,
+                AutogenRateAdapt_2x6_block_1572864::rows,
+                AutogenRateAdapt_2x4_block_4096::rows,
+                AutogenRateAdapt_2x4_block_16384::rows,
+                AutogenRateAdapt_2x4_block_1048576::rows
+        );
+
+        static_assert(std::tuple_size_v<decltype(all_rate_adaptions_tuple)> == n_embedded_codes,
+                      "Every embedded code needs a rate adaption.");
+
+        template<typename idx_t, std::size_t N = 0>
+        RateAdaptiveCode<idx_t> get_embedded_code(std::size_t code_id) {
+            if (N == code_id) {
+                const auto &encoder = std::get<N>(all_encoders_tuple);
+                const auto &rows = std::get<N>(all_rate_adaptions_tuple);
+
+                const auto pos_varn_small = encoder.get_pos_varn();
+                std::vector<std::vector<idx_t>> pos_varn(pos_varn_small.size());
+                for (std::size_t i{}; i < pos_varn.size(); ++i) {
+                    pos_varn[i].assign(pos_varn_small[i].begin(), pos_varn_small[i].end());
+                }
+                std::vector<idx_t> rows_to_combine(rows.begin(), rows.end());
+                return RateAdaptiveCode<idx_t>(std::move(pos_varn), std::move(rows_to_combine));
+            }
+
+            if constexpr (N + 1 < n_embedded_codes) {
+                return get_embedded_code<idx_t, N + 1>(code_id);
+            } else {
+                throw std::out_of_range("Invalid embedded code_id.");
+            }
+        }
+    }
+
+    /*!
+     * Creates the decoder (including rate adaption) for an LDPC code embedded into the binary.
+     * Constructing the decoder for the largest codes takes a while and needs a lot of memory (compared to the encoder).
+     *
+     * @tparam idx_t unsigned integer type fitting the number of columns of the code
+     *      (the default works for all embedded codes)
+     * @param code_id integer index into `all_encoders_tuple` (same as for `encode_with`)
+     */
+    template<typename idx_t=std::uint32_t>
+    RateAdaptiveCode<idx_t> get_embedded_code(std::size_t code_id) {
+        if (code_id >= n_embedded_codes) {
+            throw std::out_of_range("Invalid embedded code_id " + std::to_string(code_id) + ".");
+        }
+        if (get_input_size(code_id) > std::numeric_limits<idx_t>::max()) {
+            throw std::domain_error("Index type too small for embedded code " + std::to_string(code_id) + ".");
+        }
+        return HelpersEmbeddedCodes::get_embedded_code<idx_t>(code_id);
+    }
+
+    /// Name of an embedded code, of the form "embedded_<M>x<N>".
+    inline std::string get_embedded_code_name(std::size_t code_id) {
+        return "embedded_" + std::to_string(get_output_size(code_id)) + "x" + std::to_string(get_input_size(code_id));
+    }
+
+    /// Adds all embedded codes to the registry (in the order of `all_encoders_tuple`).
+    /// If the registry is empty, the code_id in the registry is the same as for `encode_with`.
+    template<typename idx_t>
+    void add_embedded_codes(CodeRegistry<idx_t> &registry) {
+        for (std::size_t code_id{}; code_id < n_embedded_codes; ++code_id) {
+            registry.add_code(get_embedded_code_name(code_id), [code_id]() {
+                return get_embedded_code<idx_t>(code_id);
+            }, get_input_size(code_id));
+        }
+    }
+
+}
+
+#endif //LDPC4QKD_EMBEDDED_CODES_HPP
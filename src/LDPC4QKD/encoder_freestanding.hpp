@@ -0,0 +1,308 @@
+//
+// Created by alice on 18.10.26.
+//
+// Encoder (syndrome computation, including rate adaption) for small embedded targets.
+// Compared to `encoder_advanced.hpp`, this file
+//  - does not allocate memory (no `std::vector`), all buffers are provided by the caller,
+//  - does not throw exceptions, errors are reported by the return value (`EncoderStatus`),
+//  - does not use virtual functions (the common interface is implemented using CRTP),
+//  - does not use iostreams or `std::stringstream`,
+//  - refers to the constexpr tables of the embedded codes instead of copying them
+//    (the tables stay in read-only memory, e.g. flash).
+// It can be compiled with `-fno-exceptions -fno-rtti`. The running time only depends on the code and the rate.
+// See unit tests (`test_encoder_freestanding.cpp`) for an example of how to use this.
+// Note: this file uses C++20 features!
+
+#ifndef LDPC4QKD_ENCODER_FREESTANDING_HPP
+#define LDPC4QKD_ENCODER_FREESTANDING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <span>
+#include <concepts>
+#include <type_traits>
+
+#include "autogen_ldpc_QC.hpp"
+
+
+namespace LDPC4QKD::Freestanding {
+
+    /// Result of the encoding functions. Outputs are only valid if the status is `ok`.
+    enum class EncoderStatus : std::uint8_t {
+        ok = 0,
+        invalid_key_size,  /// key does not have the number of columns of the code
+        invalid_syndrome_size,  /// syndrome buffer does not match the code (or the rate adaption)
+        invalid_scratch_size,  /// scratch buffer for the mother syndrome is too small
+        unsupported_rate  /// requested syndrome size needs more row combinations than the rate adaption specifies
+    };
+
+    /*!
+     * Row indices of the mother matrix that are combined for rate adaption
+     * (same meaning as `rows_to_combine` in `RateAdaptiveCode`).
+     * Refers to a table (e.g. the ones in `autogen/rate_adaption_*.hpp`), which is not copied.
+     *
+     * @tparam idx_t unsigned integer type of the row indices
+     * @tparam n_rows number of row indices (twice the maximum number of row combinations)
+     */
+    template<std::unsigned_integral idx_t, std::size_t n_rows>
+    struct RateAdaption {
+        static_assert(n_rows % 2 == 0, "Row indices to combine must come in pairs.");
+
+        std::span<const idx_t, n_rows> rows;
+
+        constexpr explicit RateAdaption(const std::array<idx_t, n_rows> &rows) : rows(rows) {}
+
+        [[nodiscard]] static constexpr std::size_t max_row_combinations() {
+            return n_rows / 2;
+        }
+    };
+
+
+    /*!
+     * Common interface of the encoders (CRTP base class). `Derived` has to provide
+     * `void encode_span(std::span<const bit_type, input_size>, std::span<bit_type, output_size>) const`,
+     * which computes the syndrome without any checks (output initialized with zeros by the caller).
+     *
+     * @tparam Derived encoder class implementing `encode_span`
+     * @tparam bit_type e.g. std::uint8_t (one bit per element)
+     * @tparam output_size number of rows of the mother matrix
+     * @tparam input_size number of columns of the mother matrix
+     */
+    template<typename Derived, typename bit_type, std::size_t output_size, std::size_t input_size>
+    struct EncoderBase {
+        static constexpr std::size_t outputSize = output_size;
+        static constexpr std::size_t inputSize = input_size;
+
+        [[nodiscard]] static constexpr std::size_t get_input_size() {
+            return inputSize;
+        }
+
+        [[nodiscard]] static constexpr std::size_t get_output_size() {
+            return outputSize;
+        }
+
+        /// Compute the syndrome using the mother matrix (no rate adaption). Sizes are checked.
+        constexpr EncoderStatus encode(std::span<const bit_type> key, std::span<bit_type> syndrome) const {
+            if (key.size() != input_size) {
+                return EncoderStatus::invalid_key_size;
+            }
+            if (syndrome.size() != output_size) {
+                return EncoderStatus::invalid_syndrome_size;
+            }
+            encode_no_check(std::span<const bit_type, input_size>{key.data(), input_size},
+                            std::span<bit_type, output_size>{syndrome.data(), output_size});
+            return EncoderStatus::ok;
+        }
+
+        /// Compute the syndrome using the mother matrix. Sizes are checked at compile time.
+        constexpr void encode_no_check(std::span<const bit_type, input_size> key,
+                                       std::span<bit_type, output_size> syndrome) const {
+            for (auto &s: syndrome) {
+                s = 0;
+            }
+            static_cast<const Derived *>(this)->encode_span(key, syndrome);
+        }
+
+        /*!
+         * Compute the rate adapted syndrome. Gives the same result as `RateAdaptiveCode::encode_with_ra`.
+         * The size of `syndrome` determines the rate.
+         *
+         * @param rate_adaption rows to combine, must belong to this code (see `is_valid`)
+         * @param key input bits
+         * @param syndrome output. Its size must be between `output_size - max_row_combinations()` and `output_size`.
+         * @param scratch buffer of at least `output_size` elements, used to store the mother syndrome.
+         *      Its contents are overwritten.
+         */
+        template<std::unsigned_integral idx_t, std::size_t n_rows>
+        constexpr EncoderStatus encode_with_ra(const RateAdaption<idx_t, n_rows> &rate_adaption,
+                                               std::span<const bit_type> key,
+                                               std::span<bit_type> syndrome,
+                                               std::span<std::uint8_t> scratch) const {
+            if (syndrome.size() > output_size) {
+                return EncoderStatus::invalid_syndrome_size;
+            }
+            if (output_size - syndrome.size() > rate_adaption.max_row_combinations()) {
+                return EncoderStatus::unsupported_rate;
+            }
+            if (scratch.size() < output_size) {
+                return EncoderStatus::invalid_scratch_size;
+            }
+            if (key.size() != input_size) {
+                return EncoderStatus::invalid_key_size;
+            }
+
+            std::span<std::uint8_t, output_size> mother_syndrome{scratch.data(), output_size};
+            for (auto &s: mother_syndrome) {
+                s = 0;
+            }
+            static_cast<const Derived *>(this)->encode_span(
+                    std::span<const bit_type, input_size>{key.data(), input_size}, mother_syndrome);
+
+            // Value 2 marks mother syndrome bits that have been used for a combined row.
+            constexpr std::uint8_t used = 2;
+            const std::size_t n_line_combinations = output_size - syndrome.size();
+            const std::size_t start_of_ra_part = syndrome.size() - n_line_combinations;
+
+            // put results of combined lines at the back of output.
+            for (std::size_t i{}; i < n_line_combinations; ++i) {
+                auto &first = mother_syndrome[rate_adaption.rows[2 * i]];
+                auto &second = mother_syndrome[rate_adaption.rows[2 * i + 1]];
+                syndrome[start_of_ra_part + i] = static_cast<bit_type>((first != 0) != (second != 0));
+                first = used;
+                second = used;
+            }
+
+            // put the remaining bits that were not rate adapted at the front of output.
+            std::size_t j{};
+            for (std::size_t i{}; i < start_of_ra_part; ++i) {
+                while (mother_syndrome[j] == used) {
+                    j++;
+                }
+                syndrome[i] = static_cast<bit_type>(mother_syndrome[j]);
+                j++;
+            }
+            return EncoderStatus::ok;
+        }
+
+        /// Checks that `encode_with_ra` never accesses the scratch buffer out of bounds using `rate_adaption`:
+        /// all row indices are smaller than `output_size` and every row is combined at most once.
+        /// Check this at compile time, e.g. `static_assert(encoder.is_valid(rate_adaption))`.
+        template<std::unsigned_integral idx_t, std::size_t n_rows>
+        [[nodiscard]] constexpr bool is_valid(const RateAdaption<idx_t, n_rows> &rate_adaption) const {
+            if (n_rows > output_size) {
+                return false;
+            }
+            std::uint64_t used[(output_size + 63) / 64]{};  // one bit per row
+            const idx_t *row = rate_adaption.rows.data();
+            // nested loops, so no single loop exceeds the iteration limit of constant evaluation
+            constexpr std::size_t block_size = 4096;
+            for (std::size_t block = 0; block < n_rows; block += block_size) {
+                const idx_t *block_end = row + (n_rows - block < block_size ? n_rows - block : block_size);
+                for (; row != block_end; ++row) {
+                    const std::uint64_t bit = std::uint64_t{1} << (*row % 64u);
+                    if (*row >= output_size || (used[*row / 64u] & bit) != 0) {
+                        return false;
+                    }
+                    used[*row / 64u] |= bit;
+                }
+            }
+            return true;
+        }
+    };
+
+
+    /*!
+     * Encoder for quasi-cyclic (QC) LDPC codes. Same algorithm as `FixedSizeEncoderQC` in `encoder_advanced.hpp`.
+     * The matrix of QC-exponents is stored in compressed sparse column (CSC) format.
+     * The encoder only refers to the tables, which must have static storage duration (e.g. `autogen_ldpc_QC.hpp`).
+     */
+    template<typename bit_type, std::size_t M, std::size_t N, std::size_t expansion_factor, std::size_t num_nz,
+            std::unsigned_integral colptr_t, std::unsigned_integral row_idx_t, std::unsigned_integral values_t>
+    struct EncoderQC : public EncoderBase<EncoderQC<bit_type, M, N, expansion_factor, num_nz, colptr_t, row_idx_t,
+            values_t>, bit_type, M * expansion_factor, N * expansion_factor> {
+
+        static_assert(N >= M, "The syndrome should be shorter than the input bitstring.");
+
+        constexpr EncoderQC(const std::array<colptr_t, N + 1> &colptr,
+                            const std::array<row_idx_t, num_nz> &row_idx,
+                            const std::array<values_t, num_nz> &values)
+                : colptr(colptr), row_idx(row_idx), values(values) {}
+
+        using EncoderQC::EncoderBase::is_valid;  // validity of rate adaption tables
+
+        /// Computes syndrome without any checks. The output has to be initialized with zeros.
+        /// Prefer `encode` or `encode_no_check`.
+        template<typename out_bit_type>
+        constexpr void encode_span(std::span<const bit_type, N * expansion_factor> in,
+                                   std::span<out_bit_type, M * expansion_factor> out) const {
+            for (std::size_t col = 0; col < in.size(); col++) {
+                const auto QCcol = col / expansion_factor;  // column index into matrix of exponents
+                for (std::size_t j = colptr[QCcol]; j < colptr[QCcol + 1]; j++) {
+                    const std::size_t shiftVal = values[j];
+                    const std::size_t QCrow = row_idx[j];  // row index into matrix of exponents
+                    // row index (into full matrix) of the `1` in the current column, within the sub-block given by
+                    // the QC-exponent `shiftVal`.
+                    const auto outIdx = (expansion_factor * QCrow) + ((col - shiftVal) % expansion_factor);
+                    out[outIdx] = static_cast<out_bit_type>((out[outIdx] != 0) != (in[col] != 0));
+                }
+            }
+        }
+
+        /// Checks that the encoder never accesses inputs or outputs out of bounds.
+        /// Check this at compile time, e.g. `static_assert(encoder.is_valid())`.
+        [[nodiscard]] constexpr bool is_valid() const {
+            if (colptr[N] != num_nz) {
+                return false;
+            }
+            for (std::size_t QCcol = 0; QCcol < N; QCcol++) {
+                for (std::size_t j = colptr[QCcol]; j < colptr[QCcol + 1]; j++) {
+                    if (row_idx[j] >= M) {  // shift values are used modulo `expansion_factor`
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+    private:
+        std::span<const colptr_t, N + 1> colptr;
+        std::span<const row_idx_t, num_nz> row_idx;
+        std::span<const values_t, num_nz> values;
+    };
+
+
+    /// Creates an `EncoderQC` from the tables of an auto-generated QC-code (see `autogen_ldpc_QC.hpp`).
+    template<std::size_t M, std::size_t expansion_factor, typename bit_type = std::uint8_t,
+            std::unsigned_integral colptr_t, std::unsigned_integral row_idx_t, std::unsigned_integral values_t,
+            std::size_t n_cols_plus_one, std::size_t num_nz>
+    consteval auto make_encoder_qc(const std::array<colptr_t, n_cols_plus_one> &colptr,
+                                   const std::array<row_idx_t, num_nz> &row_idx,
+                                   const std::array<values_t, num_nz> &values) {
+        return EncoderQC<bit_type, M, n_cols_plus_one - 1, expansion_factor, num_nz, colptr_t, row_idx_t, values_t>{
+                colptr, row_idx, values};
+    }
+
+
+    // ------------------------------------------------------------------------- encoders for the codes embedded in this library
+    // same codes (and order) as `all_encoders_tuple` in `encoder_advanced.hpp`.
+
+    constexpr auto encoder_2048x6144_4663d91 = make_encoder_qc<
+            AutogenLDPC_QC_2048x6144_4663d91::M, AutogenLDPC_QC_2048x6144_4663d91::expansion_factor>(
+            AutogenLDPC_QC_2048x6144_4663d91::colptr, AutogenLDPC_QC_2048x6144_4663d91::row_idx,
+            AutogenLDPC_QC_2048x6144_4663d91::values);
+    static_assert(encoder_2048x6144_4663d91.is_valid());
+
+    constexpr auto encoder_8192x24576_71b51c1 = make_encoder_qc<
+            AutogenLDPC_QC_8192x24576_71b51c1::M, AutogenLDPC_QC_8192x24576_71b51c1::expansion_factor>(
+            AutogenLDPC_QC_8192x24576_71b51c1::colptr, AutogenLDPC_QC_8192x24576_71b51c1::row_idx,
+            AutogenLDPC_QC_8192x24576_71b51c1::values);
+    static_assert(encoder_8192x24576_71b51c1.is_valid());
+
+    constexpr auto encoder_524288x1572864_4d78a9f = make_encoder_qc<
+            AutogenLDPC_QC_524288x1572864_4d78a9f::M, AutogenLDPC_QC_524288x1572864_4d78a9f::expansion_factor>(
+            AutogenLDPC_QC_524288x1572864_4d78a9f::colptr, AutogenLDPC_QC_524288x1572864_4d78a9f::row_idx,
+            AutogenLDPC_QC_524288x1572864_4d78a9f::values);
+    static_assert(encoder_524288x1572864_4d78a9f.is_valid());
+
+    constexpr auto encoder_2048x4096_0c809c3 = make_encoder_qc<
+            AutogenLDPC_QC_2048x4096_0c809c3::M, AutogenLDPC_QC_2048x4096_0c809c3::expansion_factor>(
+            AutogenLDPC_QC_2048x4096_0c809c3::colptr, AutogenLDPC_QC_2048x4096_0c809c3::row_idx,
+            AutogenLDPC_QC_2048x4096_0c809c3::values);
+    static_assert(encoder_2048x4096_0c809c3.is_valid());
+
+    constexpr auto encoder_8192x16384_3fcad37 = make_encoder_qc<
+            AutogenLDPC_QC_8192x16384_3fcad37::M, AutogenLDPC_QC_8192x16384_3fcad37::expansion_factor>(
+            AutogenLDPC_QC_8192x16384_3fcad37::colptr, AutogenLDPC_QC_8192x16384_3fcad37::row_idx,
+            AutogenLDPC_QC_8192x16384_3fcad37::values);
+    static_assert(encoder_8192x16384_3fcad37.is_valid());
+
+    constexpr auto encoder_524288x1048576_9b50f98 = make_encoder_qc<
+            AutogenLDPC_QC_524288x1048576_9b50f98::M, AutogenLDPC_QC_524288x1048576_9b50f98::expansion_factor>(
+            AutogenLDPC_QC_524288x1048576_9b50f98::colptr, AutogenLDPC_QC_524288x1048576_9b50f98::row_idx,
+            AutogenLDPC_QC_524288x1048576_9b50f98::values);
+    static_assert(encoder_524288x1048576_9b50f98.is_valid());
+
+}
+
+#endif //LDPC4QKD_ENCODER_FREESTANDING_HPP
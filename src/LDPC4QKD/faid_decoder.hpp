@@ -0,0 +1,421 @@
+//
+// Created by alice on 18.10.26.
+//
+// Finite alphabet iterative decoder (FAID) on the graph of a `RateAdaptiveCode`.
+// Messages take one of seven levels (-3, ..., 3) and are stored as 3 bit sign and magnitude, two messages per byte.
+// Check nodes compute the sign and minimum magnitude (as min-sum), variable nodes use a lookup table.
+// Only the sign of the channel LLRs is used (binary symmetric channel).
+
+#ifndef LDPC4QKD_FAID_DECODER_HPP
+#define LDPC4QKD_FAID_DECODER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rate_adaptive_code.hpp"
+
+
+namespace LDPC4QKD {
+
+    /*!
+     * Variable node rule of the finite alphabet iterative decoder (see `FaidDecoder`).
+     *
+     * A variable node of degree `d` adds up `channel_weight * y` (`y` being the channel sign, plus or minus one) and
+     * the weights (`levels`) of the incoming messages of the other `d - 1` edges. The outgoing message is the entry
+     * of the lookup table at this sum `s`. Unless `vn_luts` specifies the table for degree `d`, it has level `k`
+     * (with the sign of `s`), where `k` is the number of `thresholds` that are at most `|s|`.
+     * Use `read_faid_rule_from_json` (in `read_faid_rule.hpp`) to load a rule from a file.
+     */
+    struct FaidRule {
+        /// Maximum number of iterations (the decoder terminates early if it converges).
+        std::size_t max_num_iter = 50;
+
+        // The defaults were chosen by a grid search on the 2048x6144 code at BSC parameter 0.035 (no rate adaption).
+
+        /// Weights of the message levels 1, 2 and 3 (positive and increasing).
+        std::array<int, 3> levels{1, 3, 6};
+
+        /// Weight of the channel.
+        int channel_weight = 2;
+
+        /// Smallest `|s|` that gives the levels 1, 2 and 3 (positive and non-decreasing).
+        std::array<int, 3> thresholds{1, 3, 5};
+
+        /// Explicit lookup tables for some variable node degrees. The table for degree `d` holds the outgoing level
+        /// for `s = -S, ..., S` with `S = channel_weight + (d - 1) * levels[2]`. It must be odd (`f(-s) = -f(s)`).
+        std::map<std::size_t, std::vector<int>> vn_luts;
+
+        bool operator==(const FaidRule &rhs) const {
+            return max_num_iter == rhs.max_num_iter &&
+                   levels == rhs.levels &&
+                   channel_weight == rhs.channel_weight &&
+                   thresholds == rhs.thresholds &&
+                   vn_luts == rhs.vn_luts;
+        }
+
+        bool operator!=(const FaidRule &rhs) const {
+            return !(*this == rhs);
+        }
+    };
+
+    /// Edges of the graph of the code at one rate. Built once per rate and shared by all decodings at this rate.
+    struct FaidGraph {
+        std::vector<std::size_t> cn_offsets;  /// first edge of every check node in `FaidWorkspace::msg_v`
+        std::vector<std::size_t> vn_offsets;  /// first edge of every variable node in `FaidWorkspace::msg_c`
+        std::vector<std::uint32_t> cn_to_vn_edge;  /// index in `msg_c` of every edge of `msg_v`
+        std::vector<std::uint32_t> vn_to_cn_edge;  /// index in `msg_v` of every edge of `msg_c`
+    };
+
+    /// Message buffers of the FAID decoder. A workspace must not be used by several threads at the same time.
+    struct FaidWorkspace {
+        std::vector<std::uint8_t> msg_v;  /// packed messages from variable nodes to check nodes (by check node)
+        std::vector<std::uint8_t> msg_c;  /// packed messages from check nodes to variable nodes (by variable node)
+        std::shared_ptr<const FaidGraph> graph;  /// edges at the rate of the last decoding
+        std::size_t n_iterations{};  /// iterations done by the last decoding
+    };
+
+    namespace HelpersFaid {
+        // A message is stored in 3 bits: bits 0 and 1 hold the magnitude, bit 2 the sign (set if negative).
+        constexpr std::uint8_t sign_bit = 4;
+        constexpr std::uint8_t magnitude_mask = 3;
+
+        inline std::uint8_t get_msg(const std::vector<std::uint8_t> &packed, std::size_t idx) {
+            return static_cast<std::uint8_t>((packed[idx >> 1] >> ((idx & 1) * 4)) & 0xF);
+        }
+
+        inline void set_msg(std::vector<std::uint8_t> &packed, std::size_t idx, std::uint8_t msg) {
+            auto &byte = packed[idx >> 1];
+            const auto shift = (idx & 1) * 4;
+            byte = static_cast<std::uint8_t>((byte & ~(0xF << shift)) | (msg << shift));
+        }
+
+        /// Message with the given level (-3, ..., 3).
+        inline std::uint8_t msg_from_level(int level) {
+            return static_cast<std::uint8_t>(level < 0 ? (sign_bit | -level) : level);
+        }
+
+        inline int level_from_msg(std::uint8_t msg) {
+            const int magnitude = msg & magnitude_mask;
+            return (msg & sign_bit) ? -magnitude : magnitude;
+        }
+    }
+
+    /*!
+     * Finite alphabet iterative decoder (FAID) for binary LDPC codes, see `FaidRule`.
+     * Decodes at the current rate of the given `RateAdaptiveCode`, which must outlive the decoder.
+     * Messages need half a byte per edge (instead of 8 bytes for `double`), and all updates are integer operations.
+     * The edges of the graph are cached for every rate (set of row combinations) the decoder was used at.
+     *
+     * @tparam idx_t same as for `RateAdaptiveCode`
+     */
+    template<typename idx_t=std::uint16_t>
+    class FaidDecoder {
+    public:
+        explicit FaidDecoder(const RateAdaptiveCode<idx_t> &code, FaidRule rule = {})
+                : code(code), rule(std::move(rule)), msg_weights(build_msg_weights(this->rule)) {
+            check_rule(this->rule);
+            const auto max_degree = code.get_max_var_node_degree();
+            vn_luts.resize(max_degree + 1);
+            vn_msg_luts.resize(max_degree + 1);
+            // variable nodes of degree 0 (e.g., all edges cancelled by rate adaption) send no messages
+            for (std::size_t d{1}; d <= max_degree; ++d) {
+                vn_luts[d] = build_vn_lut(d);
+                for (auto level: vn_luts[d]) {
+                    vn_msg_luts[d].push_back(HelpersFaid::msg_from_level(level));
+                }
+            }
+            for (const auto &[degree, lut]: this->rule.vn_luts) {
+                if (degree > max_degree) {
+                    throw std::invalid_argument("FaidDecoder: lookup table for degree " + std::to_string(degree) +
+                                                ", which the code does not have.");
+                }
+            }
+        }
+
+        /*!
+         * Decode at the current rate of the code.
+         *
+         * @tparam Bit: e.g. std::uint8_t or bool
+         * @param llrs: Log likelihood ratios representing the received message (only the signs are used)
+         * @param syndrome: Syndrome of the sent message
+         * @param out: Buffer to which the function writes its prediction for the sent message.
+         * @param workspace: Message buffers (reusing them avoids allocating memory for every frame)
+         * @return true if and only if the syndrome of buffer `out` matches given `syndrome` (i.e., decoder converged).
+         */
+        template<typename Bit>
+        bool decode(const std::vector<double> &llrs,
+                    const std::vector<Bit> &syndrome,
+                    std::vector<Bit> &out,
+                    FaidWorkspace &workspace) const {
+            if (llrs.size() != code.getNCols()) {
+                throw std::runtime_error("FAID decoder received invalid input length.");
+            }
+            if (syndrome.size() != code.get_n_rows_after_rate_adaption()) {
+                throw std::runtime_error("FAID decoder received invalid syndrome size for current rate.");
+            }
+
+            prepare_workspace(workspace);
+            out.resize(llrs.size());
+            initialize_messages(llrs, workspace);
+
+            for (workspace.n_iterations = 1; workspace.n_iterations <= rule.max_num_iter; ++workspace.n_iterations) {
+                check_node_update(workspace, syndrome);
+                var_node_update(workspace, llrs, out);
+                if (code.syndrome_matches(out, syndrome)) {
+                    return true;
+                }
+            }
+            workspace.n_iterations = rule.max_num_iter;
+            return false;
+        }
+
+        /// Same as above, but allocates the message buffers.
+        template<typename Bit>
+        bool decode(const std::vector<double> &llrs, const std::vector<Bit> &syndrome, std::vector<Bit> &out) const {
+            FaidWorkspace workspace;
+            return decode(llrs, syndrome, out, workspace);
+        }
+
+        [[nodiscard]] const FaidRule &get_rule() const {
+            return rule;
+        }
+
+        /// Lookup table used for variable nodes of degree `degree` (see `FaidRule`).
+        [[nodiscard]] const std::vector<std::int8_t> &get_vn_lut(std::size_t degree) const {
+            return vn_luts.at(degree);
+        }
+
+    private:
+        static void check_rule(const FaidRule &rule) {
+            const auto &l = rule.levels;
+            if (l[0] <= 0 || l[1] <= l[0] || l[2] <= l[1]) {
+                throw std::invalid_argument("FaidRule: levels must be positive and increasing.");
+            }
+            const auto &t = rule.thresholds;
+            if (t[0] <= 0 || t[1] < t[0] || t[2] < t[1]) {
+                throw std::invalid_argument("FaidRule: thresholds must be positive and non-decreasing.");
+            }
+            if (rule.channel_weight <= 0) {
+                throw std::invalid_argument("FaidRule: channel weight must be positive.");
+            }
+        }
+
+        /// Largest `|s|` for a variable node of degree `degree` (excluding one edge). `degree` must be positive.
+        [[nodiscard]] int max_abs_sum(std::size_t degree) const {
+            return rule.channel_weight + static_cast<int>(degree - 1) * rule.levels[2];
+        }
+
+        [[nodiscard]] std::vector<std::int8_t> build_vn_lut(std::size_t degree) const {
+            const int S = max_abs_sum(degree);
+            std::vector<std::int8_t> lut(static_cast<std::size_t>(2 * S + 1));
+
+            const auto it = rule.vn_luts.find(degree);
+            if (it != rule.vn_luts.end()) {
+                const auto &given = it->second;
+                if (given.size() != lut.size()) {
+                    throw std::invalid_argument("FaidRule: lookup table for degree " + std::to_string(degree) +
+                                                " must have " + std::to_string(lut.size()) + " entries.");
+                }
+                for (std::size_t i{}; i < lut.size(); ++i) {
+                    if (given[i] < -3 || given[i] > 3 || given[i] != -given[lut.size() - 1 - i]) {
+                        throw std::invalid_argument("FaidRule: lookup table for degree " + std::to_string(degree) +
+                                                    " must be odd, with levels in -3, ..., 3.");
+                    }
+                    lut[i] = static_cast<std::int8_t>(given[i]);
+                }
+                return lut;
+            }
+
+            for (int s = -S; s <= S; ++s) {
+                int level{};
+                for (auto threshold: rule.thresholds) {
+                    level += (std::abs(s) >= threshold);
+                }
+                lut[static_cast<std::size_t>(s + S)] = static_cast<std::int8_t>(s < 0 ? -level : level);
+            }
+            return lut;
+        }
+
+        [[nodiscard]] static std::array<int, 16> build_msg_weights(const FaidRule &rule) {
+            std::array<int, 16> result{};
+            for (std::size_t msg{}; msg < 8; ++msg) {
+                const auto magnitude = msg & HelpersFaid::magnitude_mask;
+                const int w = (magnitude == 0) ? 0 : rule.levels[magnitude - 1];
+                result[msg] = (msg & HelpersFaid::sign_bit) ? -w : w;
+            }
+            return result;
+        }
+
+        [[nodiscard]] int channel_sum(double llr) const {
+            return (llr < 0) ? -rule.channel_weight : rule.channel_weight;
+        }
+
+        /// Edges of the graph at the current rate of the code (cached).
+        [[nodiscard]] std::shared_ptr<const FaidGraph> graph_at_current_rate() const {
+            std::lock_guard<std::mutex> lock(graphs_mutex);
+            auto &graph = graphs[code.get_combinations()];
+            if (!graph) {
+                graph = build_graph();
+            }
+            return graph;
+        }
+
+        [[nodiscard]] std::shared_ptr<const FaidGraph> build_graph() const {
+            const auto &pos_varn = code.getPosVarn();
+            const auto &pos_checkn = code.getPosCheckn();
+            auto graph = std::make_shared<FaidGraph>();
+
+            graph->cn_offsets.resize(pos_varn.size() + 1);
+            graph->cn_offsets[0] = 0;
+            for (std::size_t m{}; m < pos_varn.size(); ++m) {
+                graph->cn_offsets[m + 1] = graph->cn_offsets[m] + pos_varn[m].size();
+            }
+            graph->vn_offsets.resize(pos_checkn.size() + 1);
+            graph->vn_offsets[0] = 0;
+            for (std::size_t v{}; v < pos_checkn.size(); ++v) {
+                graph->vn_offsets[v + 1] = graph->vn_offsets[v] + pos_checkn[v].size();
+            }
+
+            const auto n_edges = graph->cn_offsets.back();
+            if (n_edges > std::numeric_limits<std::uint32_t>::max()) {
+                throw std::runtime_error("FAID decoder supports at most 2^32 - 1 edges.");
+            }
+
+            // The edges of a variable node are ordered by check node (as in `pos_checkn`).
+            graph->cn_to_vn_edge.resize(n_edges);
+            graph->vn_to_cn_edge.resize(n_edges);
+            std::vector<std::size_t> next_vn_edge(graph->vn_offsets.begin(), graph->vn_offsets.end() - 1);
+            for (std::size_t m{}; m < pos_varn.size(); ++m) {
+                for (std::size_t k{}; k < pos_varn[m].size(); ++k) {
+                    const auto cn_edge = graph->cn_offsets[m] + k;
+                    const auto vn_edge = next_vn_edge[pos_varn[m][k]]++;
+                    graph->cn_to_vn_edge[cn_edge] = static_cast<std::uint32_t>(vn_edge);
+                    graph->vn_to_cn_edge[vn_edge] = static_cast<std::uint32_t>(cn_edge);
+                }
+            }
+            return graph;
+        }
+
+        /// Allocates the message buffers for the current rate of the code.
+        void prepare_workspace(FaidWorkspace &workspace) const {
+            workspace.graph = graph_at_current_rate();
+            const auto n_edges = workspace.graph->cn_offsets.back();
+            workspace.msg_v.assign((n_edges + 1) / 2, 0);
+            workspace.msg_c.assign((n_edges + 1) / 2, 0);
+        }
+
+        /// Messages to check nodes if all incoming messages are zero.
+        void initialize_messages(const std::vector<double> &llrs, FaidWorkspace &workspace) const {
+            const auto &graph = *workspace.graph;
+            const auto n_cols = graph.vn_offsets.size() - 1;
+            for (std::size_t v{}; v < n_cols; ++v) {
+                const auto degree = graph.vn_offsets[v + 1] - graph.vn_offsets[v];
+                if (degree == 0) {
+                    continue;
+                }
+                const auto msg = vn_msg_luts[degree][static_cast<std::size_t>(
+                        channel_sum(llrs[v]) + max_abs_sum(degree))];
+                for (auto e = graph.vn_offsets[v]; e < graph.vn_offsets[v + 1]; ++e) {
+                    HelpersFaid::set_msg(workspace.msg_v, graph.vn_to_cn_edge[e], msg);
+                }
+            }
+        }
+
+        /// Messages to variable nodes: sign of the product and minimum magnitude of the other incoming messages.
+        template<typename Bit>
+        void check_node_update(FaidWorkspace &workspace, const std::vector<Bit> &syndrome) const {
+            using namespace HelpersFaid;
+            const auto &graph = *workspace.graph;
+            const auto n_rows = graph.cn_offsets.size() - 1;
+
+            for (std::size_t m{}; m < n_rows; ++m) {
+                const auto first_edge = graph.cn_offsets[m];
+                const auto degree = graph.cn_offsets[m + 1] - first_edge;
+
+                // parity of the signs, and number of incoming messages of every magnitude
+                bool sign_negative = static_cast<bool>(syndrome[m]);
+                std::array<std::size_t, 4> n_with_magnitude{};
+                for (std::size_t k{}; k < degree; ++k) {
+                    const auto msg = get_msg(workspace.msg_v, first_edge + k);
+                    sign_negative = sign_negative != static_cast<bool>(msg & sign_bit);
+                    n_with_magnitude[msg & magnitude_mask]++;
+                }
+                // smallest and second smallest magnitude
+                std::uint8_t min1{};
+                while (min1 < magnitude_mask && n_with_magnitude[min1] == 0) {
+                    min1++;
+                }
+                std::uint8_t min2 = min1;
+                if (n_with_magnitude[min1] < 2 && min1 < magnitude_mask) {
+                    do {
+                        min2++;
+                    } while (min2 < magnitude_mask && n_with_magnitude[min2] == 0);
+                }
+                const bool min1_unique = n_with_magnitude[min1] == 1;
+
+                for (std::size_t k{}; k < degree; ++k) {
+                    const auto msg = get_msg(workspace.msg_v, first_edge + k);
+                    const bool negative = sign_negative != static_cast<bool>(msg & sign_bit);
+                    const auto magnitude = (min1_unique && (msg & magnitude_mask) == min1) ? min2 : min1;
+                    const auto out_msg = static_cast<std::uint8_t>(
+                            (negative && magnitude != 0) ? (sign_bit | magnitude) : magnitude);
+
+                    set_msg(workspace.msg_c, graph.cn_to_vn_edge[first_edge + k], out_msg);
+                }
+            }
+        }
+
+        /// Messages to check nodes (from the lookup tables) and hard decision.
+        template<typename Bit>
+        void var_node_update(FaidWorkspace &workspace, const std::vector<double> &llrs, std::vector<Bit> &out) const {
+            using namespace HelpersFaid;
+            const auto &graph = *workspace.graph;
+            const auto n_cols = graph.vn_offsets.size() - 1;
+
+            for (std::size_t v{}; v < n_cols; ++v) {
+                const auto first_edge = graph.vn_offsets[v];
+                const auto degree = graph.vn_offsets[v + 1] - first_edge;
+                const int channel = channel_sum(llrs[v]);
+
+                int total = channel;
+                for (std::size_t k{}; k < degree; ++k) {
+                    total += msg_weights[get_msg(workspace.msg_c, first_edge + k)];
+                }
+                // ties are broken by the channel
+                out[v] = (total < 0 || (total == 0 && channel < 0));
+                if (degree == 0) {  // no messages to send, the hard decision is the channel sign
+                    continue;
+                }
+
+                // table entry at `s = total - weight of the current edge`, shifted by `S`
+                const auto *lut = vn_msg_luts[degree].data() + max_abs_sum(degree) + total;
+                for (std::size_t k{}; k < degree; ++k) {
+                    const auto msg = lut[-msg_weights[get_msg(workspace.msg_c, first_edge + k)]];
+
+                    set_msg(workspace.msg_v, graph.vn_to_cn_edge[first_edge + k], msg);
+                }
+            }
+        }
+
+        const RateAdaptiveCode<idx_t> &code;
+        const FaidRule rule;
+        const std::array<int, 16> msg_weights;  /// weight (see `FaidRule::levels`) of every packed message
+        std::vector<std::vector<std::int8_t>> vn_luts;  /// lookup table for every variable node degree
+        std::vector<std::vector<std::uint8_t>> vn_msg_luts;  /// same as `vn_luts`, as packed messages
+        mutable std::mutex graphs_mutex;
+        mutable std::map<std::vector<bool>, std::shared_ptr<const FaidGraph>> graphs;  /// by row combinations
+    };
+
+}
+
+#endif //LDPC4QKD_FAID_DECODER_HPP
@@ -0,0 +1,330 @@
+//
+// Created by alice on 18.10.26.
+//
+// Decoding a single frame using several worker threads of a `ThreadPool` (intra-frame parallelism).
+// Used by `DecodingService` for large frames when workers would otherwise be idle (see `ExecutionMode`).
+
+#ifndef LDPC4QKD_INTRA_FRAME_DECODING_HPP
+#define LDPC4QKD_INTRA_FRAME_DECODING_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "rate_adaptive_code.hpp"
+#include "thread_pool.hpp"
+
+
+namespace LDPC4QKD {
+
+    /*!
+     * Positions of the message of every edge in the message buffers of a `DecoderWorkspace`, for one code at one rate.
+     *
+     * The sequential decoder finds these positions by counting while it iterates over all rows (or all columns).
+     * To update an arbitrary range of rows (or columns), they have to be known in advance.
+     *
+     * @tparam idx_t index type of the code
+     */
+    template<typename idx_t>
+    class EdgeSlots {
+    public:
+        explicit EdgeSlots(const RateAdaptiveCode<idx_t> &code) {
+            const auto &pos_varn = code.getPosVarn();
+            const auto &pos_checkn = code.getPosCheckn();
+
+            std::vector<idx_t> mc_position(pos_checkn.size());
+            msg_c_slots.resize(pos_varn.size());
+            for (std::size_t m{}; m < pos_varn.size(); ++m) {
+                for (auto var_node: pos_varn[m]) {
+                    msg_c_slots[m].push_back(mc_position[var_node]++);
+                }
+            }
+
+            std::vector<idx_t> mv_position(pos_varn.size());
+            msg_v_slots.resize(pos_checkn.size());
+            for (std::size_t j{}; j < pos_checkn.size(); ++j) {
+                for (auto check_node: pos_checkn[j]) {
+                    msg_v_slots[j].push_back(mv_position[check_node]++);
+                }
+            }
+        }
+
+        /// `get_msg_c_slots()[m][k]`: index of the message of check node `m` to its `k`-th variable node
+        /// in `msg_c[pos_varn[m][k]]`.
+        [[nodiscard]] const std::vector<std::vector<idx_t>> &get_msg_c_slots() const {
+            return msg_c_slots;
+        }
+
+        /// `get_msg_v_slots()[j][k]`: index of the message of variable node `j` to its `k`-th check node
+        /// in `msg_v[pos_checkn[j][k]]`.
+        [[nodiscard]] const std::vector<std::vector<idx_t>> &get_msg_v_slots() const {
+            return msg_v_slots;
+        }
+
+        [[nodiscard]] std::size_t n_edges() const {
+            std::size_t n{};
+            for (const auto &row: msg_c_slots) {
+                n += row.size();
+            }
+            return n;
+        }
+
+    private:
+        std::vector<std::vector<idx_t>> msg_c_slots;
+        std::vector<std::vector<idx_t>> msg_v_slots;
+    };
+
+
+    /*!
+     * Runs a sequence of parallel loops ("phases") on one owner thread and any number of helper threads.
+     *
+     * The owner calls `run` for every phase and `finish` at the end. Helpers call `help` (e.g. as thread pool tasks),
+     * which processes chunks of the current and all following phases until `finish` is called.
+     * The owner itself processes every chunk not taken by a helper, so it never waits for a helper that has not
+     * started yet. Helper tasks that are queued behind other work therefore cannot cause a deadlock, they only reduce
+     * the speedup.
+     */
+    class CooperativeLoop {
+    public:
+        /// Calls `body(begin, end)` for consecutive chunks of size `chunk_size` covering [0, n), using all threads
+        /// that are currently helping. Returns when all chunks are done.
+        void run(const std::size_t n, const std::size_t chunk_size,
+                 std::function<void(std::size_t, std::size_t)> body) {
+            auto phase = std::make_shared<Phase>();
+            phase->n = n;
+            phase->chunk_size = std::max<std::size_t>(chunk_size, 1);
+            phase->n_chunks = (n + phase->chunk_size - 1) / phase->chunk_size;
+            phase->body = std::move(body);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                current = phase;
+                ++sequence;
+            }
+            changed.notify_all();
+
+            process(*phase);
+            std::unique_lock<std::mutex> lock(mutex);
+            phase_done.wait(lock, [&phase]() {  // the remaining chunks are being processed by helpers
+                return phase->n_chunks_done.load() == phase->n_chunks;
+            });
+        }
+
+        /// Makes all helpers return. Must be called by the owner (also if `run` threw).
+        void finish() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                current.reset();
+                finished = true;
+                ++sequence;
+            }
+            changed.notify_all();
+        }
+
+        /*!
+         * Help with the phases of the owner until `finish` is called. Returns immediately if it was already called.
+         *
+         * @param keep_helping if given, it is called before every phase and the helper returns if it is false
+         *      (e.g. to give the thread to other work). The owner finishes the phases without it.
+         */
+        void help(const std::function<bool()> &keep_helping = {}) {
+            std::uint64_t seen{};
+            while (true) {
+                std::shared_ptr<Phase> phase;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [&]() { return sequence != seen; });
+                    if (finished) {
+                        return;
+                    }
+                    phase = current;
+                    seen = sequence;
+                }
+                if (keep_helping && !keep_helping()) {
+                    return;
+                }
+                if (phase) {
+                    process(*phase);
+                }
+            }
+        }
+
+    private:
+        struct Phase {
+            std::size_t n{};
+            std::size_t chunk_size{};
+            std::size_t n_chunks{};
+            std::function<void(std::size_t, std::size_t)> body;
+            std::atomic<std::size_t> next_chunk{};
+            std::atomic<std::size_t> n_chunks_done{};
+        };
+
+        void process(Phase &phase) {
+            for (auto chunk = phase.next_chunk++; chunk < phase.n_chunks; chunk = phase.next_chunk++) {
+                const auto begin = chunk * phase.chunk_size;
+                phase.body(begin, std::min(begin + phase.chunk_size, phase.n));
+                if (++phase.n_chunks_done == phase.n_chunks) {
+                    std::lock_guard<std::mutex> lock(mutex);  // the owner may be about to wait
+                    phase_done.notify_all();
+                }
+            }
+        }
+
+        std::mutex mutex;  // protects `current`, `finished` and `sequence`
+        std::condition_variable changed;  // notified whenever `sequence` is incremented
+        std::condition_variable phase_done;  // notified when the last chunk of a phase is done
+        std::shared_ptr<Phase> current;
+        bool finished{};
+        std::uint64_t sequence{};  // incremented whenever `current` or `finished` changes
+    };
+
+
+    /*!
+     * Decodes a single frame using the calling thread and up to `n_helpers` additional workers of `pool`.
+     *
+     * Every iteration consists of three parallel phases (check node update by rows, variable node update and
+     * hard decision by columns, syndrome check by rows). The result (including the number of iterations in
+     * `workspace.n_iterations`) is the same as that of `code.decode_at_current_rate`.
+     * Helpers are submitted to `pool` as tasks with the given priority. The frame is decoded even if none of them
+     * starts (e.g. because the calling thread is the only worker of `pool`), just without speedup.
+     * Helpers return to the pool as soon as other tasks are queued, so frames arriving later do not wait
+     * for the end of this frame.
+     *
+     * Decimation and restarts (see `DecoderConfig`) are not supported.
+     *
+     * @param slots edge positions for `code` at its current rate
+     * @param chunks_per_thread each phase is split into this many chunks per thread (load balancing)
+     * @return true if decoding converged
+     */
+    template<typename idx_t, typename Bit>
+    bool decode_intra_frame(const RateAdaptiveCode<idx_t> &code, const EdgeSlots<idx_t> &slots,
+                            const std::vector<double> &llrs, const std::vector<Bit> &syndrome,
+                            std::vector<Bit> &out, const DecoderConfig &config, DecoderWorkspace &workspace,
+                            ThreadPool &pool, const std::size_t n_helpers,
+                            const TaskPriority priority = TaskPriority::normal,
+                            const std::size_t chunks_per_thread = 4) {
+        if (config.decimation_rounds != 0 || config.restarts != 0) {
+            throw std::invalid_argument("decode_intra_frame: decimation and restarts are not supported.");
+        }
+        code.decode_start(llrs, syndrome, workspace);
+
+        const auto &pos_varn = code.getPosVarn();
+        const auto &pos_checkn = code.getPosCheckn();
+        const auto &msg_c_slots = slots.get_msg_c_slots();
+        const auto &msg_v_slots = slots.get_msg_v_slots();
+        if (msg_c_slots.size() != pos_varn.size() || msg_v_slots.size() != pos_checkn.size()) {
+            throw std::invalid_argument("decode_intra_frame: edge slots do not belong to the code at its current rate.");
+        }
+        auto &msg_v = workspace.msg_v;
+        auto &msg_c = workspace.msg_c;
+        const double vsat = config.vsat;
+        auto saturated = [vsat](double v) { return (v > vsat) ? vsat : (v < -vsat) ? -vsat : v; };
+
+        auto loop = std::make_shared<CooperativeLoop>();
+        for (std::size_t i{}; i < n_helpers; ++i) {
+            try {
+                pool.submit([loop, &pool]() {
+                    loop->help([&pool]() { return pool.queue_size() == 0; });
+                }, priority);
+            } catch (const std::runtime_error &) {
+                break;  // the pool is stopping: decode with fewer threads
+            }
+        }
+        struct Finish {
+            CooperativeLoop &loop;
+
+            ~Finish() { loop.finish(); }
+        } finish_guard{*loop};
+
+        const auto n_threads = n_helpers + 1;
+        const auto chunk_size = [n_threads, chunks_per_thread](std::size_t n) {
+            return std::max<std::size_t>(64, n / (n_threads * chunks_per_thread) + 1);
+        };
+        const auto n_rows = pos_varn.size();
+        const auto n_cols = pos_checkn.size();
+
+        std::vector<std::uint8_t> decision(n_cols);  // not `out`, which may be a `std::vector<bool>`
+        auto finish_output = [&]() {
+            out.resize(n_cols);
+            for (std::size_t j{}; j < n_cols; ++j) {
+                out[j] = decision[j];
+            }
+        };
+
+        while (workspace.n_iterations < config.max_num_iter) {
+            const std::size_t it = workspace.n_iterations++;
+            const double damping = (it == 0) ? 0. : config.damping;
+
+            loop->run(n_rows, chunk_size(n_rows), [&](std::size_t begin, std::size_t end) {
+                for (std::size_t m = begin; m < end; ++m) {
+                    auto slot = [&](std::size_t k) -> double & {
+                        return msg_c[pos_varn[m][k]][msg_c_slots[m][k]];
+                    };
+                    const bool syndrome_bit = static_cast<bool>(syndrome[m]);
+                    if (config.check_node_rule == CheckNodeRule::normalized_min_sum) {
+                        code.check_node_update_row_min_sum(m, msg_v[m], syndrome_bit, config.min_sum_normalization,
+                                                           damping, slot);
+                    } else {
+                        code.check_node_update_row(m, msg_v[m], syndrome_bit, damping, slot);
+                    }
+                    for (std::size_t k{}; k < pos_varn[m].size(); ++k) {
+                        slot(k) = saturated(slot(k));
+                    }
+                }
+            });
+
+            std::atomic<bool> diverged{};
+            loop->run(n_cols, chunk_size(n_cols), [&](std::size_t begin, std::size_t end) {
+                bool nan_found = false;
+                for (std::size_t j = begin; j < end; ++j) {
+                    const double mv_sum = std::accumulate(msg_c[j].begin(), msg_c[j].end(), llrs[j]);
+                    decision[j] = (mv_sum < 0);
+                    for (std::size_t k{}; k < pos_checkn[j].size(); ++k) {
+                        const double msg = saturated(mv_sum - msg_c[j][k]);
+                        nan_found = nan_found || std::isnan(msg);
+                        msg_v[pos_checkn[j][k]][msg_v_slots[j][k]] = msg;
+                    }
+                }
+                if (nan_found) {
+                    diverged = true;
+                }
+            });
+
+            std::atomic<bool> unsatisfied{};
+            loop->run(n_rows, chunk_size(n_rows), [&](std::size_t begin, std::size_t end) {
+                for (std::size_t m = begin; m < end && !unsatisfied.load(std::memory_order_relaxed); ++m) {
+                    bool parity = static_cast<bool>(syndrome[m]);
+                    for (auto var_node: pos_varn[m]) {
+                        parity = parity != static_cast<bool>(decision[var_node]);
+                    }
+                    if (parity) {
+                        unsatisfied = true;
+                    }
+                }
+            });
+
+            if (!unsatisfied) {
+                finish_output();
+                return true;
+            }
+            if (diverged) {
+                LDPC4QKD_DEBUG_MESSAGE("Decoder Diverged at iteration " << it);
+                workspace.n_iterations = config.max_num_iter;
+                break;
+            }
+        }
+        finish_output();
+        return false;
+    }
+
+}
+
+#endif //LDPC4QKD_INTRA_FRAME_DECODING_HPP
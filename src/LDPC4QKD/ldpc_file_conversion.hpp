@@ -0,0 +1,841 @@
+//
+// Created by alice on 18.10.26.
+//
+// Reading and writing LDPC matrices in all file formats used by the project, and conversion between them:
+// `.qccsc.json` (quasi-cyclic exponents), `.bincsc.json`, `.cscmat`, `.alist`, a binary container (`.cscbin`)
+// and C++ headers with `constexpr` arrays (as `tests/fortest_autogen_ldpc_matrix_csc.hpp` and `autogen_ldpc_QC.hpp`).
+// This replaces the conversion functions of the Julia package LDPCStorage.jl (see `codes/ldpc_codegen.jl`).
+// Used by the command line tool `ldpc_convert`.
+// Note: this file uses C++20 features!
+
+#ifndef LDPC4QKD_LDPC_FILE_CONVERSION_HPP
+#define LDPC4QKD_LDPC_FILE_CONVERSION_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "external/json-6af826d/json.hpp"
+
+
+namespace LDPC4QKD {
+
+    /*!
+     * Sparse matrix in compressed sparse column (CSC) format, with zero-based indices.
+     *
+     * Either a binary matrix (all stored entries are one, `nzval` is empty), or the matrix of exponents of a
+     * quasi-cyclic (QC) LDPC matrix. In the latter case, `n_rows` and `n_cols` refer to the matrix of exponents and
+     * every stored entry stands for a `qc_expansion_factor` x `qc_expansion_factor` cyclically shifted identity matrix.
+     * See `expand_qc_exponents`.
+     */
+    struct SparseMatrixCSC {
+        std::size_t n_rows{};
+        std::size_t n_cols{};
+        std::vector<std::uint64_t> colptr;  /// size `n_cols + 1`
+        std::vector<std::uint32_t> rowval;  /// row index of every stored entry
+        std::vector<std::uint32_t> nzval;  /// QC exponent of every stored entry (empty for binary matrices)
+        std::size_t qc_expansion_factor{};  /// zero for binary matrices
+
+        [[nodiscard]] bool is_qc() const {
+            return qc_expansion_factor != 0;
+        }
+
+        [[nodiscard]] std::size_t n_stored_entries() const {
+            return rowval.size();
+        }
+
+        /// Throws `std::runtime_error` if the arrays do not describe a valid matrix of the given size.
+        void check_consistency() const {
+            auto fail = [](const std::string &reason) {
+                throw std::runtime_error("Invalid sparse matrix: " + reason);
+            };
+            if (colptr.empty() || colptr.size() - 1 != n_cols || colptr.front() != 0
+                || colptr.back() != rowval.size()) {
+                fail("column pointers do not match the number of columns and stored entries.");
+            }
+            if (!std::is_sorted(colptr.begin(), colptr.end())) {
+                fail("column pointers are not sorted.");
+            }
+            if (std::any_of(rowval.begin(), rowval.end(), [this](auto r) { return r >= n_rows; })) {
+                fail("row index out of range.");
+            }
+            if (is_qc() != !nzval.empty() || (is_qc() && nzval.size() != rowval.size())) {
+                fail("QC exponents do not match the stored entries.");
+            }
+        }
+
+        bool operator==(const SparseMatrixCSC &rhs) const = default;
+    };
+
+
+    /// File formats supported by `read_sparse_matrix` and `write_sparse_matrix`.
+    enum class LdpcFileFormat {
+        qccsc_json,  /// JSON, quasi-cyclic exponents (format `COMPRESSED_SPARSE_COLUMN` of LDPCStorage.jl)
+        bincsc_json,  /// JSON, binary matrix (format `BINCSCJSON` of LDPCStorage.jl)
+        cscmat,  /// text format of older versions of the project (binary matrix)
+        alist,  /// MacKay's alist format (binary matrix, one-based indices)
+        cscbin,  /// binary container (see `write_cscbin`), binary matrix or QC exponents
+        cpp_header  /// C++ header with `constexpr` arrays (write only)
+    };
+
+    namespace HelpersLdpcFileConversion {
+
+        inline bool ends_with(const std::string &s, const std::string &suffix) {
+            return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+        }
+
+        inline std::string read_file_to_string(const std::string &path) {
+            std::ifstream f(path, std::ios::binary);
+            if (!f) {
+                throw std::runtime_error("Failed to open file '" + path + "'.");
+            }
+            std::ostringstream ss;
+            ss << f.rdbuf();
+            return ss.str();
+        }
+
+        /// Parses whitespace separated unsigned integers from `text`, starting at `pos`.
+        class IntegerTokenizer {
+        public:
+            explicit IntegerTokenizer(const std::string &text, std::size_t pos = 0) : text(text), pos(pos) {}
+
+            /// Next integer. Throws if there is none.
+            std::uint64_t next() {
+                skip_whitespace();
+                std::uint64_t value{};
+                const auto [end, ec] = std::from_chars(text.data() + pos, text.data() + text.size(), value);
+                if (ec != std::errc{}) {
+                    throw std::runtime_error("Expected an unsigned integer at position " + std::to_string(pos) + ".");
+                }
+                pos = static_cast<std::size_t>(end - text.data());
+                return value;
+            }
+
+            /// True if the current line contains no further integers. Does not advance past the line break.
+            bool at_end_of_line() {
+                while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r')) {
+                    ++pos;
+                }
+                return pos >= text.size() || text[pos] == '\n';
+            }
+
+            void skip_line() {
+                while (pos < text.size() && text[pos] != '\n') {
+                    ++pos;
+                }
+                ++pos;
+            }
+
+            [[nodiscard]] std::size_t position() const {
+                return pos;
+            }
+
+        private:
+            void skip_whitespace() {
+                while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+                    ++pos;
+                }
+            }
+
+            const std::string &text;
+            std::size_t pos;
+        };
+
+        /// Appends `value` in decimal (or hexadecimal with `0x` prefix) to `out`.
+        inline void append_integer(std::string &out, std::uint64_t value, bool hex = false) {
+            std::array<char, 24> buffer{};
+            if (hex) {
+                out += "0x";
+            }
+            const auto [end, ec] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value, hex ? 16 : 10);
+            out.append(buffer.data(), end);
+        }
+
+        template<typename T>
+        void append_separated(std::string &out, const std::vector<T> &values, const char *separator) {
+            for (std::size_t i{}; i < values.size(); ++i) {
+                if (i != 0) {
+                    out += separator;
+                }
+                append_integer(out, values[i]);
+            }
+        }
+
+        inline void write_string_to_file(const std::string &path, const std::string &content) {
+            std::ofstream f(path, std::ios::binary);
+            if (!f || !f.write(content.data(), static_cast<std::streamsize>(content.size()))) {
+                throw std::runtime_error("Failed to write file '" + path + "'.");
+            }
+        }
+
+        /*!
+         * SAX handler (streaming JSON parser) collecting the fields of `.bincsc.json` and `.qccsc.json` files.
+         * Integer arrays are appended to directly, without building a JSON document in memory.
+         */
+        class CscJsonHandler : public nlohmann::json_sax<nlohmann::json> {
+        public:
+            std::string format;
+            std::vector<std::uint64_t> colptr;
+            std::vector<std::uint64_t> rowval;
+            std::vector<std::uint64_t> nzval;
+            std::uint64_t n_rows{};
+            std::uint64_t n_columns{};
+            std::uint64_t qc_expansion_factor{};
+
+            bool null() override { return true; }
+
+            bool boolean(bool) override { return true; }
+
+            bool number_integer(number_integer_t val) override {
+                if (val < 0) {
+                    throw std::runtime_error("Negative number in JSON file.");
+                }
+                return number_unsigned(static_cast<number_unsigned_t>(val));
+            }
+
+            bool number_unsigned(number_unsigned_t val) override {
+                if (depth == 2 && current_array) {
+                    current_array->push_back(val);
+                } else if (depth == 1) {
+                    if (current_key == "n_rows") {
+                        n_rows = val;
+                    } else if (current_key == "n_columns") {
+                        n_columns = val;
+                    } else if (current_key == "qc_expansion_factor") {
+                        qc_expansion_factor = val;
+                    }
+                }
+                return true;
+            }
+
+            bool number_float(number_float_t, const string_t &) override {
+                if (depth == 2 && current_array) {
+                    throw std::runtime_error("Non-integer entry in array '" + current_key + "'.");
+                }
+                return true;
+            }
+
+            bool string(string_t &val) override {
+                if (depth == 1 && current_key == "format") {
+                    format = val;
+                }
+                return true;
+            }
+
+            bool binary(binary_t &) override { return true; }
+
+            bool start_object(std::size_t) override {
+                ++depth;
+                return true;
+            }
+
+            bool key(string_t &val) override {
+                if (depth == 1) {
+                    current_key = val;
+                }
+                return true;
+            }
+
+            bool end_object() override {
+                --depth;
+                return true;
+            }
+
+            bool start_array(std::size_t) override {
+                ++depth;
+                if (depth == 2) {
+                    current_array = (current_key == "colptr") ? &colptr
+                                    : (current_key == "rowval") ? &rowval
+                                    : (current_key == "nzval") ? &nzval : nullptr;
+                }
+                return true;
+            }
+
+            bool end_array() override {
+                if (depth == 2) {
+                    current_array = nullptr;
+                }
+                --depth;
+                return true;
+            }
+
+            bool parse_error(std::size_t position, const std::string &, const nlohmann::detail::exception &ex) override {
+                throw std::runtime_error("JSON parse error at position " + std::to_string(position) + ": " + ex.what());
+            }
+
+        private:
+            int depth{};
+            std::string current_key;  // last key at the top level of the document
+            std::vector<std::uint64_t> *current_array{};
+        };
+
+        template<typename T>
+        std::vector<T> narrow(const std::vector<std::uint64_t> &in, const char *name) {
+            std::vector<T> out(in.size());
+            for (std::size_t i{}; i < in.size(); ++i) {
+                if (in[i] > std::numeric_limits<T>::max()) {
+                    throw std::runtime_error(std::string("Entry of '") + name + "' does not fit into 32 bits.");
+                }
+                out[i] = static_cast<T>(in[i]);
+            }
+            return out;
+        }
+
+        constexpr std::array<char, 8> cscbin_magic{'L', 'D', 'P', 'C', 'C', 'S', 'C', 'B'};
+        constexpr std::uint32_t cscbin_version = 1;
+
+    }
+
+
+    /// File format from the file name (e.g. `code.qccsc.json`, `code.alist`). Throws if the extension is unknown.
+    inline LdpcFileFormat ldpc_file_format_from_path(const std::string &path) {
+        using HelpersLdpcFileConversion::ends_with;
+        if (ends_with(path, ".qccsc.json")) {
+            return LdpcFileFormat::qccsc_json;
+        } else if (ends_with(path, ".bincsc.json")) {
+            return LdpcFileFormat::bincsc_json;
+        } else if (ends_with(path, ".cscmat")) {
+            return LdpcFileFormat::cscmat;
+        } else if (ends_with(path, ".alist")) {
+            return LdpcFileFormat::alist;
+        } else if (ends_with(path, ".cscbin")) {
+            return LdpcFileFormat::cscbin;
+        } else if (ends_with(path, ".hpp") || ends_with(path, ".h")) {
+            return LdpcFileFormat::cpp_header;
+        }
+        throw std::runtime_error("Unknown LDPC file format of '" + path + "'. Expected extension .qccsc.json, "
+                                 ".bincsc.json, .cscmat, .alist, .cscbin or .hpp.");
+    }
+
+
+    /*!
+     * Expands a matrix of quasi-cyclic exponents into the binary LDPC matrix.
+     * The entry with exponent `s` in row `r` and column `c` of the exponent matrix gives ones at the positions
+     * (`Z * r + (j - s) mod Z`, `Z * c + j`) for `j = 0, ..., Z - 1` (same convention as `FixedSizeEncoderQC`).
+     * Blocks of columns are expanded in parallel.
+     *
+     * @param qc matrix of exponents (see `SparseMatrixCSC`)
+     * @param n_threads number of threads. Zero means one thread per hardware thread.
+     * @return binary matrix with row indices sorted within every column
+     */
+    inline SparseMatrixCSC expand_qc_exponents(const SparseMatrixCSC &qc, std::size_t n_threads = 0) {
+        if (!qc.is_qc()) {
+            throw std::invalid_argument("expand_qc_exponents: the matrix does not store QC exponents.");
+        }
+        qc.check_consistency();
+        const std::uint64_t Z = qc.qc_expansion_factor;
+        if ((qc.n_rows * Z) > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::runtime_error("expand_qc_exponents: expanded matrix has too many rows for 32 bit indices.");
+        }
+
+        SparseMatrixCSC out{};
+        out.n_rows = qc.n_rows * Z;
+        out.n_cols = qc.n_cols * Z;
+        out.colptr.resize(out.n_cols + 1);
+        out.rowval.resize(qc.n_stored_entries() * Z);
+
+        // every expanded column of block column `c` has the same number of entries as column `c` of `qc`.
+        for (std::size_t c{}; c < qc.n_cols; ++c) {
+            const auto degree = qc.colptr[c + 1] - qc.colptr[c];
+            for (std::size_t j{}; j < Z; ++j) {
+                out.colptr[c * Z + j + 1] = out.colptr[c * Z + j] + degree;
+            }
+        }
+
+        auto expand_block_columns = [&qc, &out, Z](std::size_t begin, std::size_t end) {
+            std::vector<std::pair<std::uint32_t, std::uint32_t>> entries;  // (block row, exponent)
+            for (std::size_t c = begin; c < end; ++c) {
+                entries.clear();
+                for (auto k = qc.colptr[c]; k < qc.colptr[c + 1]; ++k) {
+                    entries.emplace_back(qc.rowval[k], qc.nzval[k]);
+                }
+                std::sort(entries.begin(), entries.end());  // blocks of rows are disjoint, so rows end up sorted
+                for (std::size_t j{}; j < Z; ++j) {
+                    auto pos = out.colptr[c * Z + j];
+                    for (auto [block_row, exponent]: entries) {
+                        const auto shift = (j + Z - exponent % Z) % Z;
+                        out.rowval[pos++] = static_cast<std::uint32_t>(block_row * Z + shift);
+                    }
+                }
+            }
+        };
+
+        if (n_threads == 0) {
+            n_threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        n_threads = std::max<std::size_t>(1, std::min(n_threads, qc.n_cols));
+        std::vector<std::thread> threads;
+        for (std::size_t t{}; t < n_threads; ++t) {
+            threads.emplace_back(expand_block_columns, qc.n_cols * t / n_threads, qc.n_cols * (t + 1) / n_threads);
+        }
+        for (auto &t: threads) {
+            t.join();
+        }
+        return out;
+    }
+
+    /// Binary matrix. Expands QC exponents if necessary (see `expand_qc_exponents`).
+    inline SparseMatrixCSC to_binary_matrix(const SparseMatrixCSC &matrix, std::size_t n_threads = 0) {
+        return matrix.is_qc() ? expand_qc_exponents(matrix, n_threads) : matrix;
+    }
+
+
+    // ------------------------------------------------------------------------------------------------------- reading
+
+    /// Reads a `.qccsc.json` or `.bincsc.json` file (format given by the `format` field), using a streaming parser.
+    inline SparseMatrixCSC read_csc_json(const std::string &path) {
+        using namespace HelpersLdpcFileConversion;
+        std::ifstream f(path);
+        if (!f) {
+            throw std::runtime_error("Failed to open file '" + path + "'.");
+        }
+        CscJsonHandler handler;
+        nlohmann::json::sax_parse(f, &handler);
+
+        SparseMatrixCSC m{};
+        m.n_rows = handler.n_rows;
+        m.n_cols = handler.n_columns;
+        m.colptr = std::move(handler.colptr);
+        m.rowval = narrow<std::uint32_t>(handler.rowval, "rowval");
+        if (handler.format == "COMPRESSED_SPARSE_COLUMN") {
+            if (handler.qc_expansion_factor == 0) {
+                throw std::runtime_error("File '" + path + "' stores QC exponents but no `qc_expansion_factor`.");
+            }
+            m.qc_expansion_factor = handler.qc_expansion_factor;
+            m.nzval = narrow<std::uint32_t>(handler.nzval, "nzval");
+        } else if (handler.format != "BINCSCJSON") {
+            throw std::runtime_error("Unexpected format '" + handler.format + "' in file '" + path + "'.");
+        }
+        m.check_consistency();
+        return m;
+    }
+
+    /// Reads a `.cscmat` file (binary matrix). Lines starting with `#` at the beginning of the file are ignored.
+    inline SparseMatrixCSC read_cscmat(const std::string &path) {
+        using namespace HelpersLdpcFileConversion;
+        const auto text = read_file_to_string(path);
+        IntegerTokenizer tokens(text);
+        while (tokens.position() < text.size() && text[tokens.position()] == '#') {
+            tokens.skip_line();
+        }
+
+        SparseMatrixCSC m{};
+        m.n_rows = tokens.next();
+        m.n_cols = tokens.next();
+        const auto n_stored = tokens.next();
+        if (m.n_cols >= text.size() || n_stored > text.size()) {  // every number takes at least two characters
+            throw std::runtime_error("cscmat: sizes in the header of '" + path + "' exceed the file size.");
+        }
+        m.colptr.resize(m.n_cols + 1);
+        for (auto &c: m.colptr) {
+            c = tokens.next();
+        }
+        std::vector<std::uint64_t> rowval(n_stored);
+        for (auto &r: rowval) {
+            r = tokens.next();
+        }
+        m.rowval = narrow<std::uint32_t>(rowval, "rowval");
+        m.check_consistency();
+        return m;
+    }
+
+    /// Reads an `.alist` file (binary matrix). Zero padding of the index lists is accepted.
+    inline SparseMatrixCSC read_alist(const std::string &path) {
+        using namespace HelpersLdpcFileConversion;
+        const auto text = read_file_to_string(path);
+        IntegerTokenizer tokens(text);
+
+        SparseMatrixCSC m{};
+        m.n_cols = tokens.next();
+        m.n_rows = tokens.next();
+        tokens.next();  // maximum column weight
+        tokens.next();  // maximum row weight
+        if (m.n_cols >= text.size() || m.n_rows >= text.size()) {  // every number takes at least two characters
+            throw std::runtime_error("alist: sizes in the header of '" + path + "' exceed the file size.");
+        }
+        std::vector<std::uint64_t> col_weights(m.n_cols);
+        for (auto &w: col_weights) {
+            w = tokens.next();
+        }
+        for (std::size_t i{}; i < m.n_rows; ++i) {
+            tokens.next();  // row weights (redundant)
+        }
+        tokens.skip_line();
+
+        m.colptr.assign(1, 0);
+        for (std::size_t c{}; c < m.n_cols; ++c) {
+            std::size_t n_read{};
+            while (!tokens.at_end_of_line()) {
+                const auto idx = tokens.next();
+                if (idx != 0) {  // zero is padding
+                    m.rowval.push_back(static_cast<std::uint32_t>(idx - 1));
+                    ++n_read;
+                }
+            }
+            tokens.skip_line();
+            if (n_read != col_weights[c]) {
+                throw std::runtime_error("alist: column " + std::to_string(c) + " does not match its weight.");
+            }
+            std::sort(m.rowval.end() - static_cast<std::ptrdiff_t>(n_read), m.rowval.end());
+            m.colptr.push_back(m.rowval.size());
+        }
+        // the remaining lines (indices of every row) are redundant.
+        m.check_consistency();
+        return m;
+    }
+
+    /// Reads a binary container written by `write_cscbin`.
+    inline SparseMatrixCSC read_cscbin(const std::string &path) {
+        using namespace HelpersLdpcFileConversion;
+        static_assert(std::endian::native == std::endian::little, "cscbin files are little endian.");
+        std::ifstream f(path, std::ios::binary);
+        if (!f) {
+            throw std::runtime_error("Failed to open file '" + path + "'.");
+        }
+        auto read = [&f, &path](void *dst, std::size_t n_bytes) {
+            if (!f.read(static_cast<char *>(dst), static_cast<std::streamsize>(n_bytes))) {
+                throw std::runtime_error("Unexpected end of file '" + path + "'.");
+            }
+        };
+
+        std::array<char, 8> magic{};
+        std::uint32_t version{};
+        std::uint32_t flags{};
+        std::array<std::uint64_t, 4> sizes{};  // n_rows, n_cols, n_stored_entries, qc_expansion_factor
+        read(magic.data(), magic.size());
+        read(&version, sizeof(version));
+        read(&flags, sizeof(flags));
+        read(sizes.data(), sizeof(sizes));
+        if (magic != cscbin_magic || version != cscbin_version) {
+            throw std::runtime_error("File '" + path + "' is not a cscbin file (version "
+                                     + std::to_string(cscbin_version) + ").");
+        }
+
+        // check the sizes before allocating: the arrays follow the header
+        const auto header_end = f.tellg();
+        f.seekg(0, std::ios::end);
+        const auto n_bytes_left = static_cast<std::uint64_t>(f.tellg() - header_end);
+        f.seekg(header_end);
+        const std::uint64_t n_index_arrays = (sizes[3] != 0) ? 2 : 1;  // row indices (and QC exponents)
+        if (sizes[1] >= n_bytes_left / sizeof(std::uint64_t)
+            || sizes[2] > (n_bytes_left - (sizes[1] + 1) * sizeof(std::uint64_t))
+                          / (n_index_arrays * sizeof(std::uint32_t))) {
+            throw std::runtime_error("cscbin: sizes in the header of '" + path + "' exceed the file size.");
+        }
+
+        SparseMatrixCSC m{};
+        m.n_rows = sizes[0];
+        m.n_cols = sizes[1];
+        m.qc_expansion_factor = sizes[3];
+        m.colptr.resize(m.n_cols + 1);
+        m.rowval.resize(sizes[2]);
+        read(m.colptr.data(), m.colptr.size() * sizeof(std::uint64_t));
+        read(m.rowval.data(), m.rowval.size() * sizeof(std::uint32_t));
+        if (m.is_qc()) {
+            m.nzval.resize(sizes[2]);
+            read(m.nzval.data(), m.nzval.size() * sizeof(std::uint32_t));
+        }
+        m.check_consistency();
+        return m;
+    }
+
+    /// Reads a matrix from any supported file format (except C++ headers), chosen by the file extension.
+    inline SparseMatrixCSC read_sparse_matrix(const std::string &path) {
+        switch (ldpc_file_format_from_path(path)) {
+            case LdpcFileFormat::qccsc_json:
+            case LdpcFileFormat::bincsc_json:
+                return read_csc_json(path);
+            case LdpcFileFormat::cscmat:
+                return read_cscmat(path);
+            case LdpcFileFormat::alist:
+                return read_alist(path);
+            case LdpcFileFormat::cscbin:
+                return read_cscbin(path);
+            case LdpcFileFormat::cpp_header:
+                break;
+        }
+        throw std::runtime_error("Reading C++ headers is not supported ('" + path + "'). Include them instead.");
+    }
+
+
+    // ------------------------------------------------------------------------------------------------------- writing
+
+    /// Writes a `.qccsc.json` (QC exponents) or `.bincsc.json` (binary matrix) file, depending on the matrix.
+    inline void write_csc_json(const std::string &path, const SparseMatrixCSC &m) {
+        using namespace HelpersLdpcFileConversion;
+        m.check_consistency();
+        std::string out;
+        out.reserve(16 * (m.colptr.size() + 2 * m.rowval.size()));
+        out += R"({"format":")";
+        out += m.is_qc() ? "COMPRESSED_SPARSE_COLUMN" : "BINCSCJSON";
+        out += R"(","CSCJSON_FORMAT_VERSION":"0.3.2","n_rows":)";
+        append_integer(out, m.n_rows);
+        out += R"(,"n_columns":)";
+        append_integer(out, m.n_cols);
+        out += R"(,"n_stored_entries":)";
+        append_integer(out, m.n_stored_entries());
+        if (m.is_qc()) {
+            out += R"(,"qc_expansion_factor":)";
+            append_integer(out, m.qc_expansion_factor);
+        }
+        out += R"(,"colptr":[)";
+        append_separated(out, m.colptr, ",");
+        out += R"(],"rowval":[)";
+        append_separated(out, m.rowval, ",");
+        if (m.is_qc()) {
+            out += R"(],"nzval":[)";
+            append_separated(out, m.nzval, ",");
+        }
+        out += "]}\n";
+        write_string_to_file(path, out);
+    }
+
+    /// Writes a `.cscmat` file. Requires a binary matrix.
+    inline void write_cscmat(const std::string &path, const SparseMatrixCSC &m) {
+        using namespace HelpersLdpcFileConversion;
+        if (m.is_qc()) {
+            throw std::invalid_argument("write_cscmat: expand the QC exponents first (see `to_binary_matrix`).");
+        }
+        m.check_consistency();
+        std::string out = "# 0.0.2\n"
+                          "# Compressed sparse column storage of matrix (arrays `colptr`, `rowval`, `stored_values` "
+                          "as space separated decimal integers. Stored entries may be zero.).\n"
+                          "#\n"
+                          "# n_rows n_columns n_stored_entries\n";
+        append_integer(out, m.n_rows);
+        out += ' ';
+        append_integer(out, m.n_cols);
+        out += ' ';
+        append_integer(out, m.n_stored_entries());
+        out += "\n\n";
+        append_separated(out, m.colptr, " ");
+        out += "\n\n";
+        append_separated(out, m.rowval, " ");
+        out += "\n\n";
+        write_string_to_file(path, out);
+    }
+
+    /// Writes an `.alist` file (without zero padding, byte-identical to LDPCStorage.jl). Requires a binary matrix.
+    inline void write_alist(const std::string &path, const SparseMatrixCSC &m) {
+        using namespace HelpersLdpcFileConversion;
+        if (m.is_qc()) {
+            throw std::invalid_argument("write_alist: expand the QC exponents first (see `to_binary_matrix`).");
+        }
+        m.check_consistency();
+
+        // row-wise storage (transpose), column indices sorted within every row.
+        std::vector<std::uint64_t> rowptr(m.n_rows + 1);
+        for (auto r: m.rowval) {
+            rowptr[r + 1]++;
+        }
+        for (std::size_t r{}; r < m.n_rows; ++r) {
+            rowptr[r + 1] += rowptr[r];
+        }
+        std::vector<std::uint32_t> colval(m.n_stored_entries());
+        std::vector<std::uint64_t> fill(rowptr.begin(), rowptr.end() - 1);
+        for (std::size_t c{}; c < m.n_cols; ++c) {
+            for (auto k = m.colptr[c]; k < m.colptr[c + 1]; ++k) {
+                colval[fill[m.rowval[k]]++] = static_cast<std::uint32_t>(c);
+            }
+        }
+
+        std::uint64_t max_col_weight{};
+        std::uint64_t max_row_weight{};
+        for (std::size_t c{}; c < m.n_cols; ++c) {
+            max_col_weight = std::max(max_col_weight, m.colptr[c + 1] - m.colptr[c]);
+        }
+        for (std::size_t r{}; r < m.n_rows; ++r) {
+            max_row_weight = std::max(max_row_weight, rowptr[r + 1] - rowptr[r]);
+        }
+
+        std::string out;
+        out.reserve(16 * m.n_stored_entries());
+        append_integer(out, m.n_cols);
+        out += ' ';
+        append_integer(out, m.n_rows);
+        out += '\n';
+        append_integer(out, max_col_weight);
+        out += ' ';
+        append_integer(out, max_row_weight);
+        out += '\n';
+        auto append_line = [&out](auto begin, auto end, auto value) {
+            for (auto k = begin; k < end; ++k) {
+                if (k != begin) {
+                    out += ' ';
+                }
+                append_integer(out, value(k));
+            }
+            out += '\n';
+        };
+        append_line(std::size_t{}, m.n_cols, [&m](std::size_t c) { return m.colptr[c + 1] - m.colptr[c]; });
+        append_line(std::size_t{}, m.n_rows, [&rowptr](std::size_t r) { return rowptr[r + 1] - rowptr[r]; });
+        for (std::size_t c{}; c < m.n_cols; ++c) {
+            append_line(m.colptr[c], m.colptr[c + 1], [&m](std::uint64_t k) { return m.rowval[k] + 1u; });
+        }
+        for (std::size_t r{}; r < m.n_rows; ++r) {
+            append_line(rowptr[r], rowptr[r + 1], [&colval](std::uint64_t k) { return colval[k] + 1u; });
+        }
+        write_string_to_file(path, out);
+    }
+
+    /*!
+     * Writes the binary container format `.cscbin` (little endian):
+     * 8 byte magic `LDPCCSCB`, uint32 version, uint32 flags (reserved, zero),
+     * uint64 `n_rows`, `n_cols`, `n_stored_entries`, `qc_expansion_factor` (zero for binary matrices),
+     * followed by the arrays `colptr` (uint64), `rowval` (uint32) and, for QC exponents only, `nzval` (uint32).
+     * Reading and writing are plain memory copies, which makes this the fastest format for large codes.
+     */
+    inline void write_cscbin(const std::string &path, const SparseMatrixCSC &m) {
+        using namespace HelpersLdpcFileConversion;
+        static_assert(std::endian::native == std::endian::little, "cscbin files are little endian.");
+        m.check_consistency();
+        std::ofstream f(path, std::ios::binary);
+        auto write = [&f](const void *src, std::size_t n_bytes) {
+            f.write(static_cast<const char *>(src), static_cast<std::streamsize>(n_bytes));
+        };
+        const std::uint32_t flags{};
+        const std::array<std::uint64_t, 4> sizes{m.n_rows, m.n_cols, m.n_stored_entries(), m.qc_expansion_factor};
+        write(cscbin_magic.data(), cscbin_magic.size());
+        write(&cscbin_version, sizeof(cscbin_version));
+        write(&flags, sizeof(flags));
+        write(sizes.data(), sizeof(sizes));
+        write(m.colptr.data(), m.colptr.size() * sizeof(std::uint64_t));
+        write(m.rowval.data(), m.rowval.size() * sizeof(std::uint32_t));
+        if (m.is_qc()) {
+            write(m.nzval.data(), m.nzval.size() * sizeof(std::uint32_t));
+        }
+        if (!f) {
+            throw std::runtime_error("Failed to write file '" + path + "'.");
+        }
+    }
+
+    /*!
+     * Writes a C++ header containing the matrix as `constexpr std::array`s inside namespace `namespace_name`.
+     * Binary matrices give the arrays `colptr` and `row_idx` (as `tests/fortest_autogen_ldpc_matrix_csc.hpp`),
+     * QC exponents additionally give `values` and `expansion_factor` (as the namespaces in `autogen_ldpc_QC.hpp`,
+     * usable with `helper_create_FixedSizeEncoderQC`). The smallest unsigned integer types that fit are used.
+     */
+    inline void write_cpp_header(const std::string &path, const SparseMatrixCSC &m, const std::string &namespace_name) {
+        using namespace HelpersLdpcFileConversion;
+        m.check_consistency();
+
+        auto type_name = [](std::uint64_t max_value) {
+            return (max_value <= 0xff) ? "std::uint8_t" : (max_value <= 0xffff) ? "std::uint16_t"
+                                                      : (max_value <= 0xffffffff) ? "std::uint32_t" : "std::uint64_t";
+        };
+        auto append_array = [&type_name](std::string &out, const auto &values, const char *size, const char *name,
+                                         bool hex) {
+            std::uint64_t max_value{};
+            for (auto v: values) {
+                max_value = std::max<std::uint64_t>(max_value, v);
+            }
+            out += "    constexpr inline std::array<";
+            out += type_name(max_value);
+            out += ", ";
+            out += size;
+            out += "> ";
+            out += name;
+            out += " = {\n";
+            constexpr std::size_t per_line = 64;
+            for (std::size_t i{}; i < values.size(); ++i) {
+                if (i % per_line == 0) {
+                    out += "            ";
+                }
+                append_integer(out, values[i], hex);
+                out += ',';
+                if (i % per_line == per_line - 1 || i + 1 == values.size()) {
+                    out += '\n';
+                }
+            }
+            out += "    };\n";
+        };
+        auto append_constant = [](std::string &out, const char *name, std::uint64_t value) {
+            out += "    constexpr inline std::size_t ";
+            out += name;
+            out += " = ";
+            append_integer(out, value);
+            out += ";\n";
+        };
+
+        std::string guard = "LDPC4QKD_" + namespace_name + "_HPP";
+        std::transform(guard.begin(), guard.end(), guard.begin(), [](unsigned char c) {
+            return std::isalnum(c) ? static_cast<char>(std::toupper(c)) : '_';
+        });
+
+        std::string out;
+        out.reserve(8 * (m.colptr.size() + 2 * m.rowval.size()));
+        out += "// This is an automatically generated file (by `ldpc_convert`).\n";
+        out += m.is_qc() ? "// The quasi-cyclic exponents of an LDPC matrix are saved in compressed sparse column (CSC) format.\n"
+                         : "// A sparse LDPC matrix (containing only zeros and ones) is saved in compressed sparse column (CSC) format.\n";
+        out += "// Since the matrix (and LDPC code) is known at compile time, there is no need to save it separately in a file.\n\n";
+        out += "#ifndef " + guard + "\n#define " + guard + "\n\n#include <cstdint>\n#include <array>\n\n\n";
+        out += "namespace " + namespace_name + " {\n\n";
+        append_constant(out, "M", m.n_rows);
+        append_constant(out, "N", m.n_cols);
+        append_constant(out, "num_nz", m.n_stored_entries());
+        if (m.is_qc()) {
+            append_constant(out, "expansion_factor", m.qc_expansion_factor);
+        }
+        out += '\n';
+        append_array(out, m.colptr, "N + 1", "colptr", true);
+        out += "\n// -------------------------------------------------------\n\n";
+        append_array(out, m.rowval, "num_nz", "row_idx", true);
+        if (m.is_qc()) {
+            out += "\n// -------------------------------------------------------\n\n";
+            append_array(out, m.nzval, "num_nz", "values", false);
+        }
+        out += "\n} // namespace " + namespace_name + "\n\n#endif // " + guard + "\n";
+        write_string_to_file(path, out);
+    }
+
+    /*!
+     * Writes the matrix in the format given by the file extension (see `ldpc_file_format_from_path`).
+     * QC exponents are expanded (in parallel) for formats that can only store binary matrices.
+     *
+     * @param path output file path
+     * @param m matrix to write
+     * @param header_namespace namespace used for C++ headers
+     * @param n_threads number of threads used for QC expansion. Zero means one thread per hardware thread.
+     */
+    inline void write_sparse_matrix(const std::string &path, const SparseMatrixCSC &m,
+                                    const std::string &header_namespace = "AutogenLDPC",
+                                    std::size_t n_threads = 0) {
+        switch (ldpc_file_format_from_path(path)) {
+            case LdpcFileFormat::qccsc_json:
+                if (!m.is_qc()) {
+                    throw std::invalid_argument("Cannot write a binary matrix as QC exponents ('" + path + "').");
+                }
+                write_csc_json(path, m);
+                break;
+            case LdpcFileFormat::bincsc_json:
+                write_csc_json(path, to_binary_matrix(m, n_threads));
+                break;
+            case LdpcFileFormat::cscmat:
+                write_cscmat(path, to_binary_matrix(m, n_threads));
+                break;
+            case LdpcFileFormat::alist:
+                write_alist(path, to_binary_matrix(m, n_threads));
+                break;
+            case LdpcFileFormat::cscbin:
+                write_cscbin(path, m);
+                break;
+            case LdpcFileFormat::cpp_header:
+                write_cpp_header(path, m, header_namespace);
+                break;
+        }
+    }
+
+}
+
+#endif //LDPC4QKD_LDPC_FILE_CONVERSION_HPP
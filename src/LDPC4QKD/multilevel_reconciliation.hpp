@@ -0,0 +1,439 @@
+//
+// Created by alice on 18.10.26.
+//
+// Multilevel coding with multistage decoding for continuous-variable QKD.
+// Every Gaussian sample is quantized into several bits (one per level). Each level is reconciled with its own binary
+// LDPC code and rate (a `RateAdaptiveCode` from a `CodeRegistry`), and the LLRs of a level are conditioned on the
+// levels decoded before it.
+
+#ifndef LDPC4QKD_MULTILEVEL_RECONCILIATION_HPP
+#define LDPC4QKD_MULTILEVEL_RECONCILIATION_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "rate_adaptive_code.hpp"
+#include "code_registry.hpp"
+#include "decoding_service.hpp"
+#include "thread_pool.hpp"
+
+
+namespace LDPC4QKD {
+
+    /*!
+     * Quantizes real numbers into `2^n_levels` slices (intervals), labeled by the binary representation of the
+     * slice index. Level `l` is bit `l` of the index, i.e., level 0 is the least significant bit.
+     */
+    class SliceQuantizer {
+    public:
+        /*!
+         * @param boundaries increasing interval boundaries. The number of slices is `boundaries.size() + 1`,
+         *      which must be a power of two.
+         */
+        explicit SliceQuantizer(std::vector<double> boundaries) : boundaries(std::move(boundaries)) {
+            const auto n_slices = this->boundaries.size() + 1;
+            if ((n_slices & (n_slices - 1)) != 0 || n_slices < 2) {
+                throw std::invalid_argument("SliceQuantizer: number of slices must be a power of two (at least 2).");
+            }
+            if (!std::is_sorted(this->boundaries.begin(), this->boundaries.end())) {
+                throw std::invalid_argument("SliceQuantizer: boundaries must be increasing.");
+            }
+            while ((std::size_t{1} << n_levels) < n_slices) {
+                n_levels++;
+            }
+        }
+
+        /// Slices of equal probability for a zero mean Gaussian with standard deviation `sigma`.
+        static SliceQuantizer equiprobable(std::size_t n_levels, double sigma) {
+            const std::size_t n_slices = std::size_t{1} << n_levels;
+            std::vector<double> boundaries(n_slices - 1);
+            for (std::size_t i{}; i < boundaries.size(); ++i) {
+                boundaries[i] = sigma * inverse_std_normal_cdf(static_cast<double>(i + 1) / static_cast<double>(n_slices));
+            }
+            return SliceQuantizer(boundaries);
+        }
+
+        [[nodiscard]] std::size_t get_n_levels() const {
+            return n_levels;
+        }
+
+        [[nodiscard]] std::size_t get_n_slices() const {
+            return boundaries.size() + 1;
+        }
+
+        [[nodiscard]] const std::vector<double> &get_boundaries() const {
+            return boundaries;
+        }
+
+        [[nodiscard]] std::size_t slice_index(double x) const {
+            return static_cast<std::size_t>(std::upper_bound(boundaries.begin(), boundaries.end(), x) - boundaries.begin());
+        }
+
+        /// Lower boundary of slice `idx` (minus infinity for the first slice).
+        [[nodiscard]] double lower(std::size_t idx) const {
+            return idx == 0 ? -std::numeric_limits<double>::infinity() : boundaries[idx - 1];
+        }
+
+        /// Upper boundary of slice `idx` (infinity for the last slice).
+        [[nodiscard]] double upper(std::size_t idx) const {
+            return idx == boundaries.size() ? std::numeric_limits<double>::infinity() : boundaries[idx];
+        }
+
+        /// Bits of level `level` of all samples.
+        template<typename Bit>
+        void quantize_level(const std::vector<double> &samples, std::size_t level, std::vector<Bit> &out) const {
+            out.resize(samples.size());
+            for (std::size_t i{}; i < samples.size(); ++i) {
+                out[i] = static_cast<Bit>((slice_index(samples[i]) >> level) & 1u);
+            }
+        }
+
+        static double std_normal_cdf(double x) {
+            return 0.5 * std::erfc(-x / std::sqrt(2.));
+        }
+
+    private:
+        /// by bisection (only used to set up the quantizer)
+        static double inverse_std_normal_cdf(double p) {
+            double lo = -40.;
+            double hi = 40.;
+            for (int i{}; i < 200; ++i) {
+                const double mid = 0.5 * (lo + hi);
+                (std_normal_cdf(mid) < p ? lo : hi) = mid;
+            }
+            return 0.5 * (lo + hi);
+        }
+
+        std::vector<double> boundaries;
+        std::size_t n_levels{};
+    };
+
+
+    /*!
+     * Correlated Gaussian variables of the two parties: `y = x + n`, where `x ~ N(0, sigma_x^2)` is the quantized
+     * variable (e.g. Bob's measurement in reverse reconciliation) and `n ~ N(0, sigma_n^2)` is independent noise.
+     */
+    struct GaussianChannel {
+        double sigma_x{1.};
+        double sigma_n{1.};
+
+        /// Mean of `x` given `y`.
+        [[nodiscard]] double posterior_mean(double y) const {
+            return y * sigma_x * sigma_x / (sigma_x * sigma_x + sigma_n * sigma_n);
+        }
+
+        /// Standard deviation of `x` given `y`.
+        [[nodiscard]] double posterior_sigma() const {
+            return sigma_x * sigma_n / std::sqrt(sigma_x * sigma_x + sigma_n * sigma_n);
+        }
+    };
+
+
+    /*!
+     * Log likelihood ratio of level `level` for one sample, given the side information `y` and the bits of all
+     * lower levels (`lower_bits`, bit `l` is the decoded bit of level `l`).
+     */
+    inline double multilevel_llr(const SliceQuantizer &quantizer, const GaussianChannel &channel, double y,
+                                 std::size_t level, std::size_t lower_bits) {
+        const double mean = channel.posterior_mean(y);
+        const double sigma = channel.posterior_sigma();
+        auto tail = [mean, sigma](double t) {  // P(x > t | y), accurate far into the tails
+            return 0.5 * std::erfc((t - mean) / (sigma * std::sqrt(2.)));
+        };
+
+        // slices consistent with the lower bits are `lower_bits + k * 2^level`; bit `level` is `k & 1`.
+        const std::size_t step = std::size_t{1} << level;
+        const std::size_t low = lower_bits & (step - 1);
+        double p[2]{};
+        for (std::size_t idx = low, k = 0; idx < quantizer.get_n_slices(); idx += step, ++k) {
+            p[k & 1] += std::max(tail(quantizer.lower(idx)) - tail(quantizer.upper(idx)), 0.);
+        }
+        constexpr double tiny = std::numeric_limits<double>::min();
+        return std::log(std::max(p[0], tiny)) - std::log(std::max(p[1], tiny));
+    }
+
+    /*!
+     * Estimates the conditional entropy H(B_l | Y, B_0, ..., B_{l-1}) (in bits per sample) of every level from
+     * samples `x` of the quantized variable and side information `y`.
+     * The syndrome size of level `l` must be at least `H_l * N` (times an efficiency factor > 1 in practice).
+     */
+    inline std::vector<double> estimate_level_entropies(const SliceQuantizer &quantizer, const GaussianChannel &channel,
+                                                        const std::vector<double> &x, const std::vector<double> &y) {
+        if (x.size() != y.size() || x.empty()) {
+            throw std::invalid_argument("estimate_level_entropies: expected equally many (nonzero) samples x and y.");
+        }
+        std::vector<double> entropies(quantizer.get_n_levels());
+        for (std::size_t level{}; level < entropies.size(); ++level) {
+            double sum{};
+            for (std::size_t i{}; i < x.size(); ++i) {
+                const double llr = multilevel_llr(quantizer, channel, y[i], level, quantizer.slice_index(x[i]));
+                // H = log2(1 + e^{-|llr|}) + |llr| e^{-|llr|} / ((1 + e^{-|llr|}) ln 2)
+                const double a = std::abs(llr);
+                const double e = std::exp(-a);
+                sum += std::log2(1 + e) + a * e / ((1 + e) * std::log(2.));
+            }
+            entropies[level] = sum / static_cast<double>(x.size());
+        }
+        return entropies;
+    }
+
+
+    /// Code and rate used for one level. See `MultilevelReconciliation`.
+    struct LevelSpec {
+        std::size_t code_id{};  /// id in the `CodeRegistry`
+        std::size_t syndrome_size{};  /// determines the rate (see `RateAdaptiveCode::encode_with_ra`)
+    };
+
+    /*!
+     * Chooses the code and rate of every level from the conditional entropies of the levels
+     * (see `estimate_level_entropies`). The target syndrome size of level `l` is `ceil(efficiency * H_l * frame_size)`.
+     *
+     * Among the candidate codes with `frame_size` columns, a level uses the first one whose range of syndrome sizes
+     * (from `n_rows - max_ra_steps` to `n_rows` of the mother matrix) contains the target. If none does, it uses the
+     * one whose range is closest, with the target clamped to that range.
+     *
+     * @param candidate_code_ids ids of codes in `registry` to choose from
+     * @param frame_size number of samples per frame
+     * @param entropies conditional entropy (bits per sample) of every level
+     * @param efficiency factor (> 1 in practice) by which the syndrome exceeds the entropy
+     */
+    template<typename idx_t>
+    std::vector<LevelSpec> choose_level_specs(CodeRegistry<idx_t> &registry,
+                                              const std::vector<std::size_t> &candidate_code_ids,
+                                              std::size_t frame_size, const std::vector<double> &entropies,
+                                              double efficiency) {
+        struct Candidate {
+            std::size_t code_id;
+            std::size_t min_syndrome_size;
+            std::size_t max_syndrome_size;
+        };
+        std::vector<Candidate> candidates;
+        for (auto code_id: candidate_code_ids) {
+            const auto code = registry.get_mother_code(code_id);
+            if (static_cast<std::size_t>(code->getNCols()) == frame_size) {
+                const std::size_t n_rows = code->get_n_rows_mother_matrix();
+                candidates.push_back({code_id, n_rows - code->get_max_ra_steps(), n_rows});
+            }
+        }
+        if (candidates.empty()) {
+            std::stringstream s;
+            s << "choose_level_specs: none of the candidate codes has " << frame_size << " columns.";
+            throw std::invalid_argument(s.str());
+        }
+
+        std::vector<LevelSpec> levels;
+        for (auto h: entropies) {
+            const auto target = static_cast<std::size_t>(std::ceil(efficiency * h * static_cast<double>(frame_size)));
+            LevelSpec best{};
+            std::size_t best_distance = std::numeric_limits<std::size_t>::max();
+            for (const auto &candidate: candidates) {
+                const auto size = std::clamp(target, candidate.min_syndrome_size, candidate.max_syndrome_size);
+                const auto distance = (size > target) ? size - target : target - size;
+                if (distance < best_distance) {
+                    best = {candidate.code_id, size};
+                    best_distance = distance;
+                }
+            }
+            levels.push_back(best);
+        }
+        return levels;
+    }
+
+    /// Outcome of reconciling one frame. See `MultilevelReconciliation`.
+    struct MultilevelResult {
+        /// true iff all levels were decoded successfully
+        bool success{};
+
+        /// Number of levels decoded successfully. Decoding stops at the first failed level,
+        /// because higher levels would be conditioned on wrong bits.
+        std::size_t n_levels_decoded{};
+
+        /// Decoded bits per level (empty for levels that were not decoded)
+        std::vector<std::vector<std::uint8_t>> bits;
+
+        /// Decoded slice index of every sample (only if `success`)
+        std::vector<std::size_t> slice_indices;
+
+        double decoding_seconds{};  /// sum over levels of time spent inside the decoder
+    };
+
+
+    /*!
+     * Multilevel reconciliation of Gaussian samples with multistage decoding.
+     *
+     * The encoding party quantizes its samples `x` (see `SliceQuantizer`) and sends one syndrome per level
+     * (`compute_syndromes`). The decoding party decodes the levels in order (`submit`), starting at level 0.
+     * The LLRs of level `l` are computed from its samples `y` and the decoded levels `0, ..., l-1`.
+     *
+     * Levels are pipelined across frames: every level is a separate task on the thread pool, which submits the next
+     * level of the same frame when it finishes. Hence, different levels of consecutive frames decode concurrently,
+     * without blocking worker threads.
+     *
+     * All levels must use codes with the same number of columns (the number of samples per frame).
+     * The service (and its registry and thread pool) must outlive this object and all futures obtained from it.
+     *
+     * @tparam idx_t index type of the codes in the registry
+     */
+    template<typename idx_t=std::uint32_t>
+    class MultilevelReconciliation {
+    public:
+        using Bit = std::uint8_t;
+
+        MultilevelReconciliation(DecodingService<idx_t> &service, SliceQuantizer quantizer, GaussianChannel channel,
+                                 std::vector<LevelSpec> levels)
+                : service(service), quantizer(std::move(quantizer)), channel(channel), levels(std::move(levels)) {
+            if (this->levels.size() != this->quantizer.get_n_levels()) {
+                std::stringstream s;
+                s << "MultilevelReconciliation: expected one LevelSpec per quantization level ("
+                  << this->quantizer.get_n_levels() << "), got " << this->levels.size() << ".";
+                throw std::invalid_argument(s.str());
+            }
+            auto &registry = service.get_registry();
+            for (const auto &level: this->levels) {
+                const auto n_cols = static_cast<std::size_t>(registry.get_mother_code(level.code_id)->getNCols());
+                if (frame_size != 0 && n_cols != frame_size) {
+                    throw std::invalid_argument("MultilevelReconciliation: all levels must use codes of equal length.");
+                }
+                frame_size = n_cols;
+            }
+        }
+
+        /// Number of samples per frame.
+        [[nodiscard]] std::size_t get_frame_size() const {
+            return frame_size;
+        }
+
+        [[nodiscard]] const SliceQuantizer &get_quantizer() const {
+            return quantizer;
+        }
+
+        [[nodiscard]] const std::vector<LevelSpec> &get_levels() const {
+            return levels;
+        }
+
+        /// Encoding side: syndrome of every level of the quantized samples `x`.
+        std::vector<std::vector<Bit>> compute_syndromes(const std::vector<double> &x) const {
+            check_frame_size(x.size());
+            std::vector<std::vector<Bit>> syndromes(levels.size());
+            std::vector<Bit> bits;
+            for (std::size_t level{}; level < levels.size(); ++level) {
+                quantizer.quantize_level(x, level, bits);
+                service.get_registry().get_mother_code(levels[level].code_id)->encode_with_ra(
+                        bits, syndromes[level], levels[level].syndrome_size);
+            }
+            return syndromes;
+        }
+
+        /*!
+         * Decoding side: decode all levels of one frame asynchronously.
+         *
+         * @param y side information (one sample per code column)
+         * @param syndromes syndrome of every level (see `compute_syndromes`)
+         * @param config decoder settings used for every level
+         */
+        std::future<MultilevelResult> submit(std::vector<double> y, std::vector<std::vector<Bit>> syndromes,
+                                             const DecoderConfig &config) {
+            check_frame_size(y.size());
+            if (syndromes.size() != levels.size()) {
+                throw std::invalid_argument("MultilevelReconciliation: expected one syndrome per level.");
+            }
+            for (std::size_t level{}; level < levels.size(); ++level) {
+                if (syndromes[level].size() != levels[level].syndrome_size) {
+                    throw std::invalid_argument("MultilevelReconciliation: syndrome size does not match LevelSpec.");
+                }
+            }
+
+            auto frame = std::make_shared<FrameState>();
+            frame->y = std::move(y);
+            frame->syndromes = std::move(syndromes);
+            frame->config = config;
+            frame->lower_bits.resize(frame_size);
+            frame->result.bits.resize(levels.size());
+            auto result = frame->promise.get_future();
+            submit_level(std::move(frame), 0);
+            return result;
+        }
+
+        /// Decode asynchronously using the decoder settings of the service.
+        std::future<MultilevelResult> submit(std::vector<double> y, std::vector<std::vector<Bit>> syndromes) {
+            return submit(std::move(y), std::move(syndromes), service.get_decoder_config());
+        }
+
+    private:
+        struct FrameState {
+            std::vector<double> y;
+            std::vector<std::vector<Bit>> syndromes;
+            DecoderConfig config;
+            std::vector<std::size_t> lower_bits;  // decoded bits of all previous levels of every sample
+            MultilevelResult result;
+            std::promise<MultilevelResult> promise;
+        };
+
+        void check_frame_size(std::size_t size) const {
+            if (size != frame_size) {
+                std::stringstream s;
+                s << "MultilevelReconciliation: expected " << frame_size << " samples per frame, got " << size << ".";
+                throw std::invalid_argument(s.str());
+            }
+        }
+
+        void submit_level(std::shared_ptr<FrameState> frame, std::size_t level) {
+            service.get_thread_pool().submit([this, frame = std::move(frame), level]() mutable {
+                try {
+                    if (decode_level(*frame, level) && level + 1 < levels.size()) {
+                        submit_level(frame, level + 1);
+                        return;
+                    }
+                    finish(*frame);
+                } catch (...) {
+                    frame->promise.set_exception(std::current_exception());
+                }
+            });
+        }
+
+        /// Decodes level `level` of the frame. Returns true on success.
+        bool decode_level(FrameState &frame, std::size_t level) const {
+            std::vector<double> llrs(frame_size);
+            for (std::size_t i{}; i < frame_size; ++i) {
+                llrs[i] = multilevel_llr(quantizer, channel, frame.y[i], level, frame.lower_bits[i]);
+            }
+
+            auto decoded = service.decode(levels[level].code_id, llrs, frame.syndromes[level], frame.config);
+            frame.result.decoding_seconds += decoded.decoding_seconds;
+            if (!decoded.success) {
+                return false;
+            }
+            for (std::size_t i{}; i < frame_size; ++i) {
+                frame.lower_bits[i] |= std::size_t{decoded.key[i]} << level;
+            }
+            frame.result.bits[level] = std::move(decoded.key);
+            frame.result.n_levels_decoded++;
+            return true;
+        }
+
+        static void finish(FrameState &frame) {
+            frame.result.success = (frame.result.n_levels_decoded == frame.result.bits.size());
+            if (frame.result.success) {
+                frame.result.slice_indices = std::move(frame.lower_bits);
+            }
+            frame.promise.set_value(std::move(frame.result));
+        }
+
+        DecodingService<idx_t> &service;
+        SliceQuantizer quantizer;
+        GaussianChannel channel;
+        std::vector<LevelSpec> levels;
+        std::size_t frame_size{};
+    };
+
+}
+
+#endif //LDPC4QKD_MULTILEVEL_RECONCILIATION_HPP
@@ -0,0 +1,311 @@
+//
+// Created by alice on 18.10.26.
+//
+// Batch decoding with the two half-iterations of belief propagation pipelined across two threads:
+// while one thread runs the check node update of one frame, the other runs the variable node update of another.
+
+#ifndef LDPC4QKD_PIPELINED_DECODING_HPP
+#define LDPC4QKD_PIPELINED_DECODING_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rate_adaptive_code.hpp"
+#include "decoding_service.hpp"
+
+
+namespace LDPC4QKD {
+
+    /*!
+     * Lock-free single producer single consumer queue of bounded capacity.
+     * `push` may only be called by one thread and `pop` by one (other) thread.
+     */
+    template<typename T>
+    class SpscQueue {
+    public:
+        explicit SpscQueue(std::size_t capacity) : buffer(capacity + 1) {}
+
+        /// Returns false if the queue is full.
+        bool push(const T &value) {
+            const auto t = tail.load(std::memory_order_relaxed);
+            const auto next = (t + 1) % buffer.size();
+            if (next == head.load(std::memory_order_acquire)) {
+                return false;
+            }
+            buffer[t] = value;
+            tail.store(next, std::memory_order_release);
+            return true;
+        }
+
+        /// Returns false if the queue is empty.
+        bool pop(T &value) {
+            const auto h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire)) {
+                return false;
+            }
+            value = buffer[h];
+            head.store((h + 1) % buffer.size(), std::memory_order_release);
+            return true;
+        }
+
+    private:
+        std::vector<T> buffer;
+        alignas(64) std::atomic<std::size_t> head{};  // next element to pop, only written by the consumer
+        alignas(64) std::atomic<std::size_t> tail{};  // next free position, only written by the producer
+    };
+
+
+    /*!
+     * Decodes a stream of frames (one code at one rate) using two threads, each running one half-iteration of BP.
+     *
+     * A frame in flight occupies one of `n_slots` slots, i.e., decoder message buffers.
+     * The check node thread updates `msg_c` of a slot and hands the slot to the variable node thread, which updates
+     * `msg_v`, checks the syndrome and hands the slot back (or completes the frame and frees the slot).
+     * Slots are handed over through lock-free queues (`SpscQueue`), so each slot is used by one thread at a time.
+     * With two slots (ping-pong), both threads are busy as long as frames are waiting, while only two frames' messages
+     * are in use. Compared to decoding frames in parallel (one workspace per thread),
+     * this keeps the working set small enough to stay in a shared cache for medium sized codes.
+     * Use several decoders to use more than two threads.
+     *
+     * Results are the same as those of `RateAdaptiveCode::decode_at_current_rate`.
+     * Decimation and restarts (see `DecoderConfig`) are not supported.
+     * The destructor finishes all submitted frames.
+     *
+     * @tparam idx_t index type of the code
+     */
+    template<typename idx_t>
+    class PipelinedDecoder {
+    public:
+        using Bit = std::uint8_t;
+
+        /*!
+         * Starts the two decoding threads.
+         *
+         * @param code code at the rate of all frames (must not be modified while the decoder exists)
+         * @param config decoder settings
+         * @param n_slots number of frames in flight (at least two keep both threads busy)
+         */
+        explicit PipelinedDecoder(std::shared_ptr<const RateAdaptiveCode<idx_t>> code, DecoderConfig config = {},
+                                  std::size_t n_slots = 2)
+                : code(std::move(code)), config(config), slots(n_slots),
+                  free_slots(n_slots), to_check_nodes(n_slots), to_var_nodes(n_slots) {
+            if (n_slots == 0 || config.max_num_iter == 0) {
+                throw std::invalid_argument("PipelinedDecoder: requires at least one slot and one iteration.");
+            }
+            if (config.decimation_rounds != 0 || config.restarts != 0) {
+                throw std::invalid_argument("PipelinedDecoder: decimation and restarts are not supported.");
+            }
+            for (std::size_t i{}; i < n_slots; ++i) {
+                this->code->prepare_workspace(slots[i].workspace);
+                free_slots.push(i);
+            }
+            check_node_thread = std::thread([this]() { check_node_loop(); });
+            var_node_thread = std::thread([this]() { var_node_loop(); });
+        }
+
+        PipelinedDecoder(const PipelinedDecoder &) = delete;
+
+        PipelinedDecoder &operator=(const PipelinedDecoder &) = delete;
+
+        ~PipelinedDecoder() {
+            stopping = true;
+            notify();
+            check_node_thread.join();
+            var_node_thread.join();
+        }
+
+        /// Queue a frame for decoding. Thread-safe.
+        /// @return future holding the result. `DecodingResult::decoding_seconds` includes the time the frame waited
+        ///     for a slot.
+        std::future<DecodingResult> submit(std::vector<double> llrs, std::vector<Bit> syndrome) {
+            if (llrs.size() != code->getNCols() || syndrome.size() != code->get_n_rows_after_rate_adaption()) {
+                throw std::runtime_error("PipelinedDecoder: invalid input length or syndrome size for the code.");
+            }
+            Input input{std::move(llrs), std::move(syndrome), {}, std::chrono::steady_clock::now()};
+            auto result = input.promise.get_future();
+            n_pending++;  // before publishing the input, such that the decoding threads never see it negative
+            {
+                std::lock_guard<std::mutex> lock(input_mutex);
+                inputs.push_back(std::move(input));
+            }
+            notify();
+            return result;
+        }
+
+        [[nodiscard]] const RateAdaptiveCode<idx_t> &get_code() const {
+            return *code;
+        }
+
+        [[nodiscard]] const DecoderConfig &get_decoder_config() const {
+            return config;
+        }
+
+    private:
+        struct Input {
+            std::vector<double> llrs;
+            std::vector<Bit> syndrome;
+            std::promise<DecodingResult> promise;
+            std::chrono::steady_clock::time_point submitted;
+        };
+
+        struct Slot {
+            DecoderWorkspace workspace;
+            std::optional<Input> input;
+            DecodingResult result;
+        };
+
+        /// Wakes up both threads (after a slot was handed over or a frame was submitted).
+        void notify() {
+            {
+                std::lock_guard<std::mutex> lock(wake_mutex);
+                ++sequence;
+            }
+            wake.notify_all();
+        }
+
+        /// Waits until `notify` was called after `seen` was read.
+        void wait(std::uint64_t seen) {
+            std::unique_lock<std::mutex> lock(wake_mutex);
+            wake.wait(lock, [this, seen]() { return sequence.load() != seen; });
+        }
+
+        [[nodiscard]] bool done() const {
+            return stopping && n_pending.load() == 0;
+        }
+
+        void check_node_loop() {
+            std::size_t slot_idx{};
+            while (true) {
+                const auto seen = sequence.load();
+                if (to_check_nodes.pop(slot_idx) || admit(slot_idx)) {
+                    check_node_half_iteration(slots[slot_idx]);
+                    to_var_nodes.push(slot_idx);  // cannot fail: there are at most `n_slots` slots in flight
+                    notify();
+                } else if (done()) {
+                    return;
+                } else {
+                    wait(seen);
+                }
+            }
+        }
+
+        void var_node_loop() {
+            std::size_t slot_idx{};
+            while (true) {
+                const auto seen = sequence.load();
+                if (to_var_nodes.pop(slot_idx)) {
+                    auto &slot = slots[slot_idx];
+                    if (var_node_half_iteration(slot)) {
+                        complete(slot);
+                        free_slots.push(slot_idx);
+                    } else {
+                        to_check_nodes.push(slot_idx);
+                    }
+                    notify();
+                } else if (done()) {
+                    return;
+                } else {
+                    wait(seen);
+                }
+            }
+        }
+
+        /// Moves the next submitted frame into a free slot (called by the check node thread).
+        bool admit(std::size_t &slot_idx) {
+            std::lock_guard<std::mutex> lock(input_mutex);
+            if (inputs.empty() || !free_slots.pop(slot_idx)) {
+                return false;
+            }
+            auto &slot = slots[slot_idx];
+            slot.input.emplace(std::move(inputs.front()));
+            inputs.pop_front();
+            slot.result = DecodingResult{};
+            slot.result.n_threads = 2;
+            code->decode_start(slot.input->llrs, slot.input->syndrome, slot.workspace);
+            return true;
+        }
+
+        void check_node_half_iteration(Slot &slot) const {
+            auto &workspace = slot.workspace;
+            const std::size_t it = workspace.n_iterations++;
+            const double damping = (it == 0) ? 0. : config.damping;
+            if (config.check_node_rule == CheckNodeRule::normalized_min_sum) {
+                code->check_node_update_min_sum(workspace.msg_c, workspace.msg_v, slot.input->syndrome,
+                                                config.min_sum_normalization, damping);
+            } else {
+                code->check_node_update(workspace.msg_c, workspace.msg_v, slot.input->syndrome, damping);
+            }
+            RateAdaptiveCode<idx_t>::saturate(workspace.msg_c, config.vsat);
+        }
+
+        /// Returns true if the frame is done (converged, diverged or out of iterations).
+        bool var_node_half_iteration(Slot &slot) const {
+            auto &workspace = slot.workspace;
+            const auto &llrs = slot.input->llrs;
+            code->var_node_update(workspace.msg_v, workspace.msg_c, llrs);
+            RateAdaptiveCode<idx_t>::saturate(workspace.msg_v, config.vsat);
+
+            auto &key = slot.result.key;
+            key.resize(llrs.size());
+            code->hard_decision(key, llrs, workspace.msg_c);
+            if (code->syndrome_matches(key, slot.input->syndrome)) {
+                slot.result.success = true;
+                return true;
+            }
+            for (const auto &m: workspace.msg_v) {
+                for (const auto &v: m) {
+                    if (std::isnan(v)) {
+                        LDPC4QKD_DEBUG_MESSAGE("Decoder Diverged at iteration " << workspace.n_iterations - 1);
+                        workspace.n_iterations = config.max_num_iter;
+                        return true;
+                    }
+                }
+            }
+            return workspace.n_iterations >= config.max_num_iter;
+        }
+
+        void complete(Slot &slot) {
+            slot.result.n_iterations = slot.workspace.n_iterations;
+            slot.result.finished = std::chrono::steady_clock::now();
+            slot.result.decoding_seconds = std::chrono::duration<double>(
+                    slot.result.finished - slot.input->submitted).count();
+            slot.input->promise.set_value(std::move(slot.result));
+            slot.input.reset();
+            n_pending--;
+        }
+
+        std::shared_ptr<const RateAdaptiveCode<idx_t>> code;
+        DecoderConfig config;
+        std::vector<Slot> slots;
+
+        SpscQueue<std::size_t> free_slots;  // variable node thread -> check node thread
+        SpscQueue<std::size_t> to_check_nodes;  // variable node thread -> check node thread
+        SpscQueue<std::size_t> to_var_nodes;  // check node thread -> variable node thread
+
+        std::mutex input_mutex;  // protects `inputs`
+        std::deque<Input> inputs;  // submitted frames waiting for a slot
+        std::atomic<std::size_t> n_pending{};  // submitted frames that are not completed
+        std::atomic<bool> stopping{};
+        std::mutex wake_mutex;  // protects increments of `sequence`, such that `wait` does not miss them
+        std::condition_variable wake;
+        std::atomic<std::uint64_t> sequence{};  // incremented by `notify`
+
+        std::thread check_node_thread;
+        std::thread var_node_thread;
+    };
+
+}
+
+#endif //LDPC4QKD_PIPELINED_DECODING_HPP
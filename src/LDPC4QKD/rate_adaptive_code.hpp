@@ -12,6 +12,8 @@
 #include <vector>
 #include <algorithm>
 #include <numeric>
+#include <utility>
+#include <limits>
 #include <exception>
 #include <stdexcept>
 
@@ -47,6 +49,112 @@ namespace LDPC4QKD {
         return llrs;
     }
 
+    /// Message update rule used at the check nodes of the belief propagation decoder.
+    enum class CheckNodeRule {
+        sum_product,  /// exact (tanh-based) update rule
+        normalized_min_sum  /// min-sum approximation, messages are scaled by `DecoderConfig::min_sum_normalization`
+    };
+
+    /*!
+     * Settings of the belief propagation decoder.
+     * The default values give the same behaviour as calling the decoder without specifying a configuration.
+     * Use `read_decoder_config_from_json` (in `read_ldpc_file_formats.hpp`) to load a configuration from a file.
+     */
+    struct DecoderConfig {
+        /// Maximum number of iterations for the BP algorithm (the decoder terminates early if it converges).
+        std::size_t max_num_iter = 50;
+
+        /// Cut-off value for messages.
+        double vsat = 100;
+
+        CheckNodeRule check_node_rule = CheckNodeRule::sum_product;
+
+        /// Scaling of check node messages. Only used if `check_node_rule` is `CheckNodeRule::normalized_min_sum`.
+        double min_sum_normalization = 0.8;
+
+        /// Fraction of the previous check node message that is kept when updating it (zero means no damping).
+        /// Damping is not applied in the first iteration.
+        double damping = 0;
+
+        /// Maximum number of decimation rounds (zero disables decimation).
+        /// When BP stalls (see `decimation_stall_iterations`), a decimation round fixes the most reliable undecided
+        /// bits to their current estimate (they become known bits) and BP continues on the reduced graph.
+        /// Decimation does not add iterations beyond `max_num_iter`.
+        std::size_t decimation_rounds = 0;
+
+        /// BP is considered stalled if the number of unsatisfied checks did not decrease for this many iterations.
+        std::size_t decimation_stall_iterations = 5;
+
+        /// Fraction of the bits fixed by each decimation round (at least one bit).
+        double decimation_fraction = 0.01;
+
+        /// Maximum number of restarts with perturbed channel LLRs (zero disables restarts).
+        /// When BP stalls (see `restart_stall_iterations`) and no decimation rounds are left, the channel LLRs of the
+        /// bits connected to unsatisfied checks are perturbed and only the messages of these bits are re-initialized.
+        /// Each restart raises the iteration limit (`max_num_iter`) by `restart_max_iter`.
+        std::size_t restarts = 0;
+
+        /// Like `decimation_stall_iterations`, but for triggering a restart.
+        std::size_t restart_stall_iterations = 10;
+
+        /// Additional iterations allowed after each restart.
+        std::size_t restart_max_iter = 20;
+
+        /// A perturbed channel LLR is `llr * (1 + restart_perturbation * u)`, with `u` uniform in [-1, 1).
+        /// Values above one allow the perturbation to flip the sign of the LLR.
+        double restart_perturbation = 0.5;
+
+        /// Seed of the perturbations. Decoding the same frame with the same configuration gives the same result.
+        std::uint64_t restart_seed = 0;
+
+        bool operator==(const DecoderConfig &rhs) const {
+            return max_num_iter == rhs.max_num_iter &&
+                   vsat == rhs.vsat &&
+                   check_node_rule == rhs.check_node_rule &&
+                   min_sum_normalization == rhs.min_sum_normalization &&
+                   damping == rhs.damping &&
+                   decimation_rounds == rhs.decimation_rounds &&
+                   decimation_stall_iterations == rhs.decimation_stall_iterations &&
+                   decimation_fraction == rhs.decimation_fraction &&
+                   restarts == rhs.restarts &&
+                   restart_stall_iterations == rhs.restart_stall_iterations &&
+                   restart_max_iter == rhs.restart_max_iter &&
+                   restart_perturbation == rhs.restart_perturbation &&
+                   restart_seed == rhs.restart_seed;
+        }
+
+        bool operator!=(const DecoderConfig &rhs) const {
+            return !(*this == rhs);
+        }
+    };
+
+    /*!
+     * Message buffers of the belief propagation decoder.
+     * See `RateAdaptiveCode::decode_at_current_rate` and `RateAdaptiveCode::prepare_workspace`.
+     */
+    struct DecoderWorkspace {
+        std::vector<std::vector<double>> msg_v;  /// messages from variable nodes to check nodes
+        std::vector<std::vector<double>> msg_c;  /// messages from check nodes to variable nodes
+        std::size_t n_iterations{};  /// iterations done so far by a resumable decoding (see `decode_continue`)
+
+        // State of the decimation (see `DecoderConfig::decimation_rounds`), reset by `decode_start`.
+        std::vector<double> decimated_llrs;  /// channel LLRs with fixed bits set to +-infinity (empty if none fixed)
+        std::size_t n_decimation_rounds{};  /// decimation rounds done so far
+        std::size_t min_n_unsatisfied_checks{};  /// smallest number of unsatisfied checks since the last round
+        std::size_t n_stalled_iterations{};  /// iterations since `min_n_unsatisfied_checks` last decreased
+
+        // State of the restarts (see `DecoderConfig::restarts`), reset by `decode_start`.
+        std::vector<double> perturbed_llrs;  /// channel LLRs used since the last restart (empty if none)
+        std::size_t n_restarts{};  /// restarts done so far. Converging with `n_restarts > 0` means a restart helped.
+    };
+
+    /// State of a resumable decoding after `RateAdaptiveCode::decode_continue`.
+    enum class DecoderStatus {
+        converged,  /// the prediction matches the syndrome
+        failed,  /// maximum number of iterations reached (or decoder diverged) without convergence
+        suspended  /// stopped before convergence, can be continued by calling `decode_continue` again
+    };
+
     /*!
      * Belief propagation (BP) decoder for binary low density parity check (LDPC) codes.
      * Supports rate adaption (reducing the number of LDPC matrix rows).
@@ -94,8 +202,9 @@ namespace LDPC4QKD {
          * TODO add extra checks for validity of `rows_to_combine_rate_adapt`
          *
          * note: there used to be a parameter `do_elimination_check` to check for repeated node indices after rate adaption.
-         *      Such indices are now removed during `recompute_pos_vn_cn`. Consequentially, node eliminations are allowed.
-         *              TODO make sure this is correct
+         *      Combining two rows is addition over GF(2), so `recompute_pos_vn_cn` removes columns contained in both
+         *      rows (as `encode_with_ra` does by XORing the two syndrome bits). Variable nodes may thereby lose edges,
+         *      or all of them at high rates, which the decoders allow.
          *
          * @tparam colptr_t unsigned integer type that fits ("number of non-zero matrix entries" + 1)
          * @param colptr column pointer array for specifying mother parity check matrix.
@@ -163,7 +272,7 @@ namespace LDPC4QKD {
         /*!
          *  Encode (i.e., compute syndrome) using mother matrix
          * @tparam BitL e.g. std::uint8_t or bool.
-         * @tparam BitRBitR allowed to be signed, to enable the "mark combined by -1" trick in `encode_with_ra`.
+         * @tparam BitR e.g. std::uint8_t or bool.
          * @param in input bitvector
          * @param out output bitvector
          */
@@ -194,6 +303,27 @@ namespace LDPC4QKD {
             if (in.size() != n_cols) {
                 throw std::domain_error("Encoder (encode_with_ra) received invalid input length.");
             }
+
+            std::vector<Bit> mother_syndrome;
+            encode_no_ra(in, mother_syndrome);
+            rate_adapt_syndrome(mother_syndrome, out, output_syndrome_length);
+        }
+
+        /*!
+         * Compute the rate adapted syndrome from the syndrome of the mother matrix (as computed by `encode_no_ra`).
+         * Does not change internal rate adaption state!
+         * The mother syndrome can be computed once per frame, and the syndrome at any rate derived from it cheaply.
+         * @param mother_syndrome syndrome of the mother matrix
+         * @param out Vector to store syndrome. Will be resized to `output_syndrome_length`
+         * @param output_syndrome_length Desired length of syndrome (exception is thrown if not satisfiable)
+         */
+        template<typename BitL, typename BitR>
+        void rate_adapt_syndrome(const std::vector<BitL> &mother_syndrome,
+                                 std::vector<BitR> &out,
+                                 std::size_t output_syndrome_length) const {
+            if (mother_syndrome.size() != n_mother_rows) {
+                throw std::domain_error("Mother syndrome size does not match the number of rows of the mother matrix.");
+            }
             if (output_syndrome_length > n_mother_rows) {
                 throw std::domain_error("Requested syndrome is larger than the number of rows of the mother matrix.");
             }
@@ -201,32 +331,23 @@ namespace LDPC4QKD {
                 throw std::domain_error("Requested syndrome is smaller than supported by the specified rate adaption.");
             }
 
-            // HAVE to use !!!SIGNED!!! `int8_t`!!! Value `-1` is used below to mark bits included into final output!
-            std::vector<std::int8_t> non_ra_encoding;
-            encode_no_ra(in, non_ra_encoding);
-
-            // now use the non-rate adapted syndrome to compute the rate adapted syndrome
-            const std::size_t n_line_combinations = n_mother_rows - output_syndrome_length;
-            out.assign(output_syndrome_length, 0);
-
-            std::size_t start_of_ra_part = output_syndrome_length - n_line_combinations;
+            rate_adapt_syndrome(mother_syndrome, out, combinations_at_rate(n_mother_rows - output_syndrome_length));
+        }
 
-            // put results of combined lines at the back of output.
-            for (std::size_t i{}; i < n_line_combinations; ++i) {
-                out[start_of_ra_part + i] = xor_as_bools(non_ra_encoding[rows_to_combine[2 * i]],
-                                                         non_ra_encoding[rows_to_combine[2 * i + 1]]);
-                non_ra_encoding[rows_to_combine[2 * i]] = -1;  // -1 marks that the value has been used.
-                non_ra_encoding[rows_to_combine[2 * i + 1]] = -1;
+        /// Same as above, for the row combinations given by `combinations` (see `set_combinations`).
+        template<typename BitL, typename BitR>
+        void rate_adapt_syndrome(const std::vector<BitL> &mother_syndrome,
+                                 std::vector<BitR> &out,
+                                 const std::vector<bool> &combinations) const {
+            if (mother_syndrome.size() != n_mother_rows) {
+                throw std::domain_error("Mother syndrome size does not match the number of rows of the mother matrix.");
             }
-
-            std::size_t j{};
-            // put the remaining bits that were not rate adapted at the front of output.
-            for (std::size_t i{}; i < start_of_ra_part; ++i) {
-                while (non_ra_encoding[j] == -1) {
-                    j++;
-                }
-                out[i] = non_ra_encoding[j];
-                j++;
+            const auto ra_rows = mother_row_to_ra_row(combinations);
+            out.assign(n_mother_rows - static_cast<std::size_t>(
+                    std::count(combinations.begin(), combinations.end(), true)), 0);
+            for (std::size_t m{}; m < n_mother_rows; ++m) {
+                out[ra_rows[m]] = static_cast<BitR>(
+                        static_cast<bool>(out[ra_rows[m]]) != static_cast<bool>(mother_syndrome[m]));
             }
         }
 
@@ -266,6 +387,72 @@ namespace LDPC4QKD {
                                     std::vector<Bit> &out,
                                     const std::size_t max_num_iter = 50,
                                     const double vsat = 100) const {
+            DecoderConfig config{};
+            config.max_num_iter = max_num_iter;
+            config.vsat = vsat;
+            return decode_at_current_rate(llrs, syndrome, out, config);
+        }
+
+        /// Same as `decode_infer_rate` above, but with all decoder settings given by `config`.
+        template<typename Bit>
+        bool decode_infer_rate(const std::vector<double> &llrs,
+                               const std::vector<Bit> &syndrome,
+                               std::vector<Bit> &out,
+                               const DecoderConfig &config) {
+            if (syndrome.size() != n_ra_rows) {
+                set_rate(get_n_rows_mother_matrix() - syndrome.size());
+            }
+            return decode_at_current_rate(llrs, syndrome, out, config);
+        }
+
+        /*!
+         * Decode using belief propagation
+         *
+         * @tparam Bit: e.g. std::uint8_t or bool TODO use concept `std::unsigned_integral` when using C++20
+         * @param llrs: Log likelihood ratios representing the received message
+         * @param syndrome: Syndrome of the sent message
+         * @param out: Buffer to which the function writes its prediction for the sent message.
+         * @param config: Decoder settings (number of iterations, check node rule, etc.). See `DecoderConfig`.
+         * @return true if and only if the syndrome of buffer `out` matches given `syndrome` (i.e., decoder converged).
+         */
+        template<typename Bit>
+        bool decode_at_current_rate(const std::vector<double> &llrs,
+                                    const std::vector<Bit> &syndrome,
+                                    std::vector<Bit> &out,
+                                    const DecoderConfig &config) const {
+            DecoderWorkspace workspace;
+            return decode_at_current_rate(llrs, syndrome, out, config, workspace);
+        }
+
+        /*!
+         * Same as `decode_at_current_rate` above, but uses the message buffers of `workspace`.
+         * Reusing a workspace (at the same rate) avoids allocating memory for every frame.
+         * A workspace must not be used by several threads at the same time.
+         */
+        template<typename Bit>
+        bool decode_at_current_rate(const std::vector<double> &llrs,
+                                    const std::vector<Bit> &syndrome,
+                                    std::vector<Bit> &out,
+                                    const DecoderConfig &config,
+                                    DecoderWorkspace &workspace) const {
+            decode_start(llrs, syndrome, workspace);
+            return decode_continue(llrs, syndrome, out, config, workspace, std::numeric_limits<std::size_t>::max())
+                   == DecoderStatus::converged;
+        }
+
+        /*!
+         * Start a resumable decoding: checks the inputs and initializes the messages in `workspace`.
+         * The decoding is then performed by (one or more) calls to `decode_continue`.
+         * All state of the decoding is kept in `workspace`, so it can be continued on a different thread.
+         *
+         * @param llrs: Log likelihood ratios representing the received message
+         * @param syndrome: Syndrome of the sent message
+         * @param workspace: Message buffers holding the state of the decoding
+         */
+        template<typename Bit>
+        void decode_start(const std::vector<double> &llrs,
+                          const std::vector<Bit> &syndrome,
+                          DecoderWorkspace &workspace) const {
             // check inputs.
             if (llrs.size() != n_cols) {
                 throw std::runtime_error("Decoder received invalid input length.");
@@ -277,40 +464,247 @@ namespace LDPC4QKD {
                         "Use decode_infer_rate to deduce rate automatically.");
             }
 
-            out.resize(llrs.size());
-
-            std::vector<std::vector<double>> msg_v(n_ra_rows);  // messages from variable nodes to check nodes
-            std::vector<std::vector<double>> msg_c(n_cols);  // messages from check nodes to variable nodes
-
-            // initialize msg_v
+            prepare_workspace(workspace);
+            workspace.n_iterations = 0;
+            workspace.decimated_llrs.clear();
+            workspace.n_decimation_rounds = 0;
+            workspace.min_n_unsatisfied_checks = std::numeric_limits<std::size_t>::max();
+            workspace.n_stalled_iterations = 0;
+            workspace.perturbed_llrs.clear();
+            workspace.n_restarts = 0;
+            auto &msg_v = workspace.msg_v;  // messages from variable nodes to check nodes
+
+            // initialize msg_v (msg_c is fully overwritten in the first iteration)
             for (std::size_t i{}; i < msg_v.size(); ++i) {
                 auto &curr_mv = msg_v[i];
-                curr_mv.resize(pos_varn[i].size());
-                for (std::size_t j{}; j < msg_v[i].size(); ++j) {
+                for (std::size_t j{}; j < curr_mv.size(); ++j) {
                     curr_mv[j] = llrs[pos_varn[i][j]];
                 }
             }
+        }
 
-            // initialize msg_c
-            for (std::size_t i{}; i < msg_c.size(); ++i) {
-                msg_c[i].resize(pos_checkn[i].size());
+        /*!
+         * Like `decode_start`, but keeps the check node messages of a previous (unsuccessful) decoding of the same
+         * frame at a different rate, for example after more syndrome bits were revealed (blind reconciliation).
+         * A check node message is carried over if its edge corresponds to the same mother matrix row at both rates.
+         * Edges that are new at the current rate (a bit that cancelled out of a combined row) start from zero.
+         *
+         * @param llrs: Log likelihood ratios representing the received message
+         * @param syndrome: Syndrome of the sent message at the current rate
+         * @param workspace: Workspace holding the messages of the previous decoding, reused for the new decoding
+         * @param previous_n_line_combs: number of row combinations (rate) of the previous decoding
+         */
+        template<typename Bit>
+        void decode_start_warm(const std::vector<double> &llrs,
+                               const std::vector<Bit> &syndrome,
+                               DecoderWorkspace &workspace,
+                               const std::size_t previous_n_line_combs) const {
+            decode_start_warm(llrs, syndrome, workspace, combinations_at_rate(previous_n_line_combs));
+        }
+
+        /// Same as above, for a previous decoding with the row combinations `previous_combinations`
+        /// (see `set_combinations`). The combinations of the current rate can be any subset of them.
+        template<typename Bit>
+        void decode_start_warm(const std::vector<double> &llrs,
+                               const std::vector<Bit> &syndrome,
+                               DecoderWorkspace &workspace,
+                               const std::vector<bool> &previous_combinations) const {
+            if (workspace.msg_c.size() != n_cols) {
+                throw std::runtime_error("Warm start requires a workspace holding the messages of a previous decoding.");
+            }
+            std::vector<std::vector<double>> previous_msg_c = std::move(workspace.msg_c);
+            workspace.msg_c.clear();
+            decode_start(llrs, syndrome, workspace);
+
+            const auto previous_rows = mother_row_to_ra_row(previous_combinations);
+            const auto current_rows = mother_row_to_ra_row(applied_combinations);
+            std::vector<std::vector<std::size_t>> mother_pos_checkn(n_cols);
+            for (std::size_t m{}; m < n_mother_rows; ++m) {
+                for (auto var_node: mother_pos_varn[m]) {
+                    mother_pos_checkn[var_node].push_back(m);
+                }
+            }
+
+            std::vector<std::size_t> previous_pos_checkn;
+            for (std::size_t j{}; j < n_cols; ++j) {
+                // check nodes of bit `j` at the previous rate (sorted, as `pos_checkn`). Rows containing `j` twice
+                // (both mother rows of a combination) cancel.
+                previous_pos_checkn.clear();
+                for (auto m: mother_pos_checkn[j]) {
+                    previous_pos_checkn.push_back(previous_rows[m]);
+                }
+                std::sort(previous_pos_checkn.begin(), previous_pos_checkn.end());
+                auto out_it = previous_pos_checkn.begin();
+                for (auto it = previous_pos_checkn.begin(); it != previous_pos_checkn.end();) {
+                    if (std::next(it) != previous_pos_checkn.end() && *it == *std::next(it)) {
+                        it += 2;
+                    } else {
+                        *out_it++ = *it++;
+                    }
+                }
+                previous_pos_checkn.erase(out_it, previous_pos_checkn.end());
+                if (previous_pos_checkn.size() != previous_msg_c[j].size()) {
+                    throw std::runtime_error("Warm start: messages in workspace do not match the previous rate.");
+                }
+
+                for (auto m: mother_pos_checkn[j]) {
+                    const auto current = std::lower_bound(pos_checkn[j].begin(), pos_checkn[j].end(), current_rows[m]);
+                    const auto previous = std::lower_bound(
+                            previous_pos_checkn.begin(), previous_pos_checkn.end(), previous_rows[m]);
+                    if (current != pos_checkn[j].end() && *current == current_rows[m] &&
+                        previous != previous_pos_checkn.end() && *previous == previous_rows[m]) {
+                        workspace.msg_c[j][static_cast<std::size_t>(current - pos_checkn[j].begin())] =
+                                previous_msg_c[j][static_cast<std::size_t>(previous - previous_pos_checkn.begin())];
+                    }
+                }
+            }
+
+            var_node_update(workspace.msg_v, workspace.msg_c, llrs);
+        }
+
+        /*!
+         * Ranks the row combinations of the current rate by how much splitting them (i.e., revealing the syndrome bit
+         * of their first mother row, see `targeted_syndrome_increment`) is expected to help a decoding that did not
+         * converge. Bits that are in many unsatisfied checks and have unreliable posterior LLRs are likely wrong;
+         * splitting a combined row containing them gives these bits an additional check (and reconnects bits that
+         * cancelled out of the combined row).
+         *
+         * The score of a combination is the sum over the bits of both of its mother rows of
+         * (number of unsatisfied checks of the bit) / (1 + |posterior LLR of the bit|).
+         * Ties (e.g. combinations far from any unsatisfied check) are ordered as the row combinations are undone by
+         * `set_rate` (last combination first).
+         * The ranking is meant for splitting a few combinations per round (each round continuing from the messages
+         * of the last, see `decode_start_warm`). Splitting most combinations at once is better done in the order
+         * of the rate adaption, which is designed such that the remaining combined rows form a good code.
+         *
+         * @param llrs: Log likelihood ratios given to the decoder
+         * @param syndrome: Syndrome given to the decoder (at the current rate)
+         * @param workspace: Workspace holding the messages of the decoding
+         * @return indices of the performed row combinations, most promising first
+         */
+        template<typename Bit>
+        [[nodiscard]] std::vector<std::size_t> rank_combinations_to_split(const std::vector<double> &llrs,
+                                                                          const std::vector<Bit> &syndrome,
+                                                                          const DecoderWorkspace &workspace) const {
+            if (llrs.size() != n_cols || syndrome.size() != n_ra_rows || workspace.msg_c.size() != n_cols) {
+                throw std::runtime_error("Ranking row combinations requires the inputs and messages of a decoding "
+                                         "at the current rate.");
             }
 
-            for (std::size_t it_unused{}; it_unused < max_num_iter; ++it_unused) {
-                check_node_update(msg_c, msg_v, syndrome);
-                saturate(msg_c, vsat);
+            std::vector<double> unreliability(n_cols);
+            std::vector<std::uint8_t> decision(n_cols);
+            for (std::size_t j{}; j < n_cols; ++j) {
+                const auto &msg_c = workspace.msg_c[j];
+                const double total = std::accumulate(msg_c.begin(), msg_c.end(), llrs[j]);
+                decision[j] = (total < 0);
+                unreliability[j] = 1 / (1 + (std::isnan(total) ? 0 : std::abs(total)));
+            }
+            std::vector<std::size_t> n_unsatisfied(n_cols);
+            for (std::size_t m{}; m < n_ra_rows; ++m) {
+                bool parity = static_cast<bool>(syndrome[m]);
+                for (auto var_node: pos_varn[m]) {
+                    parity = xor_as_bools(parity, decision[var_node]);
+                }
+                if (parity) {
+                    for (auto var_node: pos_varn[m]) {
+                        n_unsatisfied[var_node]++;
+                    }
+                }
+            }
 
-                var_node_update(msg_v, msg_c, llrs);
-                saturate(msg_v, vsat);
+            std::vector<std::pair<double, std::size_t>> scores;
+            for (std::size_t i = applied_combinations.size(); i-- > 0;) {
+                if (!applied_combinations[i]) {
+                    continue;
+                }
+                double score{};
+                for (auto row: {rows_to_combine[2 * i], rows_to_combine[2 * i + 1]}) {
+                    for (auto var_node: mother_pos_varn[row]) {
+                        score += static_cast<double>(n_unsatisfied[var_node]) * unreliability[var_node];
+                    }
+                }
+                scores.emplace_back(score, i);
+            }
+            std::stable_sort(scores.begin(), scores.end(), [](const auto &lhs, const auto &rhs) {
+                return lhs.first > rhs.first;
+            });
+
+            std::vector<std::size_t> result;
+            result.reserve(scores.size());
+            for (const auto &[score, i]: scores) {
+                result.push_back(i);
+            }
+            return result;
+        }
+
+        /*!
+         * Continue a decoding started by `decode_start` for at most `n_iterations` more iterations.
+         * Gives the same result as `decode_at_current_rate`, no matter how the iterations are split between calls.
+         *
+         * @param llrs: same as given to `decode_start`
+         * @param syndrome: same as given to `decode_start`
+         * @param out: Buffer to which the function writes its (current) prediction for the sent message.
+         * @param config: Decoder settings. `config.max_num_iter` limits the total number of iterations
+         *                (raised by `config.restart_max_iter` for each restart).
+         * @param workspace: workspace given to `decode_start`
+         * @param n_iterations: maximum number of iterations done by this call
+         * @return `DecoderStatus::suspended` if the decoding can be continued, else whether it converged.
+         */
+        template<typename Bit>
+        DecoderStatus decode_continue(const std::vector<double> &llrs,
+                                      const std::vector<Bit> &syndrome,
+                                      std::vector<Bit> &out,
+                                      const DecoderConfig &config,
+                                      DecoderWorkspace &workspace,
+                                      const std::size_t n_iterations) const {
+            out.resize(llrs.size());
+            auto &msg_v = workspace.msg_v;  // messages from variable nodes to check nodes
+            auto &msg_c = workspace.msg_c;  // messages from check nodes to variable nodes
+
+            for (std::size_t i{}; i < n_iterations; ++i) {
+                // channel LLRs, including the bits fixed by decimation and the perturbations of the last restart
+                const auto &channel_llrs = !workspace.perturbed_llrs.empty() ? workspace.perturbed_llrs
+                                           : !workspace.decimated_llrs.empty() ? workspace.decimated_llrs : llrs;
+
+                if (workspace.n_iterations >= iteration_limit(config, workspace)) {
+                    return DecoderStatus::failed;
+                }
+                const std::size_t it = workspace.n_iterations++;
+                const double damping = (it == 0) ? 0. : config.damping;
+                if (config.check_node_rule == CheckNodeRule::normalized_min_sum) {
+                    check_node_update_min_sum(msg_c, msg_v, syndrome, config.min_sum_normalization, damping);
+                } else {
+                    check_node_update(msg_c, msg_v, syndrome, damping);
+                }
+                saturate(msg_c, config.vsat);
+
+                var_node_update(msg_v, msg_c, channel_llrs);
+                saturate(msg_v, config.vsat);
 
                 // hard decision
-                hard_decision(out, llrs, msg_c);
+                hard_decision(out, channel_llrs, msg_c);
 
                 // terminate decoding if codeword matches syndrome
-                std::vector<Bit> decision_syndrome(syndrome.size());
-                encode_at_current_rate(out, decision_syndrome);
-                if (decision_syndrome == syndrome) {
-                    return true;
+                const bool decimation_left = workspace.n_decimation_rounds < config.decimation_rounds;
+                if (decimation_left || workspace.n_restarts < config.restarts) {
+                    const std::size_t n_unsatisfied = n_unsatisfied_checks(out, syndrome);
+                    if (n_unsatisfied == 0) {
+                        return DecoderStatus::converged;
+                    }
+                    const auto stall_iterations = decimation_left ? config.decimation_stall_iterations
+                                                                  : config.restart_stall_iterations;
+                    if (n_unsatisfied < workspace.min_n_unsatisfied_checks) {
+                        workspace.min_n_unsatisfied_checks = n_unsatisfied;
+                        workspace.n_stalled_iterations = 0;
+                    } else if (++workspace.n_stalled_iterations >= stall_iterations) {
+                        if (decimation_left) {
+                            decimate(llrs, msg_c, config, workspace);
+                        } else {
+                            restart(llrs, syndrome, out, msg_v, msg_c, config, workspace);
+                        }
+                    }
+                } else if (syndrome_matches(out, syndrome)) {
+                    return DecoderStatus::converged;
                 }
 
                 // check for diverging decoder
@@ -318,14 +712,30 @@ namespace LDPC4QKD {
                     for (const auto &v: m) {
                         if (std::isnan(v)) {
                             // TODO maybe use exception?
-                            LDPC4QKD_DEBUG_MESSAGE("Decoder Diverged at iteration " << it_unused);
-                            return false;
+                            LDPC4QKD_DEBUG_MESSAGE("Decoder Diverged at iteration " << it);
+                            workspace.n_iterations = iteration_limit(config, workspace);
+                            return DecoderStatus::failed;
                         }
                     }
                 }
             }
 
-            return false;  // Decoding was not successful.
+            if (workspace.n_iterations >= iteration_limit(config, workspace)) {
+                return DecoderStatus::failed;  // Decoding was not successful.
+            }
+            return DecoderStatus::suspended;
+        }
+
+        /// Allocates the message buffers of `workspace` for the current rate (does nothing if already allocated).
+        void prepare_workspace(DecoderWorkspace &workspace) const {
+            workspace.msg_v.resize(n_ra_rows);
+            for (std::size_t i{}; i < n_ra_rows; ++i) {
+                workspace.msg_v[i].resize(pos_varn[i].size());
+            }
+            workspace.msg_c.resize(n_cols);
+            for (std::size_t i{}; i < n_cols; ++i) {
+                workspace.msg_c[i].resize(pos_checkn[i].size());
+            }
         }
 
         //! manually trigger rate adaption. In normal circumstances, the user does not need this function
@@ -334,6 +744,21 @@ namespace LDPC4QKD {
             recompute_pos_vn_cn(n_line_combs);
         }
 
+        /*!
+         * Rate adaption using any subset of the row combinations, e.g., after some of the combined rows were split
+         * (see `rank_combinations_to_split`). Rows that are not combined come first (in the order of the mother matrix),
+         * followed by the combined rows (in the order of the row combinations).
+         * `set_combinations(combinations_at_rate(n))` is the same as `set_rate(n)`.
+         *
+         * Note: `decode_infer_rate` only compares the syndrome size to the current rate, it does not check whether
+         * the current combinations are those of `set_rate`.
+         *
+         * @param combinations entry `i` is true if row combination `i` is performed (size `get_max_ra_steps()`)
+         */
+        void set_combinations(const std::vector<bool> &combinations) {
+            recompute_pos_vn_cn(combinations);
+        }
+
         template<typename BitL=bool, typename BitR=bool>
         constexpr void encode_at_current_rate(
                 const std::vector<BitL> &in, std::vector<BitR> &out) const {
@@ -390,94 +815,333 @@ namespace LDPC4QKD {
             return rows_to_combine.size() / 2;
         }
 
-    private:   // -------------------------------------------------------------------------------------- private members
+        /// Pairs of mother matrix rows combined by rate adaption (row combination `i` combines entries `2i`, `2i+1`).
+        [[nodiscard]] const std::vector<idx_t> &get_rows_to_combine() const {
+            return rows_to_combine;
+        }
+
+        /// Row combinations performed by the current rate adaption (entry `i` for row combination `i`).
+        /// These are the first `n_line_combs` ones after `set_rate(n_line_combs)`.
+        [[nodiscard]] const std::vector<bool> &get_combinations() const {
+            return applied_combinations;
+        }
+
+        /// Row combinations performed by `set_rate(n_line_combs)`, i.e., the first `n_line_combs` ones.
+        [[nodiscard]] std::vector<bool> combinations_at_rate(const std::size_t n_line_combs) const {
+            if (rows_to_combine.size() < 2 * n_line_combs) {
+                throw std::runtime_error("Requested rate not supported. Not enough line combinations specified.");
+            }
+            std::vector<bool> result(rows_to_combine.size() / 2);
+            std::fill_n(result.begin(), n_line_combs, true);
+            return result;
+        }
+
+        /// Index of the row of the rate adapted matrix (with `n_line_combs` row combinations) containing each mother row.
+        [[nodiscard]] std::vector<std::size_t> mother_row_to_ra_row(const std::size_t n_line_combs) const {
+            return mother_row_to_ra_row(combinations_at_rate(n_line_combs));
+        }
+
+        /// Same as above, for the row combinations given by `combinations` (see `set_combinations`).
+        [[nodiscard]] std::vector<std::size_t> mother_row_to_ra_row(const std::vector<bool> &combinations) const {
+            if (combinations.size() != rows_to_combine.size() / 2) {
+                throw std::runtime_error("Row combinations do not match the rate adaption of the code.");
+            }
+            const auto n_line_combs = static_cast<std::size_t>(
+                    std::count(combinations.begin(), combinations.end(), true));
+            constexpr auto unassigned = std::numeric_limits<std::size_t>::max();
+            std::vector<std::size_t> result(n_mother_rows, unassigned);
+            const auto start_of_ra_part = n_mother_rows - 2 * n_line_combs;
+            std::size_t k{};
+            for (std::size_t i{}; i < combinations.size(); ++i) {
+                if (combinations[i]) {
+                    result[rows_to_combine[2 * i]] = start_of_ra_part + k;
+                    result[rows_to_combine[2 * i + 1]] = start_of_ra_part + k;
+                    k++;
+                }
+            }
+            std::size_t next_row{};
+            for (auto &row: result) {
+                if (row == unassigned) {
+                    row = next_row++;
+                }
+            }
+            return result;
+        }
+
+        /// Largest variable node degree (column weight) of the mother matrix. Rate adaption never increases it.
+        [[nodiscard]] std::size_t get_max_var_node_degree() const {
+            std::vector<std::size_t> degrees(n_cols);
+            for (const auto &row: mother_pos_varn) {
+                for (auto var_node: row) {
+                    degrees[var_node]++;
+                }
+            }
+            return degrees.empty() ? 0 : *std::max_element(degrees.begin(), degrees.end());
+        }
+
+        // ---------------------------------------------------------------------------------------------- decoder kernels
+        // Single steps of the decoder (see `decode_at_current_rate`), exposed for benchmarking the kernels in isolation
+        // (`benchmarks_runtime/main_benchmark_kernels.cpp`). Message buffers are those of a `DecoderWorkspace`
+        // prepared by `prepare_workspace` (at the current rate).
+
+        /// same as computing the syndrome of `in` and comparing to `syndrome`, but stops at the first mismatch.
         template<typename BitL, typename BitR>
-        constexpr static bool xor_as_bools(BitL lhs, BitR rhs) {
-            return (static_cast<bool>(lhs) != static_cast<bool>(rhs));
+        bool syndrome_matches(const std::vector<BitL> &in, const std::vector<BitR> &syndrome) const {
+            for (std::size_t i{}; i < pos_varn.size(); ++i) {
+                bool parity = static_cast<bool>(syndrome[i]);
+                for (auto var_node: pos_varn[i]) {
+                    parity = xor_as_bools(parity, in[var_node]);
+                }
+                if (parity) {
+                    return false;
+                }
+            }
+            return true;
         }
 
-        template<typename Idx>
-        static Idx compute_n_cols(std::vector<std::vector<Idx>> mother_pos_varn) {
-            if (mother_pos_varn.empty()) {
-                return 0;
-            } else {
-                Idx result{};
-                for (const auto &v: mother_pos_varn) {
-                    auto current_max = *std::max_element(v.cbegin(), v.cend());
-                    result = std::max(result, current_max);
+        /// Number of rows of the (rate adapted) matrix whose parity check for `in` does not match `syndrome`.
+        template<typename BitL, typename BitR>
+        std::size_t n_unsatisfied_checks(const std::vector<BitL> &in, const std::vector<BitR> &syndrome) const {
+            std::size_t result{};
+            for (std::size_t i{}; i < pos_varn.size(); ++i) {
+                bool parity = static_cast<bool>(syndrome[i]);
+                for (auto var_node: pos_varn[i]) {
+                    parity = xor_as_bools(parity, in[var_node]);
                 }
-                return result + 1; // add one because indices in `mother_pos_varn` are zero-based.
+                result += parity;
             }
+            return result;
         }
 
         /*!
-         * compute `mother_pos_varn` from `colptr` and `rowIdx` for a given LDPC matrix stored in compressed sparse column
-         * format. "Values" array is omitted because all values are assumed to be 1 (binary LDPC matrix).
+         * One decimation round (see `DecoderConfig::decimation_rounds`): fixes the undecided bits with the largest
+         * total LLR magnitude to their current estimate, by setting their channel LLR in
+         * `workspace.decimated_llrs` to +-infinity. Messages of fixed bits are then bounded only by saturation.
          *
-         * @tparam idx_t unsigned integer type fitting number of columns N (thus also number of rows M)
-         * @tparam colptr_t unsigned integer type that fits ("number of non-zero matrix entries" + 1)
-         * @param colptr column pointer array for specifying mother parity check matrix.
-         * @param rowIdx row index array for specifying mother parity check matrix.
-         * @return Input variable nodes to each check node (of the Tanner graph)
+         * @param llrs: channel LLRs given to the decoder
+         * @param msg_c: messages from check nodes to variable nodes
+         * @param config: decoder settings (`decimation_fraction` is used)
+         * @param workspace: holds the decimation state, which is updated
          */
-        template <typename colptr_t>
-        static std::vector<std::vector<idx_t>> compute_mother_pos_varn(
-                const std::vector<colptr_t> &colptr,
-                const std::vector<idx_t> &rowIdx) {
-            // number of columns in full matrix represented by given compressed sparse column (CSC) storage
-            const auto nCols = colptr.size() - 1;
-            // number of rows in full matrix represented by given compressed sparse column (CSC) storage
-            const auto nMotherRows = *std::max_element(rowIdx.begin(), rowIdx.end()) + 1u;
+        void decimate(const std::vector<double> &llrs,
+                      const std::vector<std::vector<double>> &msg_c,
+                      const DecoderConfig &config,
+                      DecoderWorkspace &workspace) const {
+            auto &channel_llrs = workspace.decimated_llrs;
+            if (channel_llrs.empty()) {
+                channel_llrs = llrs;
+            }
 
-            std::vector<std::vector<idx_t>> pos_varn_tmp{nMotherRows, std::vector<idx_t>{}};
-            for (idx_t col = 0; col < nCols; col++) {
-                for (auto j = colptr[col]; j < colptr[col + 1u]; j++) {
-                    pos_varn_tmp[rowIdx[j]].push_back(col);
+            // undecided bits and their total LLRs
+            std::vector<std::pair<double, idx_t>> candidates;
+            candidates.reserve(n_cols);
+            for (std::size_t j{}; j < n_cols; ++j) {
+                if (!std::isinf(channel_llrs[j])) {
+                    const double total = std::accumulate(msg_c[j].begin(), msg_c[j].end(), channel_llrs[j]);
+                    candidates.emplace_back(total, static_cast<idx_t>(j));
                 }
             }
-            return pos_varn_tmp;
+
+            const auto n_fix = std::min(candidates.size(), std::max<std::size_t>(
+                    1, static_cast<std::size_t>(config.decimation_fraction * static_cast<double>(n_cols))));
+            const auto more_reliable = [](const auto &lhs, const auto &rhs) {
+                return std::abs(lhs.first) > std::abs(rhs.first);
+            };
+            std::nth_element(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(n_fix),
+                             candidates.end(), more_reliable);
+            for (std::size_t k{}; k < n_fix; ++k) {
+                const auto [total, j] = candidates[k];
+                channel_llrs[j] = (total < 0) ? -std::numeric_limits<double>::infinity()
+                                              : std::numeric_limits<double>::infinity();
+            }
+
+            workspace.n_decimation_rounds++;
+            workspace.min_n_unsatisfied_checks = std::numeric_limits<std::size_t>::max();
+            workspace.n_stalled_iterations = 0;
         }
 
+        /*!
+         * One restart (see `DecoderConfig::restarts`): perturbs the channel LLRs of the bits connected to checks
+         * that `in` does not satisfy, and re-initializes the messages of these bits (all other messages are kept).
+         * The perturbations are pseudo-random, determined by `config.restart_seed` and the number of the restart.
+         * Bits fixed by decimation are not perturbed.
+         *
+         * @param llrs: channel LLRs given to the decoder
+         * @param syndrome: syndrome given to the decoder
+         * @param in: current hard decision
+         * @param msg_v: messages from variable nodes to check nodes
+         * @param msg_c: messages from check nodes to variable nodes
+         * @param config: decoder settings (`restart_perturbation` and `restart_seed` are used)
+         * @param workspace: holds the restart state, which is updated
+         */
+        template<typename BitL, typename BitR>
+        void restart(const std::vector<double> &llrs,
+                     const std::vector<BitR> &syndrome,
+                     const std::vector<BitL> &in,
+                     std::vector<std::vector<double>> &msg_v,
+                     std::vector<std::vector<double>> &msg_c,
+                     const DecoderConfig &config,
+                     DecoderWorkspace &workspace) const {
+            const auto &unperturbed_llrs = workspace.decimated_llrs.empty() ? llrs : workspace.decimated_llrs;
+            auto &channel_llrs = workspace.perturbed_llrs;
+            channel_llrs = unperturbed_llrs;
+
+            // bits connected to unsatisfied checks
+            std::vector<bool> perturb(n_cols);
+            for (std::size_t m{}; m < pos_varn.size(); ++m) {
+                bool parity = static_cast<bool>(syndrome[m]);
+                for (auto var_node: pos_varn[m]) {
+                    parity = xor_as_bools(parity, in[var_node]);
+                }
+                if (parity) {
+                    for (auto var_node: pos_varn[m]) {
+                        perturb[var_node] = true;
+                    }
+                }
+            }
+
+            workspace.n_restarts++;
+            std::uint64_t rng_state = config.restart_seed + 0x9E3779B97F4A7C15u * workspace.n_restarts;
+            for (std::size_t j{}; j < n_cols; ++j) {
+                if (!perturb[j] || std::isinf(channel_llrs[j])) {
+                    continue;
+                }
+                const double u = 2 * next_uniform(rng_state) - 1;
+                channel_llrs[j] *= 1 + config.restart_perturbation * u;
+
+                for (std::size_t k{}; k < pos_checkn[j].size(); ++k) {
+                    msg_c[j][k] = 0;
+                    const auto &check_node_inputs = pos_varn[pos_checkn[j][k]];
+                    const auto pos = std::find(check_node_inputs.begin(), check_node_inputs.end(), j);
+                    msg_v[pos_checkn[j][k]][static_cast<std::size_t>(pos - check_node_inputs.begin())] =
+                            channel_llrs[j];
+                }
+            }
+
+            workspace.min_n_unsatisfied_checks = std::numeric_limits<std::size_t>::max();
+            workspace.n_stalled_iterations = 0;
+        }
+
+        /// Maximum total number of iterations of a decoding, given the restarts done so far.
+        static std::size_t iteration_limit(const DecoderConfig &config, const DecoderWorkspace &workspace) {
+            return config.max_num_iter + workspace.n_restarts * config.restart_max_iter;
+        }
+
+        /// Sum-product check node update: messages `msg_c` to variable nodes from messages `msg_v` to check nodes.
         template<typename Bit>
         void check_node_update(std::vector<std::vector<double>> &msg_c,
                                const std::vector<std::vector<double>> &msg_v,
-                               const std::vector<Bit> &syndrome) const {
-            double msg_part{};
+                               const std::vector<Bit> &syndrome,
+                               const double damping = 0) const {
             std::vector<idx_t> mc_position(n_cols);
 
             for (std::size_t m{}; m < n_ra_rows; ++m) {
-                // product of incoming messages
-                double mc_prod = 1 - 2 * static_cast<double>(syndrome[m]);
-                // Note: pos_varn[m].size() = check_node_degrees[m]
-                const auto curr_check_node_degree = pos_varn[m].size();
-                for (std::size_t k{}; k < curr_check_node_degree; ++k) {
-                    mc_prod *= ::tanh(0.5 * msg_v[m][k]);
-                }
-
-                for (std::size_t k{}; k < curr_check_node_degree; ++k) {
-                    // computing message from
-                    if (msg_v[m][k] == 0.) {  // TODO test this bit more carefully.
-                        LDPC4QKD_DEBUG_MESSAGE("Decoder went into the 'untested bit'!!");
-                        msg_part = 1;
-                        for (std::size_t non_k{}; non_k < curr_check_node_degree; ++non_k) {
-                            if (non_k != k) {
-                                msg_part *= ::tanh(0.5 * msg_v[m][k]);
-                            }
+                check_node_update_row(m, msg_v[m], static_cast<bool>(syndrome[m]), damping,
+                                      [&](std::size_t k) -> double & {
+                                          // place the message at the correct position in the output array
+                                          const idx_t curr_pos_varn = pos_varn[m][k];
+                                          return msg_c[curr_pos_varn][mc_position[curr_pos_varn]++];
+                                      });
+            }
+        }
+
+        /// Normalized min-sum approximation of `check_node_update`.
+        template<typename Bit>
+        void check_node_update_min_sum(std::vector<std::vector<double>> &msg_c,
+                                       const std::vector<std::vector<double>> &msg_v,
+                                       const std::vector<Bit> &syndrome,
+                                       const double normalization,
+                                       const double damping = 0) const {
+            std::vector<idx_t> mc_position(n_cols);
+
+            for (std::size_t m{}; m < n_ra_rows; ++m) {
+                check_node_update_row_min_sum(m, msg_v[m], static_cast<bool>(syndrome[m]), normalization, damping,
+                                              [&](std::size_t k) -> double & {
+                                                  const idx_t curr_pos_varn = pos_varn[m][k];
+                                                  return msg_c[curr_pos_varn][mc_position[curr_pos_varn]++];
+                                              });
+            }
+        }
+
+        /*!
+         * Sum-product update of the single check node `m` (see `check_node_update`).
+         * Rows are independent, so different rows may be updated concurrently (see `intra_frame_decoding.hpp`).
+         *
+         * @param msg_v_m messages from the variable nodes of row `m` to check node `m`
+         * @param msg_c_slot called once per edge `k = 0, 1, ...` of the row, in order. Returns a reference to the
+         *      message from check node `m` to variable node `pos_varn[m][k]`, which is overwritten.
+         */
+        template<typename SlotFn>
+        void check_node_update_row(const std::size_t m, const std::vector<double> &msg_v_m, const bool syndrome_bit,
+                                   const double damping, SlotFn &&msg_c_slot) const {
+            double msg_part{};
+
+            // product of incoming messages
+            double mc_prod = syndrome_bit ? -1. : 1.;
+            // Note: pos_varn[m].size() = check_node_degrees[m]
+            const auto curr_check_node_degree = pos_varn[m].size();
+            for (std::size_t k{}; k < curr_check_node_degree; ++k) {
+                mc_prod *= ::tanh(0.5 * msg_v_m[k]);
+            }
+
+            for (std::size_t k{}; k < curr_check_node_degree; ++k) {
+                // computing message from
+                if (msg_v_m[k] == 0.) {  // TODO test this bit more carefully.
+                    LDPC4QKD_DEBUG_MESSAGE("Decoder went into the 'untested bit'!!");
+                    msg_part = 1;
+                    for (std::size_t non_k{}; non_k < curr_check_node_degree; ++non_k) {
+                        if (non_k != k) {
+                            msg_part *= ::tanh(0.5 * msg_v_m[k]);
                         }
-                    } else {
-                        msg_part = mc_prod / ::tanh(0.5 * msg_v[m][k]);
                     }
+                } else {
+                    msg_part = mc_prod / ::tanh(0.5 * msg_v_m[k]);
+                }
 
-                    auto msg_final = ::log((1 + msg_part) / (1 - msg_part));
+                auto msg_final = ::log((1 + msg_part) / (1 - msg_part));
 
-                    // place the message at the correct position in the output array
-                    const idx_t curr_pos_varn = pos_varn[m][k];
-                    msg_c[curr_pos_varn][mc_position[curr_pos_varn]] = msg_final;
-                    mc_position[curr_pos_varn]++;
+                double &curr_msg = msg_c_slot(k);
+                curr_msg = damped(msg_final, curr_msg, damping);
+            }
+        }
+
+        /// Normalized min-sum approximation of `check_node_update_row`.
+        template<typename SlotFn>
+        void check_node_update_row_min_sum(const std::size_t m, const std::vector<double> &msg_v_m,
+                                           const bool syndrome_bit, const double normalization,
+                                           const double damping, SlotFn &&msg_c_slot) const {
+            const auto curr_check_node_degree = pos_varn[m].size();
+
+            // sign of the product of all incoming messages, as well as the two smallest incoming magnitudes
+            bool sign_negative = syndrome_bit;
+            double min1 = std::numeric_limits<double>::infinity();
+            double min2 = std::numeric_limits<double>::infinity();
+            std::size_t min1_idx{};
+            for (std::size_t k{}; k < curr_check_node_degree; ++k) {
+                const double v = msg_v_m[k];
+                sign_negative = sign_negative != (v < 0);
+                const double magnitude = std::abs(v);
+                if (magnitude < min1) {
+                    min2 = min1;
+                    min1 = magnitude;
+                    min1_idx = k;
+                } else if (magnitude < min2) {
+                    min2 = magnitude;
                 }
             }
+
+            for (std::size_t k{}; k < curr_check_node_degree; ++k) {
+                // exclude the message on the current edge from sign and magnitude
+                const bool curr_sign_negative = sign_negative != (msg_v_m[k] < 0);
+                const double magnitude = normalization * ((k == min1_idx) ? min2 : min1);
+                const double msg_final = curr_sign_negative ? -magnitude : magnitude;
+
+                double &curr_msg = msg_c_slot(k);
+                curr_msg = damped(msg_final, curr_msg, damping);
+            }
         }
 
+        /// Variable node update: messages `msg_v` to check nodes from channel `llrs` and messages `msg_c`.
         void var_node_update(std::vector<std::vector<double>> &msg_v,
                              const std::vector<std::vector<double>> &msg_c,
                              const std::vector<double> &llrs) const {
@@ -498,6 +1162,7 @@ namespace LDPC4QKD {
             }
         }
 
+        /// Bit estimates from channel `llrs` and messages `msg_c` (one if the total LLR is negative).
         template<typename Bit=bool>
         void hard_decision(
                 std::vector<Bit> &out,
@@ -512,6 +1177,7 @@ namespace LDPC4QKD {
             }
         }
 
+        /// Clamps all messages to the interval [-vsat, vsat].
         template<typename T>
         static void saturate(std::vector<std::vector<T>> &mv, const double vsat) {
             for (auto &v : mv) {
@@ -522,18 +1188,86 @@ namespace LDPC4QKD {
             }
         }
 
+    private:   // -------------------------------------------------------------------------------------- private members
+        template<typename BitL, typename BitR>
+        constexpr static bool xor_as_bools(BitL lhs, BitR rhs) {
+            return (static_cast<bool>(lhs) != static_cast<bool>(rhs));
+        }
+
+        template<typename Idx>
+        static Idx compute_n_cols(std::vector<std::vector<Idx>> mother_pos_varn) {
+            if (mother_pos_varn.empty()) {
+                return 0;
+            } else {
+                Idx result{};
+                for (const auto &v: mother_pos_varn) {
+                    auto current_max = *std::max_element(v.cbegin(), v.cend());
+                    result = std::max(result, current_max);
+                }
+                return result + 1; // add one because indices in `mother_pos_varn` are zero-based.
+            }
+        }
+
+        /*!
+         * compute `mother_pos_varn` from `colptr` and `rowIdx` for a given LDPC matrix stored in compressed sparse column
+         * format. "Values" array is omitted because all values are assumed to be 1 (binary LDPC matrix).
+         *
+         * @tparam idx_t unsigned integer type fitting number of columns N (thus also number of rows M)
+         * @tparam colptr_t unsigned integer type that fits ("number of non-zero matrix entries" + 1)
+         * @param colptr column pointer array for specifying mother parity check matrix.
+         * @param rowIdx row index array for specifying mother parity check matrix.
+         * @return Input variable nodes to each check node (of the Tanner graph)
+         */
+        template <typename colptr_t>
+        static std::vector<std::vector<idx_t>> compute_mother_pos_varn(
+                const std::vector<colptr_t> &colptr,
+                const std::vector<idx_t> &rowIdx) {
+            // number of columns in full matrix represented by given compressed sparse column (CSC) storage
+            const auto nCols = colptr.size() - 1;
+            // number of rows in full matrix represented by given compressed sparse column (CSC) storage
+            const auto nMotherRows = *std::max_element(rowIdx.begin(), rowIdx.end()) + 1u;
+
+            std::vector<std::vector<idx_t>> pos_varn_tmp{nMotherRows, std::vector<idx_t>{}};
+            for (idx_t col = 0; col < nCols; col++) {
+                for (auto j = colptr[col]; j < colptr[col + 1u]; j++) {
+                    pos_varn_tmp[rowIdx[j]].push_back(col);
+                }
+            }
+            return pos_varn_tmp;
+        }
+
+        /// Pseudo-random number uniform in [0, 1) (splitmix64), the same on all platforms.
+        static double next_uniform(std::uint64_t &state) {
+            std::uint64_t z = (state += 0x9E3779B97F4A7C15u);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9u;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBu;
+            z ^= z >> 31;
+            return static_cast<double>(z >> 11) * 0x1.0p-53;
+        }
+
+        /// Keeps fraction `damping` of the previous value of `msg` (damping is disabled for `damping == 0`).
+        static double damped(double new_msg, double old_msg, const double damping) {
+            return (damping == 0.) ? new_msg : (1 - damping) * new_msg + damping * old_msg;
+        }
+
         /*!
          * Recompute inner representation of rate adapted LDPC code (`pos_varn` and `pos_cn`),
          * starting from the mother code represented by `mother_pos_varn`.
-         * Note: this function "deals incorrectly" with variable node elimination during rate adaption.
-         * variable node elimination should not happen in the first place
+         * Columns contained in both combined rows cancel (addition over GF(2)), so variable nodes may lose edges.
          *
          * @param n_line_combs number of line combinations to perform for rate adaption.
          */
         void recompute_pos_vn_cn(std::size_t n_line_combs) {
-            if (rows_to_combine.size() < 2 * n_line_combs) {
-                throw std::runtime_error("Requested rate not supported. Not enough line combinations specified.");
+            recompute_pos_vn_cn(combinations_at_rate(n_line_combs));
+        }
+
+        /// Same as above, but performs the line combinations given by `combinations` (see `set_combinations`).
+        void recompute_pos_vn_cn(const std::vector<bool> &combinations) {
+            if (combinations.size() != rows_to_combine.size() / 2) {
+                throw std::runtime_error("Row combinations do not match the rate adaption of the code.");
             }
+            const auto n_line_combs = static_cast<std::size_t>(
+                    std::count(combinations.begin(), combinations.end(), true));
 
             {   // recompute pos_varn ---------------------------------------------------------------
                 // TODO check if this assumes full rank of H (should have that anyway)
@@ -552,8 +1286,12 @@ namespace LDPC4QKD {
                     // put results of combined lines at the back of the new LDPC code
                     const auto start_of_ra_part = n_mother_rows - 2 * n_line_combs;
 
-                    for (std::size_t i{}; i < n_line_combs; ++i) {
-                        auto &curr_varn_vec = pos_varn[start_of_ra_part + i];
+                    std::size_t k{};  // index of the combined row among the combined rows
+                    for (std::size_t i{}; i < combinations.size(); ++i) {
+                        if (!combinations[i]) {
+                            continue;
+                        }
+                        auto &curr_varn_vec = pos_varn[start_of_ra_part + k++];
                         curr_varn_vec.insert(curr_varn_vec.end(),
                                              pos_varn_nora[rows_to_combine[2 * i]].begin(),
                                              pos_varn_nora[rows_to_combine[2 * i]].end());
@@ -566,8 +1304,17 @@ namespace LDPC4QKD {
 
                         // TODO speed up this part by producing the rate adaption as unique positions and already sorted
                         std::sort(curr_varn_vec.begin(), curr_varn_vec.end());
-                        curr_varn_vec.erase(std::unique(curr_varn_vec.begin(), curr_varn_vec.end()),
-                                            curr_varn_vec.end());
+                        // Combining rows is addition over GF(2): columns contained in both rows cancel.
+                        // (This is what `encode_with_ra` computes by XORing the two syndrome bits.)
+                        auto out_it = curr_varn_vec.begin();
+                        for (auto it = curr_varn_vec.begin(); it != curr_varn_vec.end();) {
+                            if (std::next(it) != curr_varn_vec.end() && *it == *std::next(it)) {
+                                it += 2;
+                            } else {
+                                *out_it++ = *it++;
+                            }
+                        }
+                        curr_varn_vec.erase(out_it, curr_varn_vec.end());
                     }
 
                     std::size_t j{};
@@ -595,6 +1342,8 @@ namespace LDPC4QKD {
                     }
                 }
             }  // end recompute pos_checkn
+
+            applied_combinations = combinations;
         }
 
         // ---------------------------------------------------------------------------------------------- private fields
@@ -619,6 +1368,9 @@ namespace LDPC4QKD {
 
         /// current number of matrix rows (given current rate adaption).
         std::size_t n_ra_rows{};
+
+        /// row combinations performed by the current rate adaption (see `set_combinations`).
+        std::vector<bool> applied_combinations;
     };
 
 }
@@ -0,0 +1,74 @@
+//
+// Created by alice on 18.10.26.
+//
+// Reading and writing the rule of the finite alphabet iterative decoder (`faid_decoder.hpp`) as JSON.
+// Kept apart from `faid_decoder.hpp`, so that the decoder itself does not depend on the JSON library.
+
+#ifndef LDPC4QKD_READ_FAID_RULE_HPP
+#define LDPC4QKD_READ_FAID_RULE_HPP
+
+#include <fstream>
+#include <sstream>
+#include "external/json-6af826d/json.hpp"
+
+#include "faid_decoder.hpp"
+
+namespace LDPC4QKD {
+
+    /// Name of the `format` field in JSON files storing a `FaidRule`.
+    constexpr auto faid_rule_json_format = "LDPC4QKD_FAID_RULE";
+
+    /// Read the rule of the finite alphabet iterative decoder (usually tuned for a specific code) from a JSON file.
+    /// Settings that are not specified in the file keep their default value (see `FaidRule`).
+    /// Lookup tables are given as an object `vn_luts` mapping variable node degrees (as strings) to arrays.
+    inline FaidRule read_faid_rule_from_json(const std::string &file_path) {
+        try {
+            std::ifstream fs(file_path);
+            if (!fs) {
+                throw std::runtime_error("Stream object invalid.");
+            }
+
+            using json = nlohmann::json;
+            json data = json::parse(fs);
+
+            if (data.value("format", "") != faid_rule_json_format) {
+                throw std::runtime_error("Unexpected format within json file.");
+            }
+
+            FaidRule rule{};
+            rule.max_num_iter = data.value("max_num_iter", rule.max_num_iter);
+            rule.levels = data.value("levels", rule.levels);
+            rule.channel_weight = data.value("channel_weight", rule.channel_weight);
+            rule.thresholds = data.value("thresholds", rule.thresholds);
+            if (data.contains("vn_luts")) {
+                for (const auto &[degree, lut]: data["vn_luts"].items()) {
+                    rule.vn_luts[std::stoul(degree)] = lut.get<std::vector<int>>();
+                }
+            }
+            return rule;
+        }
+        catch (const std::exception &e) {
+            std::stringstream s;
+            s << "Failed to read FAID rule from file '" << file_path << "'. Reason:\n" << e.what() << "\n";
+            throw std::runtime_error(s.str());
+        }
+    }
+
+    /// Converts a FAID rule to JSON (readable by `read_faid_rule_from_json`).
+    inline nlohmann::json faid_rule_to_json(const FaidRule &rule) {
+        nlohmann::json vn_luts = nlohmann::json::object();
+        for (const auto &[degree, lut]: rule.vn_luts) {
+            vn_luts[std::to_string(degree)] = lut;
+        }
+        return nlohmann::json{
+                {"format", faid_rule_json_format},
+                {"max_num_iter", rule.max_num_iter},
+                {"levels", rule.levels},
+                {"channel_weight", rule.channel_weight},
+                {"thresholds", rule.thresholds},
+                {"vn_luts", vn_luts}
+        };
+    }
+}
+
+#endif //LDPC4QKD_READ_FAID_RULE_HPP
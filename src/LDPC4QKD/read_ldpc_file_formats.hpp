@@ -9,6 +9,8 @@
 #include <sstream>
 #include "external/json-6af826d/json.hpp"
 
+#include "rate_adaptive_code.hpp"
+
 namespace LDPC4QKD {
 
     namespace HelpersReadFilesLDPC {
@@ -137,6 +139,93 @@ namespace LDPC4QKD {
             throw std::runtime_error(s.str());
         }
     }
+
+
+    /// Name of the `format` field in JSON files storing a `DecoderConfig` (decoder profile).
+    constexpr auto decoder_config_json_format = "LDPC4QKD_DECODER_CONFIG";
+
+    /// Converts a `CheckNodeRule` to the name used in decoder profile files.
+    inline std::string check_node_rule_to_string(CheckNodeRule rule) {
+        switch (rule) {
+            case CheckNodeRule::sum_product:
+                return "sum_product";
+            case CheckNodeRule::normalized_min_sum:
+                return "normalized_min_sum";
+        }
+        throw std::domain_error("Unknown check node rule.");
+    }
+
+    /// Converts the name used in decoder profile files to a `CheckNodeRule`.
+    inline CheckNodeRule check_node_rule_from_string(const std::string &name) {
+        if (name == "sum_product") {
+            return CheckNodeRule::sum_product;
+        } else if (name == "normalized_min_sum") {
+            return CheckNodeRule::normalized_min_sum;
+        }
+        throw std::domain_error("Unknown check node rule '" + name + "'.");
+    }
+
+    /// Read decoder settings (decoder profile) from a JSON file, as written by the `decoder_autotune` program.
+    /// Settings that are not specified in the file keep their default value (see `DecoderConfig`).
+    /// Additional fields in the file (e.g. tuning results stored by `decoder_autotune`) are ignored.
+    inline DecoderConfig read_decoder_config_from_json(const std::string &file_path) {
+        try {
+            std::ifstream fs(file_path);
+            if (!fs) {
+                throw std::runtime_error("Stream object invalid.");
+            }
+
+            using json = nlohmann::json;
+            json data = json::parse(fs);
+
+            if (data.value("format", "") != decoder_config_json_format) {
+                throw std::runtime_error("Unexpected format within json file.");
+            }
+
+            DecoderConfig config{};
+            config.max_num_iter = data.value("max_num_iter", config.max_num_iter);
+            config.vsat = data.value("vsat", config.vsat);
+            config.check_node_rule = check_node_rule_from_string(
+                    data.value("check_node_rule", check_node_rule_to_string(config.check_node_rule)));
+            config.min_sum_normalization = data.value("min_sum_normalization", config.min_sum_normalization);
+            config.damping = data.value("damping", config.damping);
+            config.decimation_rounds = data.value("decimation_rounds", config.decimation_rounds);
+            config.decimation_stall_iterations = data.value(
+                    "decimation_stall_iterations", config.decimation_stall_iterations);
+            config.decimation_fraction = data.value("decimation_fraction", config.decimation_fraction);
+            config.restarts = data.value("restarts", config.restarts);
+            config.restart_stall_iterations = data.value("restart_stall_iterations", config.restart_stall_iterations);
+            config.restart_max_iter = data.value("restart_max_iter", config.restart_max_iter);
+            config.restart_perturbation = data.value("restart_perturbation", config.restart_perturbation);
+            config.restart_seed = data.value("restart_seed", config.restart_seed);
+            return config;
+        }
+        catch (const std::exception &e) {
+            std::stringstream s;
+            s << "Failed to read decoder settings from file '" << file_path << "'. Reason:\n" << e.what() << "\n";
+            throw std::runtime_error(s.str());
+        }
+    }
+
+    /// Converts decoder settings to JSON (readable by `read_decoder_config_from_json`).
+    inline nlohmann::json decoder_config_to_json(const DecoderConfig &config) {
+        return nlohmann::json{
+                {"format", decoder_config_json_format},
+                {"max_num_iter", config.max_num_iter},
+                {"vsat", config.vsat},
+                {"check_node_rule", check_node_rule_to_string(config.check_node_rule)},
+                {"min_sum_normalization", config.min_sum_normalization},
+                {"damping", config.damping},
+                {"decimation_rounds", config.decimation_rounds},
+                {"decimation_stall_iterations", config.decimation_stall_iterations},
+                {"decimation_fraction", config.decimation_fraction},
+                {"restarts", config.restarts},
+                {"restart_stall_iterations", config.restart_stall_iterations},
+                {"restart_max_iter", config.restart_max_iter},
+                {"restart_perturbation", config.restart_perturbation},
+                {"restart_seed", config.restart_seed}
+        };
+    }
 }
 
 #endif //LDPC4QKD_READ_LDPC_FILE_FORMATS_HPP
@@ -0,0 +1,392 @@
+//
+// Created by alice on 18.10.26.
+//
+// Alice's side of blind reconciliation (syndrome revealed in increments, one round trip per increment):
+// computing syndrome increments from the mother syndrome (in the order of the rate adaption, or for the row
+// combinations requested by Bob), and deciding how much syndrome to send up front
+// (`SyndromeProvisioningPolicy`), based on the outcomes that Bob reports for recent frames.
+
+#ifndef LDPC4QKD_SYNDROME_PROVISIONING_HPP
+#define LDPC4QKD_SYNDROME_PROVISIONING_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "rate_adaptive_code.hpp"
+
+
+namespace LDPC4QKD {
+
+    /*!
+     * Syndrome bits that Alice reveals to split the given row combinations (targeted revelation):
+     * the mother syndrome bit of the first row of each. Bob chooses the combinations, e.g. using
+     * `RateAdaptiveCode::rank_combinations_to_split`, and applies the bits using `apply_targeted_syndrome_increment`.
+     *
+     * @param code rate adaptive code (its current rate is not used)
+     * @param mother_syndrome syndrome of the mother matrix
+     * @param combinations indices of the row combinations to split
+     * @return revealed mother syndrome bits, in the order of `combinations`
+     */
+    template<typename idx_t, typename Bit>
+    std::vector<Bit> targeted_syndrome_increment(const RateAdaptiveCode<idx_t> &code,
+                                                 const std::vector<Bit> &mother_syndrome,
+                                                 const std::vector<std::size_t> &combinations) {
+        if (mother_syndrome.size() != code.get_n_rows_mother_matrix()) {
+            throw std::domain_error("Mother syndrome size does not match the number of rows of the mother matrix.");
+        }
+        const auto &rows_to_combine = code.get_rows_to_combine();
+        std::vector<Bit> increment;
+        increment.reserve(combinations.size());
+        for (auto i: combinations) {
+            if (i >= code.get_max_ra_steps()) {
+                throw std::domain_error("Requested row combination is not part of the rate adaption.");
+            }
+            increment.push_back(mother_syndrome[rows_to_combine[2 * i]]);
+        }
+        return increment;
+    }
+
+    /*!
+     * Bob's side of `targeted_syndrome_increment`: replaces `syndrome` (for the row combinations `applied`, see
+     * `RateAdaptiveCode::set_combinations`) by the syndrome after splitting `combinations`,
+     * and removes these from `applied`.
+     *
+     * @param code rate adaptive code (its current rate is not used)
+     * @param syndrome syndrome for the row combinations `applied`, replaced by the syndrome after the increment
+     * @param applied row combinations performed before the increment, updated
+     * @param combinations indices of the split row combinations (each must be in `applied`)
+     * @param increment bits computed by `targeted_syndrome_increment`
+     */
+    template<typename idx_t, typename Bit>
+    void apply_targeted_syndrome_increment(const RateAdaptiveCode<idx_t> &code,
+                                           std::vector<Bit> &syndrome,
+                                           std::vector<bool> &applied,
+                                           const std::vector<std::size_t> &combinations,
+                                           const std::vector<Bit> &increment) {
+        const auto n_mother_rows = code.get_n_rows_mother_matrix();
+        if (applied.size() != code.get_max_ra_steps() || increment.size() != combinations.size() ||
+            syndrome.size() != n_mother_rows - static_cast<std::size_t>(
+                    std::count(applied.begin(), applied.end(), true))) {
+            throw std::domain_error("Syndrome increment does not match the row combinations.");
+        }
+        std::vector<bool> split(applied.size());
+        for (auto i: combinations) {
+            if (i >= applied.size() || !applied[i] || split[i]) {
+                throw std::domain_error("Syndrome increment splits a row combination that is not performed.");
+            }
+            split[i] = true;
+        }
+
+        // Bob knows the XOR of the two rows of each row combination and the bits of all other rows.
+        // Storing the XOR in the first row of a combination (and zero in the second) gives the same rate adapted
+        // syndrome as the true mother syndrome.
+        const auto &rows_to_combine = code.get_rows_to_combine();
+        const auto ra_rows = code.mother_row_to_ra_row(applied);
+        std::vector<Bit> mother_syndrome(n_mother_rows);
+        for (std::size_t m{}; m < n_mother_rows; ++m) {
+            mother_syndrome[m] = syndrome[ra_rows[m]];
+        }
+        for (std::size_t i{}; i < applied.size(); ++i) {
+            if (applied[i]) {
+                mother_syndrome[rows_to_combine[2 * i + 1]] = 0;
+            }
+        }
+        for (std::size_t k{}; k < combinations.size(); ++k) {
+            const auto i = combinations[k];
+            applied[i] = false;
+            mother_syndrome[rows_to_combine[2 * i + 1]] = static_cast<Bit>(
+                    static_cast<bool>(mother_syndrome[rows_to_combine[2 * i]]) != static_cast<bool>(increment[k]));
+            mother_syndrome[rows_to_combine[2 * i]] = increment[k];
+        }
+        code.rate_adapt_syndrome(mother_syndrome, syndrome, applied);
+    }
+
+    /*!
+     * Syndrome bits that Alice reveals to increase the syndrome size from `syndrome_size` to `new_syndrome_size`:
+     * one mother syndrome bit (the first row) for each row combination that is undone.
+     * Together with the syndrome at the old rate, these give the syndrome at the new rate
+     * (see `apply_syndrome_increment`). The increment is cheap: the mother syndrome is computed once per frame
+     * (`RateAdaptiveCode::encode_no_ra`) and every increment only reads from it.
+     *
+     * @param code rate adaptive code (its current rate is not used)
+     * @param mother_syndrome syndrome of the mother matrix
+     * @param syndrome_size syndrome size known to Bob
+     * @param new_syndrome_size syndrome size after the increment (at least `syndrome_size`)
+     * @return revealed mother syndrome bits, in the order of the row combinations
+     */
+    template<typename idx_t, typename Bit>
+    std::vector<Bit> syndrome_increment(const RateAdaptiveCode<idx_t> &code,
+                                        const std::vector<Bit> &mother_syndrome,
+                                        const std::size_t syndrome_size,
+                                        const std::size_t new_syndrome_size) {
+        const auto n_mother_rows = code.get_n_rows_mother_matrix();
+        if (new_syndrome_size < syndrome_size || new_syndrome_size > n_mother_rows ||
+            syndrome_size < n_mother_rows - code.get_max_ra_steps()) {
+            throw std::domain_error("Requested syndrome increment is not supported by the rate adaption.");
+        }
+        std::vector<std::size_t> combinations(new_syndrome_size - syndrome_size);
+        std::iota(combinations.begin(), combinations.end(), n_mother_rows - new_syndrome_size);
+        return targeted_syndrome_increment(code, mother_syndrome, combinations);
+    }
+
+    /*!
+     * Bob's side of `syndrome_increment`: replaces `syndrome` by the syndrome at the rate with
+     * `increment.size()` fewer row combinations.
+     *
+     * @param code rate adaptive code (its current rate is not used)
+     * @param syndrome syndrome at the old rate, replaced by the syndrome at the new rate
+     * @param increment bits computed by `syndrome_increment`
+     */
+    template<typename idx_t, typename Bit>
+    void apply_syndrome_increment(const RateAdaptiveCode<idx_t> &code,
+                                  std::vector<Bit> &syndrome,
+                                  const std::vector<Bit> &increment) {
+        const auto n_mother_rows = code.get_n_rows_mother_matrix();
+        if (syndrome.size() < n_mother_rows - code.get_max_ra_steps() ||
+            syndrome.size() + increment.size() > n_mother_rows) {
+            throw std::domain_error("Syndrome increment is not supported by the rate adaption.");
+        }
+        const auto n_line_combs = n_mother_rows - syndrome.size();
+        auto applied = code.combinations_at_rate(n_line_combs);
+        std::vector<std::size_t> combinations(increment.size());
+        std::iota(combinations.begin(), combinations.end(), n_line_combs - increment.size());
+        apply_targeted_syndrome_increment(code, syndrome, applied, combinations, increment);
+    }
+
+
+    /// Settings of `SyndromeProvisioningPolicy`.
+    struct ProvisioningSettings {
+        /// Syndrome bits revealed by each additional round. The policy chooses initial sizes on this grid.
+        std::size_t increment = 64;
+
+        /// Duration of one round trip between Alice and Bob.
+        double round_trip_seconds = 0.01;
+
+        /// Bob's decoding time per iteration. Zero means that latency only counts round trips.
+        double seconds_per_iteration = 0;
+
+        /// Maximum expected number of syndrome bits per frame (must be positive). Without a budget, sending the
+        /// largest syndrome would always minimize latency.
+        double leak_budget = 0;
+
+        /// Weight of past reports is multiplied by this factor for each new report (one means no forgetting).
+        double forgetting_factor = 0.99;
+
+        /// Number of reports before the policy makes decisions. Until then, frames start at the smallest syndrome,
+        /// which reveals the exact rate at which each frame decodes.
+        std::size_t warmup_frames = 20;
+
+        /// Every n-th frame starts one increment below the decision, such that smaller syndrome sizes keep being
+        /// observed (zero disables exploration).
+        std::size_t exploration_period = 20;
+    };
+
+    /*!
+     * Decides how much syndrome Alice sends with each frame in blind reconciliation.
+     *
+     * Bob reports the outcome of each frame (`report`). From these, the policy estimates the probability that a frame
+     * decodes at each syndrome size (on the grid `min_syndrome_size + k * increment`), assuming that a frame that
+     * decodes at some size also decodes at all larger sizes. A frame starting at size `a` that decodes at size `c`
+     * tells that it fails at sizes `a, ..., c - increment` and succeeds at `c` and above.
+     *
+     * For each possible initial size, the policy computes the expected number of rounds, leaked bits and latency
+     * (rounds times round trip plus decoding time) and chooses the initial size with the lowest expected latency
+     * whose expected leak is within `ProvisioningSettings::leak_budget` (the smallest size if none is).
+     *
+     * Not thread-safe.
+     */
+    class SyndromeProvisioningPolicy {
+    public:
+        SyndromeProvisioningPolicy(std::size_t min_syndrome_size,
+                                   std::size_t max_syndrome_size,
+                                   ProvisioningSettings settings = {})
+                : min_syndrome_size(min_syndrome_size), max_syndrome_size(max_syndrome_size), settings(settings) {
+            if (settings.increment == 0) {
+                throw std::domain_error("Syndrome provisioning requires a positive increment.");
+            }
+            if (min_syndrome_size > max_syndrome_size) {
+                throw std::domain_error("Syndrome provisioning requires min_syndrome_size <= max_syndrome_size.");
+            }
+            if (!(settings.leak_budget > 0)) {
+                throw std::domain_error("Syndrome provisioning requires a positive leak budget.");
+            }
+            if (!(settings.forgetting_factor > 0 && settings.forgetting_factor <= 1)) {
+                throw std::domain_error("Syndrome provisioning requires a forgetting factor in (0, 1].");
+            }
+            const auto n_levels = (max_syndrome_size - min_syndrome_size + settings.increment - 1) / settings.increment;
+            n_tried.assign(n_levels + 1, 0);
+            n_succeeded.assign(n_levels + 1, 0);
+        }
+
+        /// All syndrome sizes supported by the rate adaption of `code`.
+        template<typename idx_t>
+        explicit SyndromeProvisioningPolicy(const RateAdaptiveCode<idx_t> &code, ProvisioningSettings settings = {})
+                : SyndromeProvisioningPolicy(code.get_n_rows_mother_matrix() - code.get_max_ra_steps(),
+                                             code.get_n_rows_mother_matrix(), settings) {}
+
+        /// Syndrome size to send with the next frame (see class description).
+        std::size_t next_syndrome_size() {
+            const auto frame_idx = n_decisions++;
+            if (n_reports < settings.warmup_frames) {
+                return min_syndrome_size;
+            }
+
+            const auto probabilities = success_probabilities();
+            std::size_t best_level{};
+            double best_latency = std::numeric_limits<double>::infinity();
+            for (std::size_t a{}; a < n_levels(); ++a) {
+                if (leak(probabilities, a) > settings.leak_budget) {
+                    break;  // the expected leak increases with the initial size
+                }
+                const double latency = latency_of_rounds(rounds(probabilities, a));
+                if (latency < best_latency * (1 - 1e-9)) {  // ties: smaller leak
+                    best_latency = latency;
+                    best_level = a;
+                }
+            }
+
+            if (settings.exploration_period != 0 && best_level > 0 && frame_idx % settings.exploration_period == 0) {
+                best_level--;
+            }
+            return syndrome_size(best_level);
+        }
+
+        /*!
+         * Bob's outcome of a frame.
+         *
+         * @param initial_syndrome_size size of the syndrome sent up front
+         * @param final_syndrome_size size of the syndrome when the decoding succeeded (or failed in the last round)
+         * @param success whether the frame was decoded
+         * @param n_iterations decoder iterations, summed over all rounds
+         * @param n_rounds number of decoding rounds
+         */
+        void report(std::size_t initial_syndrome_size,
+                    std::size_t final_syndrome_size,
+                    bool success,
+                    std::size_t n_iterations,
+                    std::size_t n_rounds) {
+            n_reports++;
+            for (std::size_t k{}; k < n_levels(); ++k) {
+                n_tried[k] *= settings.forgetting_factor;
+                n_succeeded[k] *= settings.forgetting_factor;
+            }
+            const auto first = level(initial_syndrome_size);
+            const auto last = level(final_syndrome_size);
+            for (std::size_t k = first; k < n_levels(); ++k) {
+                n_tried[k]++;
+                if (success && k >= last) {
+                    n_succeeded[k]++;
+                }
+            }
+
+            if (n_rounds > 0) {
+                const double iterations = static_cast<double>(n_iterations) / static_cast<double>(n_rounds);
+                iterations_weight = settings.forgetting_factor * iterations_weight + 1;
+                iterations_per_round += (iterations - iterations_per_round) / iterations_weight;
+            }
+        }
+
+        /// Estimated probability that a frame decodes with at most `syndrome_size` bits (non-decreasing).
+        [[nodiscard]] double success_probability(std::size_t syndrome_size) const {
+            return success_probabilities()[level(syndrome_size)];
+        }
+
+        /// Expected number of rounds for a frame starting at `initial_syndrome_size`.
+        [[nodiscard]] double expected_rounds(std::size_t initial_syndrome_size) const {
+            return rounds(success_probabilities(), level(initial_syndrome_size));
+        }
+
+        /// Expected number of syndrome bits revealed for a frame starting at `initial_syndrome_size`.
+        [[nodiscard]] double expected_leak(std::size_t initial_syndrome_size) const {
+            return leak(success_probabilities(), level(initial_syndrome_size));
+        }
+
+        /// Expected time from sending the syndrome until Bob's result, for a frame starting at `initial_syndrome_size`.
+        [[nodiscard]] double expected_latency(std::size_t initial_syndrome_size) const {
+            return latency_of_rounds(expected_rounds(initial_syndrome_size));
+        }
+
+        [[nodiscard]] const ProvisioningSettings &get_settings() const {
+            return settings;
+        }
+
+    private:
+        [[nodiscard]] std::size_t n_levels() const {
+            return n_tried.size();
+        }
+
+        /// Syndrome size of grid level `k`.
+        [[nodiscard]] std::size_t syndrome_size(std::size_t k) const {
+            return std::min(max_syndrome_size, min_syndrome_size + k * settings.increment);
+        }
+
+        /// Smallest grid level with at least `size` syndrome bits.
+        [[nodiscard]] std::size_t level(std::size_t size) const {
+            if (size < min_syndrome_size || size > max_syndrome_size) {
+                throw std::domain_error("Syndrome size outside of the range of the provisioning policy.");
+            }
+            return (size - min_syndrome_size + settings.increment - 1) / settings.increment;
+        }
+
+        /// Estimated success probability at each grid level, made non-decreasing.
+        [[nodiscard]] std::vector<double> success_probabilities() const {
+            std::vector<double> result(n_levels());
+            double running_max{};
+            for (std::size_t k{}; k < n_levels(); ++k) {
+                // pseudo-count of half a frame with probability one half, for levels without reports
+                running_max = std::max(running_max, (n_succeeded[k] + 0.25) / (n_tried[k] + 0.5));
+                result[k] = running_max;
+            }
+            return result;
+        }
+
+        /// Expectation of `value(final_level)` for a frame starting at grid level `first`.
+        /// Frames that do not decode at the largest size end there.
+        template<typename Value>
+        [[nodiscard]] double expectation(const std::vector<double> &probabilities, std::size_t first,
+                                         Value value) const {
+            double result{};
+            double previous_probability{};
+            for (std::size_t k = first; k < n_levels(); ++k) {
+                result += (probabilities[k] - previous_probability) * value(k);
+                previous_probability = probabilities[k];
+            }
+            return result + (1 - previous_probability) * value(n_levels() - 1);
+        }
+
+        [[nodiscard]] double rounds(const std::vector<double> &probabilities, std::size_t first) const {
+            return expectation(probabilities, first, [first](std::size_t final_level) {
+                return static_cast<double>(final_level - first + 1);
+            });
+        }
+
+        [[nodiscard]] double leak(const std::vector<double> &probabilities, std::size_t first) const {
+            return expectation(probabilities, first, [this](std::size_t final_level) {
+                return static_cast<double>(syndrome_size(final_level));
+            });
+        }
+
+        [[nodiscard]] double latency_of_rounds(double n_rounds) const {
+            return n_rounds * (settings.round_trip_seconds + iterations_per_round * settings.seconds_per_iteration);
+        }
+
+        const std::size_t min_syndrome_size;
+        const std::size_t max_syndrome_size;
+        const ProvisioningSettings settings;
+
+        std::vector<double> n_tried;  // per grid level, weighted by forgetting
+        std::vector<double> n_succeeded;
+        double iterations_per_round{};  // weighted average over reports
+        double iterations_weight{};
+        std::size_t n_decisions{};
+        std::size_t n_reports{};
+    };
+
+}
+
+#endif //LDPC4QKD_SYNDROME_PROVISIONING_HPP
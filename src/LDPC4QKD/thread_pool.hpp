@@ -0,0 +1,143 @@
+//
+// Created by alice on 18.10.26.
+//
+// Fixed size thread pool used by the decoding infrastructure (`DecodingService`) and the command line tools.
+// Tasks are submitted as callables and their results are obtained through `std::future`s.
+
+#ifndef LDPC4QKD_THREAD_POOL_HPP
+#define LDPC4QKD_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+namespace LDPC4QKD {
+
+    /// Priority classes of `ThreadPool` tasks. Workers always start a queued task of the highest class first.
+    enum class TaskPriority {
+        high,  /// e.g. latency-sensitive small frames
+        normal,
+        low  /// e.g. background work
+    };
+
+    /*!
+     * Thread pool with a fixed number of worker threads and one FIFO task queue per priority class.
+     *
+     * A task is only started when no task of a higher priority class is queued. Running tasks are never interrupted,
+     * so long tasks should be split into shorter ones (as done by `DecodingService` for time-sliced decoding).
+     * Exceptions thrown by a task are stored in the future returned by `submit`.
+     * The destructor finishes all queued tasks before joining the workers.
+     */
+    class ThreadPool {
+    public:
+        /// @param n_threads number of worker threads. Zero means one thread per hardware thread.
+        explicit ThreadPool(std::size_t n_threads = 0) {
+            if (n_threads == 0) {
+                n_threads = std::max(1u, std::thread::hardware_concurrency());
+            }
+            workers.reserve(n_threads);
+            for (std::size_t i{}; i < n_threads; ++i) {
+                workers.emplace_back([this]() { worker_loop(); });
+            }
+        }
+
+        ThreadPool(const ThreadPool &) = delete;
+
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            cv.notify_all();
+            for (auto &w: workers) {
+                w.join();
+            }
+        }
+
+        /// Queue `f` for execution on one of the worker threads.
+        /// @return future holding the return value of `f` (or the exception it threw)
+        template<typename F>
+        auto submit(F &&f, TaskPriority priority = TaskPriority::normal)
+        -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+            using R = std::invoke_result_t<std::decay_t<F>>;
+            // `std::function` requires copyable callables, hence the `shared_ptr`.
+            auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+            auto result = task->get_future();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (stopping) {
+                    throw std::runtime_error("ThreadPool: cannot submit tasks to a stopping pool.");
+                }
+                tasks[static_cast<std::size_t>(priority)].emplace([task]() { (*task)(); });
+            }
+            cv.notify_one();
+            return result;
+        }
+
+        [[nodiscard]] std::size_t size() const {
+            return workers.size();
+        }
+
+        /// Number of tasks (of all priority classes) that are queued but not yet started.
+        [[nodiscard]] std::size_t queue_size() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::size_t n{};
+            for (const auto &queue: tasks) {
+                n += queue.size();
+            }
+            return n;
+        }
+
+        /// Number of workers that are not running a task at the moment (e.g. to decide whether a task should use
+        /// several workers, see `decode_intra_frame`).
+        [[nodiscard]] std::size_t n_idle() const {
+            return workers.size() - std::min(workers.size(), n_running.load());
+        }
+
+    private:
+        void worker_loop() {
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    auto next_queue = [this]() {
+                        return std::find_if(tasks.begin(), tasks.end(), [](const auto &q) { return !q.empty(); });
+                    };
+                    cv.wait(lock, [this, &next_queue]() { return stopping || next_queue() != tasks.end(); });
+                    const auto queue = next_queue();
+                    if (queue == tasks.end()) {
+                        return;  // stopping and nothing left to do
+                    }
+                    task = std::move(queue->front());
+                    queue->pop();
+                    ++n_running;
+                }
+                task();
+                --n_running;
+            }
+        }
+
+        std::vector<std::thread> workers;
+        std::array<std::queue<std::function<void()>>, 3> tasks;  // one queue per `TaskPriority`
+        mutable std::mutex mutex;
+        std::condition_variable cv;
+        std::atomic<std::size_t> n_running{};  // workers running a task
+        bool stopping = false;
+    };
+
+}
+
+#endif //LDPC4QKD_THREAD_POOL_HPP
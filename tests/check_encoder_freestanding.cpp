@@ -0,0 +1,64 @@
+//
+// Created by alice on 18.10.26.
+// This is built as a stand-alone application without exceptions and RTTI (see `CMakeLists.txt`).
+// It checks that `encoder_freestanding.hpp` works in this setting, without any use of the heap or iostreams.
+// Returns zero on success.
+//
+
+#include <array>
+#include <cstdint>
+
+#include "LDPC4QKD/encoder_freestanding.hpp"
+#include "LDPC4QKD/autogen/rate_adaption_2x4_block_4096.hpp"
+
+namespace FS = LDPC4QKD::Freestanding;
+
+namespace {
+    constexpr auto &encoder = FS::encoder_2048x4096_0c809c3;
+    constexpr FS::RateAdaption rate_adaption{AutogenRateAdapt_2x4_block_4096::rows};
+    static_assert(encoder.is_valid(rate_adaption));
+
+    // static buffers (no heap)
+    std::array<std::uint8_t, encoder.inputSize> key{};
+    std::array<std::uint8_t, encoder.outputSize> syndrome{};
+    std::array<std::uint8_t, encoder.outputSize> syndrome_ra{};
+    std::array<std::uint8_t, encoder.outputSize> scratch{};
+}
+
+int main() {
+    // deterministic pseudo-random key (linear congruential generator)
+    std::uint32_t state = 12345;
+    for (auto &k: key) {
+        state = 1664525u * state + 1013904223u;
+        k = static_cast<std::uint8_t>(state >> 31);
+    }
+
+    if (encoder.encode(key, syndrome) != FS::EncoderStatus::ok) {
+        return 1;
+    }
+
+    // without row combinations, rate adapted encoding is the same as normal encoding
+    if (encoder.encode_with_ra(rate_adaption, key, syndrome_ra, scratch) != FS::EncoderStatus::ok
+        || syndrome_ra != syndrome) {
+        return 2;
+    }
+
+    // a combined row is the XOR of two mother rows.
+    constexpr std::size_t n_combinations = 10;
+    const std::span<std::uint8_t> syndrome_short{syndrome_ra.data(), encoder.outputSize - n_combinations};
+    if (encoder.encode_with_ra(rate_adaption, key, syndrome_short, scratch) != FS::EncoderStatus::ok) {
+        return 3;
+    }
+    for (std::size_t i{}; i < n_combinations; ++i) {
+        const auto expected = syndrome[rate_adaption.rows[2 * i]] != syndrome[rate_adaption.rows[2 * i + 1]];
+        if ((syndrome_short[syndrome_short.size() - n_combinations + i] != 0) != expected) {
+            return 4;
+        }
+    }
+
+    // invalid sizes are reported, not thrown
+    if (encoder.encode(std::span<const std::uint8_t>{key}.first(10), syndrome) != FS::EncoderStatus::invalid_key_size) {
+        return 5;
+    }
+    return 0;
+}
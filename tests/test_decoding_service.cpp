@@ -0,0 +1,555 @@
+//
+// Created by alice on 18.10.26.
+//
+
+// Google Test framework
+#include <gtest/gtest.h>
+#include "helpers_for_testing.hpp"
+
+// Standard library
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <numeric>
+#include <iostream>
+
+// To be tested
+#include "LDPC4QKD/thread_pool.hpp"
+#include "LDPC4QKD/code_registry.hpp"
+#include "LDPC4QKD/decoding_service.hpp"
+#include "LDPC4QKD/intra_frame_decoding.hpp"
+#include "LDPC4QKD/pipelined_decoding.hpp"
+#include "LDPC4QKD/embedded_codes.hpp"
+
+// Test cases test against constants known to be correct for the LDPC-matrix defined here:
+#include "fortest_autogen_ldpc_matrix_csc.hpp"
+#include "fortest_autogen_rate_adaption.hpp"
+
+using namespace HelpersForTests;
+using namespace LDPC4QKD;
+
+namespace {
+
+    auto get_code_big_wra() {
+        std::vector<std::uint32_t> colptr(AutogenLDPC::colptr.begin(), AutogenLDPC::colptr.end());
+        std::vector<std::uint32_t> row_idx(AutogenLDPC::row_idx.begin(), AutogenLDPC::row_idx.end());
+        std::vector<std::uint32_t> rows_to_combine(AutogenRateAdapt::rows.begin(), AutogenRateAdapt::rows.end());
+        return RateAdaptiveCode<std::uint32_t>(colptr, row_idx, rows_to_combine);
+    }
+
+}
+
+TEST(thread_pool, runs_all_tasks_and_returns_results) {
+    ThreadPool pool(3);
+    EXPECT_EQ(pool.size(), 3);
+
+    std::vector<std::future<std::size_t>> results;
+    for (std::size_t i{}; i < 100; ++i) {
+        results.push_back(pool.submit([i]() { return i * i; }));
+    }
+    for (std::size_t i{}; i < results.size(); ++i) {
+        EXPECT_EQ(results[i].get(), i * i);
+    }
+}
+
+TEST(thread_pool, exception_is_stored_in_future) {
+    ThreadPool pool(1);
+    auto result = pool.submit([]() -> int { throw std::runtime_error("task failed"); });
+    EXPECT_THROW(result.get(), std::runtime_error);
+
+    // the worker survives the exception
+    EXPECT_EQ(pool.submit([]() { return 42; }).get(), 42);
+}
+
+TEST(thread_pool, higher_priority_tasks_start_first) {
+    ThreadPool pool(1);
+
+    // block the only worker, so that all following tasks are queued.
+    std::promise<void> worker_blocked;
+    std::promise<void> release_worker;
+    auto blocked = pool.submit([&worker_blocked, released = release_worker.get_future()]() {
+        worker_blocked.set_value();
+        released.wait();
+    });
+    worker_blocked.get_future().wait();
+
+    std::mutex order_mutex;
+    std::vector<int> order;
+    auto record = [&](int value) {
+        return [&, value]() {
+            std::lock_guard<std::mutex> lock(order_mutex);
+            order.push_back(value);
+        };
+    };
+    std::vector<std::future<void>> results;
+    results.push_back(pool.submit(record(3), TaskPriority::low));
+    results.push_back(pool.submit(record(2)));
+    results.push_back(pool.submit(record(1), TaskPriority::high));
+    results.push_back(pool.submit(record(2)));
+    results.push_back(pool.submit(record(1), TaskPriority::high));
+    EXPECT_EQ(pool.queue_size(), 5);
+
+    release_worker.set_value();
+    for (auto &r: results) {
+        r.get();
+    }
+    EXPECT_EQ(order, (std::vector<int>{1, 1, 2, 2, 3}));
+}
+
+TEST(code_registry, builds_each_code_once) {
+    CodeRegistry<std::uint32_t> registry;
+    std::atomic<int> n_builds{0};
+    const auto code_id = registry.add_code("fortest", [&n_builds]() {
+        n_builds++;
+        return get_code_big_wra();
+    });
+    EXPECT_EQ(code_id, 0);
+    EXPECT_EQ(registry.size(), 1);
+    EXPECT_EQ(registry.get_name(code_id), "fortest");
+    EXPECT_EQ(n_builds, 0);  // codes are built on first use
+
+    auto mother = registry.get_mother_code(code_id);
+    auto rate_adapted = registry.get(code_id, 100);
+    EXPECT_EQ(rate_adapted, registry.get(code_id, 100));  // cached
+    EXPECT_EQ(rate_adapted, registry.get_for_syndrome_size(code_id, mother->get_n_rows_mother_matrix() - 100));
+    EXPECT_EQ(mother, registry.get(code_id, 0));
+    EXPECT_EQ(n_builds, 1);
+
+    auto expected = get_code_big_wra();
+    EXPECT_TRUE(*mother == expected);
+    expected.set_rate(100);
+    EXPECT_TRUE(*rate_adapted == expected);
+
+    EXPECT_ANY_THROW(registry.get(code_id, mother->get_max_ra_steps() + 1));
+    EXPECT_ANY_THROW(registry.get_mother_code(code_id + 1));
+}
+
+TEST(code_registry, concurrent_requests_build_once) {
+    CodeRegistry<std::uint32_t> registry;
+    std::atomic<int> n_builds{0};
+    registry.add_code("fortest", [&n_builds]() {
+        n_builds++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        return get_code_big_wra();
+    });
+
+    ThreadPool pool(4);
+    std::vector<std::future<std::shared_ptr<const RateAdaptiveCode<std::uint32_t>>>> results;
+    for (std::size_t i{}; i < 8; ++i) {
+        results.push_back(pool.submit([&registry, i]() { return registry.get(0, i % 2); }));
+    }
+    for (std::size_t i{}; i < results.size(); ++i) {
+        EXPECT_EQ(results[i].get(), registry.get(0, i % 2));
+    }
+    EXPECT_EQ(n_builds, 1);
+}
+
+TEST(code_registry, preload_codes_rates_and_workspaces) {
+    CodeRegistry<std::uint32_t> registry;
+    std::atomic<int> n_builds{0};
+    for (std::size_t size_hint: {std::size_t{2}, std::size_t{1}}) {
+        registry.add_code("fortest", [&n_builds]() {
+            n_builds++;
+            return get_code_big_wra();
+        }, size_hint);
+    }
+    const std::size_t n_rows = get_code_big_wra().get_n_rows_mother_matrix();
+
+    ThreadPool pool(2);
+    PreloadOptions options;
+    options.rates = {{1, n_rows - 100}, {1, n_rows - 200}};
+    options.workspaces_per_rate = 3;
+    auto preloading = registry.preload(pool, options);
+    EXPECT_EQ(preloading.size(), 4);
+    for (auto &f: preloading) {
+        f.get();
+    }
+
+    EXPECT_EQ(n_builds, 2);
+    EXPECT_TRUE(registry.is_ready(0));
+    EXPECT_TRUE(registry.is_ready(1, 100));
+    EXPECT_TRUE(registry.is_ready(1, 200));
+    EXPECT_FALSE(registry.is_ready(0, 100));
+    EXPECT_EQ(registry.get_workspace_pool(1, 100).n_available(), 3);
+
+    {
+        auto workspace = registry.get_workspace_pool(1, 100).acquire();
+        EXPECT_EQ(registry.get_workspace_pool(1, 100).n_available(), 2);
+        EXPECT_EQ(workspace->msg_v.size(), n_rows - 100);
+    }
+    EXPECT_EQ(registry.get_workspace_pool(1, 100).n_available(), 3);
+
+    // failures are reported through the futures
+    options.rates = {{0, n_rows + 1}};
+    EXPECT_ANY_THROW(registry.preload(pool, options).back().get());
+}
+
+TEST(code_registry, preload_large_codes_at_low_priority) {
+    CodeRegistry<std::uint32_t> registry;
+    for (std::size_t size_hint: {std::size_t{1} << 20, std::size_t{1}}) {
+        registry.add_code("fortest", get_code_big_wra, size_hint);
+    }
+    const std::size_t n_rows = get_code_big_wra().get_n_rows_mother_matrix();
+
+    ThreadPool pool(1);
+    std::promise<void> release_worker;
+    auto blocked = pool.submit([f = release_worker.get_future()]() mutable { f.wait(); });
+    PreloadOptions options;
+    options.rates = {{1, n_rows - 100}};
+    auto preloading = registry.preload(pool, options);
+    // queued after the build of the small code, but before the build of the large code
+    auto in_between = pool.submit([&registry]() {
+        return std::make_pair(registry.is_ready(0), registry.is_ready(1));
+    });
+    release_worker.set_value();
+
+    const auto [large_ready, small_ready] = in_between.get();
+    EXPECT_FALSE(large_ready);
+    EXPECT_TRUE(small_ready);
+    for (auto &f: preloading) {
+        f.get();
+    }
+    EXPECT_TRUE(registry.is_ready(0));
+    EXPECT_TRUE(registry.is_ready(1, 100));
+}
+
+TEST(code_registry, reused_workspace_gives_same_result) {
+    auto H = get_code_big_wra();
+    DecoderWorkspace workspace;
+    std::mt19937_64 rng(11);
+
+    for (std::size_t n_line_combs: {std::size_t{0}, std::size_t{300}, std::size_t{0}}) {
+        H.set_rate(n_line_combs);
+        std::vector<std::uint8_t> key(H.getNCols());
+        noise_bitstring_inplace(rng, key, 0.5);
+        std::vector<std::uint8_t> syndrome;
+        H.encode_at_current_rate(key, syndrome);
+        auto noisy_key = key;
+        noise_bitstring_inplace(rng, noisy_key, 0.03);
+        const auto llrs = llrs_bsc(noisy_key, 0.03);
+
+        std::vector<std::uint8_t> expected;
+        std::vector<std::uint8_t> out;
+        const bool expected_success = H.decode_at_current_rate(llrs, syndrome, expected, DecoderConfig{});
+        EXPECT_EQ(H.decode_at_current_rate(llrs, syndrome, out, DecoderConfig{}, workspace), expected_success);
+        EXPECT_EQ(out, expected);
+    }
+}
+
+TEST(embedded_codes, same_as_code_from_colptr_rowIdx) {
+    EXPECT_EQ(n_embedded_codes, std::tuple_size_v<decltype(all_encoders_tuple)>);
+    EXPECT_EQ(get_embedded_code_name(0), "embedded_2048x6144");
+
+    // rate adaption of the embedded code is the same as the one used for testing.
+    auto H = get_embedded_code(0);
+    EXPECT_TRUE(H == get_code_big_wra());
+
+    // smallest index type that fits is accepted, too small index type is not.
+    EXPECT_EQ(get_embedded_code<std::uint16_t>(3).getNCols(), 4096);
+    EXPECT_ANY_THROW(get_embedded_code<std::uint16_t>(2));
+    EXPECT_ANY_THROW(get_embedded_code(n_embedded_codes));
+}
+
+TEST(decoding_service, decode_frames_at_several_rates) {
+    CodeRegistry<std::uint32_t> registry;
+    add_embedded_codes(registry);
+    EXPECT_EQ(registry.size(), n_embedded_codes);
+
+    ThreadPool pool(4);
+    DecodingService<std::uint32_t> service(registry, pool);
+
+    constexpr std::size_t code_id = 0;
+    const auto H = registry.get_mother_code(code_id);
+    constexpr double p = 0.02;
+    std::mt19937_64 rng(7);
+
+    std::vector<std::vector<std::uint8_t>> keys;
+    std::vector<std::future<DecodingResult>> results;
+    for (std::size_t frame_idx{}; frame_idx < 12; ++frame_idx) {
+        std::vector<std::uint8_t> key(H->getNCols());
+        noise_bitstring_inplace(rng, key, 0.5);
+
+        // every frame uses a different rate.
+        std::vector<std::uint8_t> syndrome;
+        H->encode_with_ra(key, syndrome, H->get_n_rows_mother_matrix() - 10 * frame_idx);
+
+        std::vector<std::uint8_t> noisy_key = key;
+        noise_bitstring_inplace(rng, noisy_key, p);
+
+        keys.push_back(key);
+        results.push_back(service.submit(code_id, llrs_bsc(noisy_key, p), syndrome));
+    }
+
+    for (std::size_t frame_idx{}; frame_idx < results.size(); ++frame_idx) {
+        auto result = results[frame_idx].get();
+        EXPECT_TRUE(result.success);
+        EXPECT_EQ(result.key, keys[frame_idx]);
+        EXPECT_GE(result.decoding_seconds, 0);
+    }
+
+    // Invalid code_id is reported through the future
+    EXPECT_ANY_THROW(service.submit(n_embedded_codes, {}, {}).get());
+}
+
+TEST(decoding_service, time_sliced_same_as_not_sliced) {
+    CodeRegistry<std::uint32_t> registry;
+    add_embedded_codes(registry);
+
+    ThreadPool pool(2);
+    DecodingSchedule schedule{};
+    schedule.iterations_per_slice = 2;
+    schedule.high_priority_max_frame_size = 4096;
+    DecodingService<std::uint32_t> sliced(registry, pool, {}, schedule);
+    DecodingService<std::uint32_t> not_sliced(registry, pool);
+
+    std::mt19937_64 rng(3);
+    std::vector<std::future<DecodingResult>> results;
+    std::vector<DecodingResult> expected;
+    // frames of code 0 (6144 bits) and high priority frames of code 3 (4096 bits), some of which fail.
+    for (std::size_t frame_idx{}; frame_idx < 8; ++frame_idx) {
+        const std::size_t code_id = (frame_idx % 2 == 0) ? 0 : 3;
+        const double p = (frame_idx % 4 == 3) ? 0.2 : 0.02;
+        const auto H = registry.get_mother_code(code_id);
+
+        std::vector<std::uint8_t> key(H->getNCols());
+        noise_bitstring_inplace(rng, key, 0.5);
+        std::vector<std::uint8_t> syndrome;
+        H->encode_no_ra(key, syndrome);
+        std::vector<std::uint8_t> noisy_key = key;
+        noise_bitstring_inplace(rng, noisy_key, p);
+        const auto llrs = llrs_bsc(noisy_key, p);
+
+        expected.push_back(not_sliced.decode(code_id, llrs, syndrome, DecoderConfig{}));
+        EXPECT_EQ(expected.back().success, p < 0.1);
+        results.push_back(sliced.submit(code_id, llrs, syndrome));
+    }
+
+    for (std::size_t frame_idx{}; frame_idx < results.size(); ++frame_idx) {
+        auto result = results[frame_idx].get();
+        EXPECT_EQ(result.success, expected[frame_idx].success);
+        EXPECT_EQ(result.key, expected[frame_idx].key);
+    }
+
+    // Invalid code_id is reported through the future
+    EXPECT_ANY_THROW(sliced.submit(n_embedded_codes, {}, {}).get());
+}
+
+TEST(decoding_service, high_priority_frame_overtakes_sliced_frame) {
+    CodeRegistry<std::uint32_t> registry;
+    add_embedded_codes(registry);
+
+    ThreadPool pool(1);
+    DecodingSchedule schedule{};
+    schedule.iterations_per_slice = 2;
+    schedule.high_priority_max_frame_size = 4096;
+    DecoderConfig config{};
+    config.max_num_iter = 300;
+    DecodingService<std::uint32_t> service(registry, pool, config, schedule);
+
+    std::mt19937_64 rng(5);
+    auto make_frame = [&](std::size_t code_id, double p) {
+        const auto H = registry.get_mother_code(code_id);
+        std::vector<std::uint8_t> key(H->getNCols());
+        noise_bitstring_inplace(rng, key, 0.5);
+        std::vector<std::uint8_t> syndrome;
+        H->encode_no_ra(key, syndrome);
+        noise_bitstring_inplace(rng, key, p);
+        return std::make_pair(llrs_bsc(key, p), syndrome);
+    };
+
+    // a frame of code 0 (6144 bits) that runs all iterations, followed by a high priority frame of code 3 (4096 bits)
+    auto [large_llrs, large_syndrome] = make_frame(0, 0.2);
+    auto [small_llrs, small_syndrome] = make_frame(3, 0.02);
+    auto large = service.submit(0, std::move(large_llrs), std::move(large_syndrome));
+    auto small = service.submit(3, std::move(small_llrs), std::move(small_syndrome));
+
+    // the only worker yields the large frame after a slice and decodes the small frame first
+    EXPECT_TRUE(small.get().success);
+    EXPECT_EQ(large.wait_for(std::chrono::seconds(0)), std::future_status::timeout);
+    EXPECT_FALSE(large.get().success);
+}
+
+TEST(intra_frame_decoding, same_as_sequential) {
+    auto H = get_code_big_wra();
+    ThreadPool pool(3);
+    DecoderWorkspace workspace;
+    std::mt19937_64 rng(5);
+
+    DecoderConfig sum_product{};
+    sum_product.max_num_iter = 20;
+    DecoderConfig min_sum = sum_product;
+    min_sum.check_node_rule = CheckNodeRule::normalized_min_sum;
+    min_sum.damping = 0.2;
+    for (const auto &config: {sum_product, min_sum}) {
+        for (std::size_t n_line_combs: {0u, 300u}) {
+            H.set_rate(n_line_combs);
+            const EdgeSlots<std::uint32_t> slots(H);
+            for (const double p: {0.02, 0.1}) {  // the second frame fails
+                std::vector<std::uint8_t> key(H.getNCols());
+                noise_bitstring_inplace(rng, key, 0.5);
+                std::vector<std::uint8_t> syndrome;
+                H.encode_at_current_rate(key, syndrome);
+                noise_bitstring_inplace(rng, key, p);
+                const auto llrs = llrs_bsc(key, p);
+
+                std::vector<std::uint8_t> expected;
+                const bool expected_success = H.decode_at_current_rate(llrs, syndrome, expected, config, workspace);
+                const auto expected_n_iterations = workspace.n_iterations;
+
+                for (std::size_t n_helpers: {0u, 2u, 8u}) {
+                    std::vector<std::uint8_t> solution;
+                    EXPECT_EQ(decode_intra_frame(H, slots, llrs, syndrome, solution, config, workspace, pool,
+                                                 n_helpers), expected_success);
+                    EXPECT_EQ(solution, expected);
+                    EXPECT_EQ(workspace.n_iterations, expected_n_iterations);
+                }
+            }
+        }
+    }
+
+    // slots of a different rate, unsupported decoder settings
+    const EdgeSlots<std::uint32_t> slots(H);
+    H.set_rate(0);
+    std::vector<bool> key(H.getNCols());
+    std::vector<bool> syndrome;
+    H.encode_at_current_rate(key, syndrome);
+    std::vector<bool> solution;
+    EXPECT_ANY_THROW(decode_intra_frame(H, slots, llrs_bsc(key, 0.02), syndrome, solution, DecoderConfig{},
+                                        workspace, pool, 2));
+    DecoderConfig decimation{};
+    decimation.decimation_rounds = 2;
+    EXPECT_ANY_THROW(decode_intra_frame(H, EdgeSlots<std::uint32_t>(H), llrs_bsc(key, 0.02), syndrome, solution,
+                                        decimation, workspace, pool, 2));
+}
+
+TEST(decoding_service, execution_modes) {
+    CodeRegistry<std::uint32_t> registry;
+    add_embedded_codes(registry);
+    constexpr std::size_t code_id = 0;
+    const auto H = registry.get_mother_code(code_id);
+
+    ThreadPool pool(3);
+    DecodingSchedule schedule{};
+    schedule.execution = ExecutionMode::intra_frame;
+    DecodingService<std::uint32_t> intra_frame(registry, pool, {}, schedule);
+    schedule.execution = ExecutionMode::adaptive;
+    schedule.calibration_period = 0;
+    DecodingService<std::uint32_t> adaptive(registry, pool, {}, schedule);
+    DecodingService<std::uint32_t> frame_parallel(registry, pool);
+
+    constexpr double p = 0.02;
+    std::mt19937_64 rng(11);
+    std::vector<std::uint8_t> key(H->getNCols());
+    noise_bitstring_inplace(rng, key, 0.5);
+    std::vector<std::uint8_t> syndrome;
+    H->encode_no_ra(key, syndrome);
+    std::vector<std::uint8_t> noisy_key = key;
+    noise_bitstring_inplace(rng, noisy_key, p);
+    const auto llrs = llrs_bsc(noisy_key, p);
+
+    const auto expected = frame_parallel.submit(code_id, llrs, syndrome).get();
+    EXPECT_TRUE(expected.success);
+    EXPECT_EQ(expected.n_threads, 1);
+    EXPECT_GT(expected.n_iterations, 0);
+    const auto result = intra_frame.submit(code_id, llrs, syndrome).get();
+    EXPECT_EQ(result.n_threads, pool.size());
+    EXPECT_EQ(result.key, expected.key);
+    EXPECT_EQ(result.n_iterations, expected.n_iterations);
+    EXPECT_GT(intra_frame.get_cost_model(code_id).overhead_seconds_per_iteration, 0);
+
+    // The first frame calibrates single-threaded decoding. Then, a frame arriving at an idle pool is decoded by all
+    // threads if the cost model predicts this to be faster.
+    EXPECT_EQ(adaptive.get_cost_model(code_id).n_frames_single, 0);
+    EXPECT_EQ(adaptive.submit(code_id, llrs, syndrome).get().n_threads, 1);
+    const auto model = adaptive.get_cost_model(code_id);
+    EXPECT_EQ(model.n_frames_single, 1);
+    EXPECT_GT(model.seconds_per_edge_iteration, 0);
+    EXPECT_EQ(model.overhead_seconds_per_iteration, schedule.initial_intra_frame_overhead);
+
+    ExecutionCostModel cheap_sync = model;
+    cheap_sync.overhead_seconds_per_iteration = 0;
+    ExecutionCostModel expensive_sync = model;
+    expensive_sync.overhead_seconds_per_iteration = 1;
+    EXPECT_LT(cheap_sync.seconds_per_iteration(1000, 3), cheap_sync.seconds_per_iteration(1000, 1));
+    EXPECT_GT(expensive_sync.seconds_per_iteration(1000, 3), expensive_sync.seconds_per_iteration(1000, 1));
+
+    const auto n_edges = std::accumulate(H->getPosVarn().begin(), H->getPosVarn().end(), std::size_t{},
+                                         [](std::size_t n, const auto &row) { return n + row.size(); });
+    const auto adaptive_result = adaptive.submit(code_id, llrs, syndrome).get();
+    EXPECT_EQ(adaptive_result.key, expected.key);
+    // Workers that are still busy finishing the previous frame are not used, so compare with the threads actually used.
+    EXPECT_LE(adaptive_result.n_threads, pool.size());
+    if (adaptive_result.n_threads > 1) {
+        EXPECT_LT(model.seconds_per_iteration(n_edges, adaptive_result.n_threads),
+                  model.seconds_per_iteration(n_edges, 1));
+    }
+    if (model.seconds_per_iteration(n_edges, pool.size()) >= model.seconds_per_iteration(n_edges, 1)) {
+        EXPECT_EQ(adaptive_result.n_threads, 1);  // not faster with any number of threads
+    }
+
+    // Under load (frames waiting for a worker), frames are decoded single-threaded.
+    std::vector<std::future<DecodingResult>> results;
+    for (std::size_t frame_idx{}; frame_idx < 20; ++frame_idx) {
+        results.push_back(adaptive.submit(code_id, llrs, syndrome));
+    }
+    std::size_t n_single{};
+    for (auto &r: results) {
+        const auto res = r.get();
+        EXPECT_EQ(res.key, expected.key);
+        n_single += (res.n_threads == 1);
+    }
+    EXPECT_GE(n_single, results.size() / 2);
+}
+
+TEST(pipelined_decoding, same_as_sequential) {
+    auto H = get_code_big_wra();
+    H.set_rate(300);
+    const auto code = std::make_shared<const RateAdaptiveCode<std::uint32_t>>(H);
+    std::mt19937_64 rng(13);
+
+    DecoderConfig sum_product{};
+    sum_product.max_num_iter = 20;
+    DecoderConfig min_sum = sum_product;
+    min_sum.check_node_rule = CheckNodeRule::normalized_min_sum;
+    min_sum.damping = 0.2;
+    for (const auto &config: {sum_product, min_sum}) {
+        for (std::size_t n_slots: {1u, 3u}) {
+            std::vector<std::vector<double>> llrs;
+            std::vector<std::vector<std::uint8_t>> syndromes;
+            std::vector<std::future<DecodingResult>> results;
+            {
+                PipelinedDecoder<std::uint32_t> decoder(code, config, n_slots);
+                for (const double p: {0.02, 0.1, 0.01, 0.02}) {  // the frame with p = 0.1 fails
+                    std::vector<std::uint8_t> key(H.getNCols());
+                    noise_bitstring_inplace(rng, key, 0.5);
+                    syndromes.emplace_back();
+                    H.encode_at_current_rate(key, syndromes.back());
+                    noise_bitstring_inplace(rng, key, p);
+                    llrs.push_back(llrs_bsc(key, p));
+                    results.push_back(decoder.submit(llrs.back(), syndromes.back()));
+                }
+            }  // the destructor finishes all frames
+
+            DecoderWorkspace workspace;
+            for (std::size_t frame_idx{}; frame_idx < results.size(); ++frame_idx) {
+                std::vector<std::uint8_t> expected;
+                const bool expected_success = H.decode_at_current_rate(llrs[frame_idx], syndromes[frame_idx],
+                                                                       expected, config, workspace);
+                const auto result = results[frame_idx].get();
+                EXPECT_EQ(result.success, expected_success);
+                EXPECT_EQ(result.key, expected);
+                EXPECT_EQ(result.n_iterations, workspace.n_iterations);
+                EXPECT_EQ(result.n_threads, 2);
+            }
+        }
+    }
+
+    // invalid inputs and unsupported decoder settings
+    PipelinedDecoder<std::uint32_t> decoder(code);
+    EXPECT_ANY_THROW(decoder.submit(std::vector<double>(H.getNCols()), {}));
+    DecoderConfig restarts{};
+    restarts.restarts = 1;
+    EXPECT_ANY_THROW(PipelinedDecoder<std::uint32_t>(code, restarts));
+    EXPECT_ANY_THROW(PipelinedDecoder<std::uint32_t>(code, {}, 0));
+}
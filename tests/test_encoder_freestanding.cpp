@@ -0,0 +1,126 @@
+//
+// Created by alice on 18.10.26.
+//
+
+// Google Test framework
+#include <gtest/gtest.h>
+#include "helpers_for_testing.hpp"
+
+// Standard library
+#include <iostream>
+
+// To be tested
+#include "LDPC4QKD/encoder_freestanding.hpp"
+#include "LDPC4QKD/autogen/rate_adaption_2x6_block_6144.hpp"
+#include "LDPC4QKD/autogen/rate_adaption_2x6_block_24576.hpp"
+#include "LDPC4QKD/autogen/rate_adaption_2x6_block_1572864.hpp"
+#include "LDPC4QKD/autogen/rate_adaption_2x4_block_4096.hpp"
+#include "LDPC4QKD/autogen/rate_adaption_2x4_block_16384.hpp"
+#include "LDPC4QKD/autogen/rate_adaption_2x4_block_1048576.hpp"
+
+// Results are compared to these:
+#include "LDPC4QKD/encoder_advanced.hpp"
+#include "LDPC4QKD/rate_adaptive_code.hpp"
+
+using namespace HelpersForTests;
+
+namespace {
+    namespace FS = LDPC4QKD::Freestanding;
+
+    constexpr FS::RateAdaption rate_adaption_6144{AutogenRateAdapt_2x6_block_6144::rows};
+
+    // every shipped rate adaption table fits its encoder
+    static_assert(FS::encoder_2048x6144_4663d91.is_valid(rate_adaption_6144));
+    static_assert(FS::encoder_8192x24576_71b51c1.is_valid(
+            FS::RateAdaption{AutogenRateAdapt_2x6_block_24576::rows}));
+    static_assert(FS::encoder_524288x1572864_4d78a9f.is_valid(
+            FS::RateAdaption{AutogenRateAdapt_2x6_block_1572864::rows}));
+    static_assert(FS::encoder_2048x4096_0c809c3.is_valid(
+            FS::RateAdaption{AutogenRateAdapt_2x4_block_4096::rows}));
+    static_assert(FS::encoder_8192x16384_3fcad37.is_valid(
+            FS::RateAdaption{AutogenRateAdapt_2x4_block_16384::rows}));
+    static_assert(FS::encoder_524288x1048576_9b50f98.is_valid(
+            FS::RateAdaption{AutogenRateAdapt_2x4_block_1048576::rows}));
+
+    // tables of other codes or with repeated rows are rejected
+    constexpr std::array<std::uint16_t, 4> repeated_row{0, 1, 2, 1};
+    static_assert(!FS::encoder_2048x4096_0c809c3.is_valid(FS::RateAdaption{repeated_row}));
+    static_assert(!FS::encoder_2048x4096_0c809c3.is_valid(
+            FS::RateAdaption{AutogenRateAdapt_2x6_block_24576::rows}));
+
+    /// syndrome of the all-ones key, computed at compile time.
+    constexpr auto syndrome_of_ones_4096() {
+        constexpr auto &encoder = FS::encoder_2048x4096_0c809c3;
+        std::array<std::uint8_t, encoder.inputSize> key{};
+        for (auto &k: key) {
+            k = 1;
+        }
+        std::array<std::uint8_t, encoder.outputSize> syndrome{};
+        encoder.encode_no_check(key, syndrome);
+        return syndrome;
+    }
+}
+
+TEST(test_encoder_freestanding, same_as_encoder_advanced) {
+    std::mt19937_64 rng(42);
+
+    std::vector<std::uint8_t> key(FS::encoder_2048x6144_4663d91.get_input_size());
+    noise_bitstring_inplace(rng, key, 0.5);
+
+    std::vector<std::uint8_t> syndrome(FS::encoder_2048x6144_4663d91.get_output_size());
+    EXPECT_EQ(FS::encoder_2048x6144_4663d91.encode(key, syndrome), FS::EncoderStatus::ok);
+
+    std::vector<std::uint8_t> syndrome_advanced(LDPC4QKD::encoder_2048x6144_4663d91.get_output_size());
+    LDPC4QKD::encoder_2048x6144_4663d91.encode(key, syndrome_advanced);
+    EXPECT_EQ(syndrome, syndrome_advanced);
+
+    // computed at compile time
+    constexpr auto syndrome_ones = syndrome_of_ones_4096();
+    std::vector<std::uint8_t> key_ones(LDPC4QKD::encoder_2048x4096_0c809c3.get_input_size(), 1);
+    std::vector<std::uint8_t> syndrome_ones_advanced(LDPC4QKD::encoder_2048x4096_0c809c3.get_output_size());
+    LDPC4QKD::encoder_2048x4096_0c809c3.encode(key_ones, syndrome_ones_advanced);
+    EXPECT_EQ(std::vector<std::uint8_t>(syndrome_ones.begin(), syndrome_ones.end()), syndrome_ones_advanced);
+}
+
+TEST(test_encoder_freestanding, same_as_rate_adaptive_code) {
+    std::vector<std::uint16_t> rows_to_combine(AutogenRateAdapt_2x6_block_6144::rows.begin(),
+                                               AutogenRateAdapt_2x6_block_6144::rows.end());
+    LDPC4QKD::RateAdaptiveCode<std::uint16_t> H(LDPC4QKD::encoder_2048x6144_4663d91.get_pos_varn(), rows_to_combine);
+
+    constexpr auto &encoder = FS::encoder_2048x6144_4663d91;
+    std::mt19937_64 rng(42);
+    std::vector<std::uint8_t> key(encoder.inputSize);
+    noise_bitstring_inplace(rng, key, 0.5);
+    std::array<std::uint8_t, encoder.outputSize> scratch{};
+
+    for (std::size_t syndrome_size: {std::size_t{2048}, std::size_t{2000}, std::size_t{1500}, std::size_t{1024}}) {
+        std::vector<std::uint8_t> syndrome(syndrome_size);
+        EXPECT_EQ(encoder.encode_with_ra(rate_adaption_6144, key, syndrome, scratch), FS::EncoderStatus::ok);
+
+        std::vector<std::uint8_t> expected;
+        H.encode_with_ra(key, expected, syndrome_size);
+        EXPECT_EQ(syndrome, expected);
+    }
+}
+
+TEST(test_encoder_freestanding, error_codes) {
+    constexpr auto &encoder = FS::encoder_2048x6144_4663d91;
+    std::vector<std::uint8_t> key(encoder.inputSize);
+    std::vector<std::uint8_t> syndrome(encoder.outputSize);
+    std::array<std::uint8_t, encoder.outputSize> scratch{};
+
+    std::vector<std::uint8_t> short_key(encoder.inputSize - 1);
+    EXPECT_EQ(encoder.encode(short_key, syndrome), FS::EncoderStatus::invalid_key_size);
+    std::vector<std::uint8_t> long_syndrome(encoder.outputSize + 1);
+    EXPECT_EQ(encoder.encode(key, long_syndrome), FS::EncoderStatus::invalid_syndrome_size);
+
+    EXPECT_EQ(encoder.encode_with_ra(rate_adaption_6144, key, long_syndrome, scratch),
+              FS::EncoderStatus::invalid_syndrome_size);
+    std::vector<std::uint8_t> too_short_syndrome(encoder.outputSize - rate_adaption_6144.max_row_combinations() - 1);
+    EXPECT_EQ(encoder.encode_with_ra(rate_adaption_6144, key, too_short_syndrome, scratch),
+              FS::EncoderStatus::unsupported_rate);
+    EXPECT_EQ(encoder.encode_with_ra(rate_adaption_6144, key, syndrome, std::span<std::uint8_t>{scratch}.first(10)),
+              FS::EncoderStatus::invalid_scratch_size);
+    EXPECT_EQ(encoder.encode_with_ra(rate_adaption_6144, short_key, syndrome, scratch),
+              FS::EncoderStatus::invalid_key_size);
+}
@@ -0,0 +1,164 @@
+//
+// Created by alice on 18.10.26.
+//
+
+// Google Test framework
+#include <gtest/gtest.h>
+#include "helpers_for_testing.hpp"
+
+// Standard library
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+// To be tested
+#include "LDPC4QKD/faid_decoder.hpp"
+#include "LDPC4QKD/read_faid_rule.hpp"
+
+// Test cases test against constants known to be correct for the LDPC-matrix defined here:
+#include "fortest_autogen_ldpc_matrix_csc.hpp"
+#include "fortest_autogen_rate_adaption.hpp"
+
+using namespace HelpersForTests;
+using namespace LDPC4QKD;
+
+namespace {
+
+    auto get_code_big_wra() {
+        std::vector<std::uint32_t> colptr(AutogenLDPC::colptr.begin(), AutogenLDPC::colptr.end());
+        std::vector<std::uint32_t> row_idx(AutogenLDPC::row_idx.begin(), AutogenLDPC::row_idx.end());
+        std::vector<std::uint32_t> rows_to_combine(AutogenRateAdapt::rows.begin(), AutogenRateAdapt::rows.end());
+        return RateAdaptiveCode<std::uint32_t>(colptr, row_idx, rows_to_combine);
+    }
+
+}
+
+TEST(faid_decoder, packed_messages) {
+    std::vector<std::uint8_t> packed(4);
+    for (std::size_t i{}; i < 7; ++i) {
+        HelpersFaid::set_msg(packed, i, HelpersFaid::msg_from_level(static_cast<int>(i) - 3));
+    }
+    HelpersFaid::set_msg(packed, 2, HelpersFaid::msg_from_level(2));  // overwrite one message of a pair
+
+    const std::vector<int> expected{-3, -2, 2, 0, 1, 2, 3};
+    for (std::size_t i{}; i < expected.size(); ++i) {
+        EXPECT_EQ(HelpersFaid::level_from_msg(HelpersFaid::get_msg(packed, i)), expected[i]);
+    }
+}
+
+TEST(faid_decoder, lookup_tables) {
+    auto H = get_code_big_wra();
+
+    FaidRule rule{};
+    rule.levels = {1, 2, 3};
+    rule.channel_weight = 1;
+    rule.thresholds = {1, 2, 3};
+    const FaidDecoder<std::uint32_t> quantized_min_sum(H, rule);
+    // degree two: s = -(channel_weight + levels[2]), ..., channel_weight + levels[2]
+    EXPECT_EQ(quantized_min_sum.get_vn_lut(2), (std::vector<std::int8_t>{-3, -3, -2, -1, 0, 1, 2, 3, 3}));
+
+    // an explicit table replaces the threshold rule for its degree only
+    rule.vn_luts[2] = {-3, -2, -2, -1, 0, 1, 2, 2, 3};
+    const FaidDecoder<std::uint32_t> faid(H, rule);
+    EXPECT_EQ(faid.get_vn_lut(2), (std::vector<std::int8_t>{-3, -2, -2, -1, 0, 1, 2, 2, 3}));
+    EXPECT_EQ(faid.get_vn_lut(3), quantized_min_sum.get_vn_lut(3));
+
+    rule.vn_luts[2] = {-3, -2, -2, -1, 0, 1, 2, 3, 3};  // not odd
+    EXPECT_ANY_THROW(FaidDecoder<std::uint32_t>(H, rule));
+    rule.vn_luts[2] = {-1, 0, 1};  // wrong size
+    EXPECT_ANY_THROW(FaidDecoder<std::uint32_t>(H, rule));
+    rule.vn_luts.clear();
+    rule.vn_luts[H.get_max_var_node_degree() + 1] = {};
+    EXPECT_ANY_THROW(FaidDecoder<std::uint32_t>(H, rule));
+
+    rule.vn_luts.clear();
+    rule.levels = {2, 2, 3};  // not increasing
+    EXPECT_ANY_THROW(FaidDecoder<std::uint32_t>(H, rule));
+}
+
+TEST(faid_decoder, decodes_at_several_rates) {
+    auto H = get_code_big_wra();
+    const FaidDecoder<std::uint32_t> decoder(H);
+    FaidWorkspace workspace;  // reused for all rates
+
+    std::mt19937_64 rng(3);
+    constexpr double p = 0.02;
+    for (std::size_t n_line_combs: {0u, 100u, 0u}) {
+        H.set_rate(n_line_combs);
+        for (std::size_t frame_idx{}; frame_idx < 3; ++frame_idx) {
+            std::vector<bool> x(H.getNCols());
+            noise_bitstring_inplace(rng, x, 0.5);
+            std::vector<bool> syndrome;
+            H.encode_at_current_rate(x, syndrome);
+            std::vector<bool> x_noised = x;
+            noise_bitstring_inplace(rng, x_noised, p);
+            const std::vector<double> llrs = llrs_bsc(x_noised, p);
+
+            std::vector<bool> solution;
+            EXPECT_TRUE(decoder.decode(llrs, syndrome, solution, workspace));
+            EXPECT_EQ(solution, x);
+            EXPECT_LE(workspace.n_iterations, decoder.get_rule().max_num_iter);
+            EXPECT_EQ(workspace.msg_v.size(), (workspace.graph->cn_offsets.back() + 1) / 2);  // two messages per byte
+            const auto graph = workspace.graph;
+
+            FaidWorkspace new_workspace;
+            std::vector<bool> solution_new_workspace;
+            EXPECT_TRUE(decoder.decode(llrs, syndrome, solution_new_workspace, new_workspace));
+            EXPECT_EQ(solution_new_workspace, solution);
+            EXPECT_EQ(new_workspace.graph, graph);  // edges are built once per rate
+        }
+    }
+
+    // too much noise for the rate
+    H.set_rate(600);
+    std::vector<bool> x(H.getNCols());
+    noise_bitstring_inplace(rng, x, 0.5);
+    std::vector<bool> syndrome;
+    H.encode_at_current_rate(x, syndrome);
+    noise_bitstring_inplace(rng, x, 0.1);
+    std::vector<bool> solution;
+    EXPECT_FALSE(decoder.decode(llrs_bsc(x, 0.1), syndrome, solution, workspace));
+    EXPECT_EQ(workspace.n_iterations, decoder.get_rule().max_num_iter);
+
+    EXPECT_ANY_THROW(decoder.decode(std::vector<double>(10), syndrome, solution));
+    syndrome.pop_back();
+    EXPECT_ANY_THROW(decoder.decode(llrs_bsc(x, 0.1), syndrome, solution));
+}
+
+TEST(faid_decoder, variable_nodes_without_edges) {
+    // Column 2 has no edges, and rate adaption (combining rows 0 and 1) cancels both edges of column 1.
+    const std::vector<std::uint32_t> colptr{0, 1, 3, 3, 4};
+    const std::vector<std::uint32_t> row_idx{0, 0, 1, 1};
+    RateAdaptiveCode<std::uint32_t> H(colptr, row_idx, {0, 1});
+    const FaidDecoder<std::uint32_t> decoder(H);
+
+    for (std::size_t n_line_combs: {0u, 1u}) {
+        H.set_rate(n_line_combs);
+        const std::vector<bool> x{true, false, true, true};
+        std::vector<bool> syndrome;
+        H.encode_at_current_rate(x, syndrome);
+
+        std::vector<bool> solution;
+        EXPECT_TRUE(decoder.decode(llrs_bsc(x, 0.01), syndrome, solution));
+        EXPECT_EQ(solution, x);  // nodes without edges take the channel sign
+    }
+}
+
+TEST(faid_decoder, read_faid_rule_from_json) {
+    FaidRule rule{};
+    rule.max_num_iter = 20;
+    rule.levels = {1, 2, 5};
+    rule.thresholds = {1, 4, 6};
+    rule.vn_luts[2] = std::vector<int>(15);
+
+    const std::string path = "./test_faid_rule.json";
+    {
+        std::ofstream f(path);
+        f << faid_rule_to_json(rule).dump(4);
+    }
+    EXPECT_EQ(read_faid_rule_from_json(path), rule);
+    std::remove(path.c_str());
+
+    EXPECT_ANY_THROW(read_faid_rule_from_json("./this_file_does_not_exist.json"));
+    EXPECT_ANY_THROW(read_faid_rule_from_json("./decoder_profile_for_testing.json"));  // wrong format
+}
@@ -0,0 +1,134 @@
+//
+// Created by alice on 18.10.26.
+//
+
+// Google Test framework
+#include <gtest/gtest.h>
+#include "helpers_for_testing.hpp"
+
+// Standard library
+#include <cmath>
+#include <iostream>
+
+// To be tested
+#include "LDPC4QKD/multilevel_reconciliation.hpp"
+#include "LDPC4QKD/embedded_codes.hpp"
+
+using namespace HelpersForTests;
+using namespace LDPC4QKD;
+
+namespace {
+
+    /// samples of the quantized variable `x` and side information `y = x + n`
+    void gaussian_samples(std::mt19937_64 &rng, const GaussianChannel &channel, std::size_t n,
+                          std::vector<double> &x, std::vector<double> &y) {
+        std::normal_distribution<double> dist_x(0., channel.sigma_x);
+        std::normal_distribution<double> dist_n(0., channel.sigma_n);
+        x.resize(n);
+        y.resize(n);
+        for (std::size_t i{}; i < n; ++i) {
+            x[i] = dist_x(rng);
+            y[i] = x[i] + dist_n(rng);
+        }
+    }
+
+}
+
+TEST(multilevel_reconciliation, slice_quantizer) {
+    const auto quantizer = SliceQuantizer::equiprobable(2, 1.);
+    EXPECT_EQ(quantizer.get_n_levels(), 2);
+    EXPECT_EQ(quantizer.get_n_slices(), 4);
+    EXPECT_NEAR(quantizer.get_boundaries()[0], -0.6745, 1e-4);
+    EXPECT_NEAR(quantizer.get_boundaries()[1], 0., 1e-12);
+    EXPECT_NEAR(quantizer.get_boundaries()[2], 0.6745, 1e-4);
+
+    EXPECT_EQ(quantizer.slice_index(-5.), 0);
+    EXPECT_EQ(quantizer.slice_index(0.1), 2);
+    EXPECT_EQ(quantizer.slice_index(5.), 3);
+
+    std::vector<std::uint8_t> bits;
+    quantizer.quantize_level(std::vector<double>{-5., -0.3, 0.1, 5.}, 0, bits);
+    EXPECT_EQ(bits, (std::vector<std::uint8_t>{0, 1, 0, 1}));
+    quantizer.quantize_level(std::vector<double>{-5., -0.3, 0.1, 5.}, 1, bits);
+    EXPECT_EQ(bits, (std::vector<std::uint8_t>{0, 0, 1, 1}));
+
+    EXPECT_ANY_THROW(SliceQuantizer({-1., 0.}));
+    EXPECT_ANY_THROW(SliceQuantizer({1., 0., 2.}));
+}
+
+TEST(multilevel_reconciliation, llrs_use_lower_levels) {
+    const auto quantizer = SliceQuantizer::equiprobable(2, 1.);
+    const GaussianChannel channel{1., 0.1};
+
+    // y clearly inside slice 3 (bits 1, 1)
+    EXPECT_LT(multilevel_llr(quantizer, channel, 2., 0, 0), -10);
+    EXPECT_LT(multilevel_llr(quantizer, channel, 2., 1, 1), -10);
+    // close to the boundary between slices 1 and 2, level 0 is uncertain, but not level 1 once level 0 is known.
+    EXPECT_NEAR(multilevel_llr(quantizer, channel, 0.01, 0, 0), 0., 1.);
+    EXPECT_LT(multilevel_llr(quantizer, channel, 0.01, 1, 0), -10);
+    EXPECT_GT(multilevel_llr(quantizer, channel, 0.01, 1, 1), 10);
+    // far in the tails, LLRs stay finite
+    EXPECT_TRUE(std::isfinite(multilevel_llr(quantizer, channel, 100., 0, 0)));
+}
+
+TEST(multilevel_reconciliation, decode_pipelined_frames) {
+    CodeRegistry<std::uint32_t> registry;
+    add_embedded_codes(registry);
+    ThreadPool pool(4);
+    DecodingService<std::uint32_t> service(registry, pool);
+
+    constexpr std::size_t code_id = 0;
+    const auto H = registry.get_mother_code(code_id);
+    const std::size_t n = H->getNCols();
+    const auto quantizer = SliceQuantizer::equiprobable(2, 1.);
+    const GaussianChannel channel{1., 0.05};
+    std::mt19937_64 rng(3);
+
+    // choose syndrome sizes from the conditional entropies of the levels
+    std::vector<double> x;
+    std::vector<double> y;
+    gaussian_samples(rng, channel, 20000, x, y);
+    const auto entropies = estimate_level_entropies(quantizer, channel, x, y);
+    ASSERT_EQ(entropies.size(), 2u);
+    EXPECT_GT(entropies[0], entropies[1]);
+    const auto levels = choose_level_specs(registry, {3, code_id}, n, entropies, 1.3);  // code 3 has 4096 bits
+    ASSERT_EQ(levels.size(), 2u);
+    const std::size_t min_syndrome_size = H->get_n_rows_mother_matrix() - H->get_max_ra_steps();
+    for (std::size_t level{}; level < levels.size(); ++level) {
+        const auto size = static_cast<std::size_t>(std::ceil(1.3 * entropies[level] * static_cast<double>(n)));
+        EXPECT_EQ(levels[level].code_id, code_id);
+        EXPECT_EQ(levels[level].syndrome_size,
+                  std::clamp(size, min_syndrome_size, std::size_t{H->get_n_rows_mother_matrix()}));
+    }
+    EXPECT_ANY_THROW(choose_level_specs(registry, {3}, n, entropies, 1.3));
+
+    MultilevelReconciliation<std::uint32_t> reconciliation(service, quantizer, channel, levels);
+    EXPECT_EQ(reconciliation.get_frame_size(), n);
+
+    std::vector<std::vector<double>> xs;
+    std::vector<std::future<MultilevelResult>> results;
+    for (std::size_t frame{}; frame < 6; ++frame) {
+        gaussian_samples(rng, channel, n, x, y);
+        xs.push_back(x);
+        results.push_back(reconciliation.submit(y, reconciliation.compute_syndromes(x)));
+    }
+    for (std::size_t frame{}; frame < results.size(); ++frame) {
+        const auto result = results[frame].get();
+        EXPECT_TRUE(result.success);
+        EXPECT_EQ(result.n_levels_decoded, 2);
+        ASSERT_EQ(result.slice_indices.size(), n);
+        for (std::size_t i{}; i < n; ++i) {
+            ASSERT_EQ(result.slice_indices[i], quantizer.slice_index(xs[frame][i]));
+        }
+    }
+
+    // too much noise for the chosen rates: decoding stops at level 0.
+    gaussian_samples(rng, GaussianChannel{1., 0.3}, n, x, y);
+    const auto result = reconciliation.submit(y, reconciliation.compute_syndromes(x)).get();
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.n_levels_decoded, 0);
+    EXPECT_TRUE(result.bits[1].empty());
+
+    EXPECT_ANY_THROW(reconciliation.submit(std::vector<double>(n - 1), reconciliation.compute_syndromes(x)));
+    EXPECT_ANY_THROW(MultilevelReconciliation<std::uint32_t>(service, quantizer, channel, {levels[0]}));
+}
@@ -193,6 +193,28 @@ TEST(rate_adaptive_code_from_colptr_rowIdx, encode_with_ra) {
 }
 
 
+TEST(rate_adaptive_code_from_colptr_rowIdx, encode_with_ra_same_as_set_rate) {
+    // The rate adaption of this code combines rows that share columns (which cancel over GF(2)).
+    auto H = get_code_big_wra();
+    const auto mother = H;
+    std::mt19937_64 rng(5);
+
+    for (std::size_t n_line_combs: {std::size_t{1}, std::size_t{100}, std::size_t{500}, H.get_max_ra_steps()}) {
+        H.set_rate(n_line_combs);
+        for (std::size_t i{}; i < 10; ++i) {
+            std::vector<std::uint8_t> key(H.getNCols());
+            noise_bitstring_inplace(rng, key, 0.5);
+
+            std::vector<std::uint8_t> syndrome_ra;
+            mother.encode_with_ra(key, syndrome_ra, H.get_n_rows_after_rate_adaption());
+            std::vector<std::uint8_t> syndrome_current_rate;
+            H.encode_at_current_rate(key, syndrome_current_rate);
+            EXPECT_EQ(syndrome_ra, syndrome_current_rate);
+        }
+    }
+}
+
+
 TEST(rate_adaptive_code_from_colptr_rowIdx, ra_reported_size) {
     auto H = get_code_big_wra();
 
@@ -352,3 +374,361 @@ TEST(rate_adaptive_code_from_decoder, obtain_from_advanced_encoder_equals) {
     auto H2 = get_code_big_wra();
     EXPECT_TRUE(H1 == H2);
 }
+
+TEST(rate_adaptive_code_decoder_config, default_config_same_as_default_arguments) {
+    auto H = get_code_big_nora();
+
+    std::vector<Bit> x = get_bitstring(H.getNCols()); // true data to be sent
+    std::vector<Bit> syndrome;
+    H.encode_no_ra(x, syndrome);
+
+    constexpr double p = 0.05; // channel error probability (decoder does not converge in few iterations)
+    std::vector<Bit> x_noised = x; // distorted data
+    noise_bitstring_inplace(x_noised, p);
+    std::vector<double> llrs = llrs_bsc(x_noised, p);
+
+    DecoderConfig config{};
+    config.max_num_iter = 3;
+
+    std::vector<Bit> solution_default_args;
+    std::vector<Bit> solution_config;
+    bool success_default_args = H.decode_at_current_rate(llrs, syndrome, solution_default_args, 3);
+    bool success_config = H.decode_at_current_rate(llrs, syndrome, solution_config, config);
+
+    EXPECT_EQ(success_default_args, success_config);
+    EXPECT_EQ(solution_default_args, solution_config);
+}
+
+TEST(rate_adaptive_code_decoder_config, decode_min_sum_and_damping) {
+    auto H = get_code_big_wra();
+
+    DecoderConfig min_sum_config{};
+    min_sum_config.check_node_rule = CheckNodeRule::normalized_min_sum;
+    min_sum_config.min_sum_normalization = 0.8;
+
+    DecoderConfig damped_config{};
+    damped_config.damping = 0.3;
+
+    std::mt19937_64 rng(42);
+    constexpr double p = 0.03;
+    const std::size_t syndrome_size = H.get_n_rows_mother_matrix() - 10;
+
+    for (std::size_t frame_idx{}; frame_idx < 5; ++frame_idx) {
+        std::vector<bool> x(H.getNCols()); // true data sent over a noisy channel
+        noise_bitstring_inplace(rng, x, 0.5);  // choose it randomly.
+
+        std::vector<bool> syndrome;
+        H.encode_with_ra(x, syndrome, syndrome_size);
+
+        std::vector<bool> x_noised = x; // copy for distorted data
+        noise_bitstring_inplace(rng, x_noised, p);
+        std::vector<double> llrs = llrs_bsc(x_noised, p);
+
+        for (const auto &config: {min_sum_config, damped_config}) {
+            std::vector<bool> solution;
+            EXPECT_TRUE(H.decode_infer_rate(llrs, syndrome, solution, config));
+            EXPECT_EQ(solution, x);
+        }
+    }
+}
+
+TEST(rate_adaptive_code_decoder_config, decode_in_slices_same_as_at_once) {
+    auto H = get_code_big_wra();
+    H.set_rate(100);
+
+    std::mt19937_64 rng(5);
+    DecoderConfig config{};
+    config.damping = 0.2;  // damping depends on the iteration count, which must be kept across slices.
+
+    // the first frame converges, the second one fails (too much noise for the rate).
+    for (double p: {0.03, 0.08}) {
+        std::vector<bool> x(H.getNCols());
+        noise_bitstring_inplace(rng, x, 0.5);
+        std::vector<bool> syndrome;
+        H.encode_at_current_rate(x, syndrome);
+        std::vector<bool> x_noised = x;
+        noise_bitstring_inplace(rng, x_noised, p);
+        const std::vector<double> llrs = llrs_bsc(x_noised, p);
+
+        std::vector<bool> expected;
+        const bool expected_success = H.decode_at_current_rate(llrs, syndrome, expected, config);
+        EXPECT_EQ(expected_success, p < 0.05);
+
+        for (std::size_t slice: {1u, 7u, 50u}) {
+            DecoderWorkspace workspace;
+            std::vector<bool> out;
+            H.decode_start(llrs, syndrome, workspace);
+            auto status = DecoderStatus::suspended;
+            std::size_t n_calls{};
+            while (status == DecoderStatus::suspended) {
+                status = H.decode_continue(llrs, syndrome, out, config, workspace, slice);
+                n_calls++;
+            }
+            EXPECT_EQ(status == DecoderStatus::converged, expected_success);
+            EXPECT_EQ(out, expected);
+            EXPECT_LE(workspace.n_iterations, config.max_num_iter);
+            EXPECT_LE(n_calls, config.max_num_iter / slice + 1);
+        }
+    }
+}
+
+TEST(rate_adaptive_code_decoder_config, decode_with_decimation) {
+    auto H = get_code_big_wra();
+    H.set_rate(100);
+
+    DecoderConfig config{};
+    config.decimation_rounds = 3;
+    config.decimation_stall_iterations = 2;
+    config.decimation_fraction = 0.01;
+    const auto n_fixed_per_round = static_cast<std::size_t>(
+            config.decimation_fraction * static_cast<double>(H.getNCols()));
+
+    std::mt19937_64 rng(7);
+    DecoderWorkspace workspace;  // reused, decimation state must be reset for every frame
+
+    // the first frame fails (too much noise for the rate), the second one converges.
+    for (double p: {0.08, 0.03}) {
+        std::vector<bool> x(H.getNCols());
+        noise_bitstring_inplace(rng, x, 0.5);
+        std::vector<bool> syndrome;
+        H.encode_at_current_rate(x, syndrome);
+        std::vector<bool> x_noised = x;
+        noise_bitstring_inplace(rng, x_noised, p);
+        const std::vector<double> llrs = llrs_bsc(x_noised, p);
+
+        std::vector<bool> solution;
+        const bool success = H.decode_at_current_rate(llrs, syndrome, solution, config, workspace);
+        EXPECT_EQ(success, p < 0.05);
+        if (success) {
+            EXPECT_EQ(solution, x);
+        }
+
+        // decimation is bounded, and fixed bits keep their estimate
+        EXPECT_LE(workspace.n_decimation_rounds, config.decimation_rounds);
+        const auto n_fixed = static_cast<std::size_t>(std::count_if(
+                workspace.decimated_llrs.begin(), workspace.decimated_llrs.end(),
+                [](double llr) { return std::isinf(llr); }));
+        EXPECT_EQ(n_fixed, workspace.n_decimation_rounds * n_fixed_per_round);
+        for (std::size_t j{}; j < workspace.decimated_llrs.size(); ++j) {
+            if (std::isinf(workspace.decimated_llrs[j])) {
+                EXPECT_EQ(solution[j], workspace.decimated_llrs[j] < 0);
+            }
+        }
+        if (!success) {
+            EXPECT_EQ(workspace.n_decimation_rounds, config.decimation_rounds);
+        }
+
+        // the decimation state is kept in the workspace, so time-sliced decoding gives the same result
+        DecoderWorkspace sliced_workspace;
+        std::vector<bool> out;
+        H.decode_start(llrs, syndrome, sliced_workspace);
+        auto status = DecoderStatus::suspended;
+        while (status == DecoderStatus::suspended) {
+            status = H.decode_continue(llrs, syndrome, out, config, sliced_workspace, 3);
+        }
+        EXPECT_EQ(status == DecoderStatus::converged, success);
+        EXPECT_EQ(out, solution);
+        EXPECT_EQ(sliced_workspace.decimated_llrs, workspace.decimated_llrs);
+    }
+}
+
+TEST(rate_adaptive_code_decoder_config, decode_with_restarts) {
+    auto H = get_code_big_wra();
+    H.set_rate(100);
+
+    DecoderConfig config{};
+    config.max_num_iter = 20;
+    config.restarts = 2;
+    config.restart_stall_iterations = 2;
+    config.restart_max_iter = 5;
+    config.restart_seed = 11;
+
+    std::mt19937_64 rng(8);
+    DecoderWorkspace workspace;  // reused, restart state must be reset for every frame
+
+    // the first frame fails (too much noise for the rate), the second one converges.
+    for (double p: {0.08, 0.03}) {
+        std::vector<bool> x(H.getNCols());
+        noise_bitstring_inplace(rng, x, 0.5);
+        std::vector<bool> syndrome;
+        H.encode_at_current_rate(x, syndrome);
+        std::vector<bool> x_noised = x;
+        noise_bitstring_inplace(rng, x_noised, p);
+        const std::vector<double> llrs = llrs_bsc(x_noised, p);
+
+        std::vector<bool> solution;
+        const bool success = H.decode_at_current_rate(llrs, syndrome, solution, config, workspace);
+        EXPECT_EQ(success, p < 0.05);
+        if (success) {
+            EXPECT_EQ(solution, x);
+        } else {
+            // each restart allows some more iterations
+            EXPECT_EQ(workspace.n_restarts, config.restarts);
+            EXPECT_EQ(workspace.n_iterations, config.max_num_iter + config.restarts * config.restart_max_iter);
+        }
+
+        // perturbations are bounded by `restart_perturbation` (which does not allow flipping signs here)
+        EXPECT_LE(workspace.n_restarts, config.restarts);
+        EXPECT_EQ(workspace.perturbed_llrs.empty(), workspace.n_restarts == 0);
+        for (std::size_t j{}; j < workspace.perturbed_llrs.size(); ++j) {
+            EXPECT_LE(std::abs(workspace.perturbed_llrs[j] / llrs[j] - 1), config.restart_perturbation);
+        }
+
+        // restarts are deterministic, also with time-sliced decoding
+        DecoderWorkspace sliced_workspace;
+        std::vector<bool> out;
+        H.decode_start(llrs, syndrome, sliced_workspace);
+        auto status = DecoderStatus::suspended;
+        while (status == DecoderStatus::suspended) {
+            status = H.decode_continue(llrs, syndrome, out, config, sliced_workspace, 3);
+        }
+        EXPECT_EQ(status == DecoderStatus::converged, success);
+        EXPECT_EQ(out, solution);
+        EXPECT_EQ(sliced_workspace.n_restarts, workspace.n_restarts);
+        EXPECT_EQ(sliced_workspace.perturbed_llrs, workspace.perturbed_llrs);
+    }
+}
+
+TEST(rate_adaptive_code_decoder_config, decode_start_warm) {
+    auto H = get_code_big_wra();
+    const std::size_t high_rate = 1000;  // number of row combinations at which the decoding fails
+    const std::size_t low_rate = 400;
+
+    // the syndrome at any rate can be derived from the mother syndrome
+    std::mt19937_64 rng(9);
+    std::vector<bool> x(H.getNCols());
+    noise_bitstring_inplace(rng, x, 0.5);
+    std::vector<bool> mother_syndrome;
+    H.encode_no_ra(x, mother_syndrome);
+    std::vector<bool> high_rate_syndrome, low_rate_syndrome, expected;
+    H.rate_adapt_syndrome(mother_syndrome, high_rate_syndrome, H.get_n_rows_mother_matrix() - high_rate);
+    H.encode_with_ra(x, expected, H.get_n_rows_mother_matrix() - high_rate);
+    EXPECT_EQ(high_rate_syndrome, expected);
+    H.rate_adapt_syndrome(mother_syndrome, low_rate_syndrome, H.get_n_rows_mother_matrix() - low_rate);
+
+    constexpr double p = 0.03;
+    std::vector<bool> x_noised = x;
+    noise_bitstring_inplace(rng, x_noised, p);
+    const std::vector<double> llrs = llrs_bsc(x_noised, p);
+
+    DecoderConfig config{};
+    config.max_num_iter = 30;
+    DecoderWorkspace workspace;
+    std::vector<bool> solution;
+    H.set_rate(high_rate);
+    EXPECT_FALSE(H.decode_at_current_rate(llrs, high_rate_syndrome, solution, config, workspace));
+
+    // more syndrome bits revealed: continue from the messages of the failed decoding
+    H.set_rate(low_rate);
+    H.decode_start_warm(llrs, low_rate_syndrome, workspace, high_rate);
+    EXPECT_EQ(H.decode_continue(llrs, low_rate_syndrome, solution, config, workspace, config.max_num_iter),
+              DecoderStatus::converged);
+    EXPECT_EQ(solution, x);
+    const auto n_iterations_warm = workspace.n_iterations;
+
+    DecoderWorkspace cold_workspace;
+    std::vector<bool> cold_solution;
+    EXPECT_TRUE(H.decode_at_current_rate(llrs, low_rate_syndrome, cold_solution, config, cold_workspace));
+    EXPECT_EQ(cold_solution, x);
+    EXPECT_LT(n_iterations_warm, cold_workspace.n_iterations);  // 14 vs. 16 for this frame
+
+    // a warm start needs the messages of a previous decoding (at the rate given)
+    DecoderWorkspace unused_workspace;
+    EXPECT_ANY_THROW(H.decode_start_warm(llrs, low_rate_syndrome, unused_workspace, high_rate));
+    EXPECT_ANY_THROW(H.decode_start_warm(llrs, low_rate_syndrome, workspace, H.get_max_ra_steps() + 1));
+}
+
+TEST(rate_adaptive_code_from_colptr_rowIdx, set_combinations) {
+    auto H = get_code_big_wra();
+    auto H_prefix = get_code_big_wra();
+
+    // the first `n` combinations are the same as `set_rate(n)`
+    H.set_combinations(H.combinations_at_rate(400));
+    H_prefix.set_rate(400);
+    EXPECT_TRUE(H == H_prefix);
+    EXPECT_EQ(H.get_combinations(), H_prefix.combinations_at_rate(400));
+
+    // any subset: the syndrome is the rate adapted mother syndrome
+    std::mt19937_64 rng(3);
+    std::vector<bool> x(H.getNCols());
+    noise_bitstring_inplace(rng, x, 0.5);
+    std::vector<bool> mother_syndrome;
+    H.encode_no_ra(x, mother_syndrome);
+    std::vector<bool> combinations(H.get_max_ra_steps());
+    noise_bitstring_inplace(rng, combinations, 0.5);
+    H.set_combinations(combinations);
+    const auto n_combined = static_cast<std::size_t>(std::count(combinations.begin(), combinations.end(), true));
+    EXPECT_EQ(H.get_n_rows_after_rate_adaption(), H.get_n_rows_mother_matrix() - n_combined);
+    EXPECT_EQ(H.get_combinations(), combinations);
+    std::vector<bool> syndrome, expected;
+    H.encode_at_current_rate(x, syndrome);
+    H.rate_adapt_syndrome(mother_syndrome, expected, combinations);
+    EXPECT_EQ(syndrome, expected);
+
+    EXPECT_ANY_THROW(H.set_combinations(std::vector<bool>(H.get_max_ra_steps() + 1)));
+    EXPECT_ANY_THROW(H.combinations_at_rate(H.get_max_ra_steps() + 1));
+}
+
+TEST(rate_adaptive_code_decoder_config, rank_combinations_to_split) {
+    auto H = get_code_big_wra();
+    const std::size_t high_rate = 1000;  // number of row combinations at which the decoding fails
+    constexpr std::size_t increment = 64;  // row combinations split per round
+
+    std::mt19937_64 rng(9);
+    std::vector<bool> x(H.getNCols());
+    noise_bitstring_inplace(rng, x, 0.5);
+    std::vector<bool> mother_syndrome;
+    H.encode_no_ra(x, mother_syndrome);
+    constexpr double p = 0.03;
+    std::vector<bool> x_noised = x;
+    noise_bitstring_inplace(rng, x_noised, p);
+    const std::vector<double> llrs = llrs_bsc(x_noised, p);
+
+    DecoderConfig config{};
+    config.max_num_iter = 30;
+    std::vector<bool> solution;
+
+    // Bob splits the most promising combinations in every round and continues from the messages of the last round
+    auto combinations = H.combinations_at_rate(high_rate);
+    H.set_combinations(combinations);
+    std::vector<bool> syndrome;
+    H.rate_adapt_syndrome(mother_syndrome, syndrome, combinations);
+    DecoderWorkspace workspace;
+    EXPECT_FALSE(H.decode_at_current_rate(llrs, syndrome, solution, config, workspace));
+    std::size_t n_split{};
+    while (!H.syndrome_matches(solution, syndrome)) {
+        auto ranked = H.rank_combinations_to_split(llrs, syndrome, workspace);
+        EXPECT_EQ(ranked.size(), high_rate - n_split);
+        for (std::size_t k{}; k < increment; ++k) {
+            EXPECT_TRUE(combinations[ranked[k]]);
+            combinations[ranked[k]] = false;
+        }
+        n_split += increment;
+
+        const auto previous_combinations = H.get_combinations();
+        H.set_combinations(combinations);
+        H.rate_adapt_syndrome(mother_syndrome, syndrome, combinations);
+        H.decode_start_warm(llrs, syndrome, workspace, previous_combinations);
+        H.decode_continue(llrs, syndrome, solution, config, workspace, config.max_num_iter);
+    }
+    EXPECT_EQ(solution, x);
+
+    // in the order of the rate adaption, more combinations have to be split
+    std::size_t n_line_combs = high_rate;
+    H.set_rate(n_line_combs);
+    H.rate_adapt_syndrome(mother_syndrome, syndrome, H.get_n_rows_mother_matrix() - n_line_combs);
+    EXPECT_FALSE(H.decode_at_current_rate(llrs, syndrome, solution, config, workspace));
+    while (!H.syndrome_matches(solution, syndrome)) {
+        n_line_combs -= increment;
+        const auto previous_n_line_combs = H.get_n_rows_mother_matrix() - H.get_n_rows_after_rate_adaption();
+        H.set_rate(n_line_combs);
+        H.rate_adapt_syndrome(mother_syndrome, syndrome, H.get_n_rows_mother_matrix() - n_line_combs);
+        H.decode_start_warm(llrs, syndrome, workspace, previous_n_line_combs);
+        H.decode_continue(llrs, syndrome, solution, config, workspace, config.max_num_iter);
+    }
+    EXPECT_EQ(solution, x);
+    EXPECT_LT(n_split, high_rate - n_line_combs);  // 320 vs. 448 for this frame
+
+    DecoderWorkspace unused_workspace;
+    EXPECT_ANY_THROW(H.rank_combinations_to_split(llrs, syndrome, unused_workspace));
+}
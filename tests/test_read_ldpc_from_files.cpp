@@ -8,9 +8,13 @@
 
 // Standard library
 #include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <limits>
 
 // To be tested
 #include "LDPC4QKD/read_ldpc_file_formats.hpp"
+#include "LDPC4QKD/ldpc_file_conversion.hpp"
 #include "fortest_autogen_ldpc_matrix_csc.hpp"
 #include "benchmarks_error_rate/code_simulation_helpers.hpp"
 
@@ -54,3 +58,98 @@ TEST(test_read_ldpc_from_files, read_bincsc_json_format) {
 
     EXPECT_TRUE(H == H_old);
 }
+
+
+TEST(test_read_ldpc_from_files, read_qccsc_json_format) {
+    auto qc = read_csc_json("./block_6144_proto_2x6_313422410401.qccsc.json");
+    EXPECT_TRUE(qc.is_qc());
+    EXPECT_EQ(qc.qc_expansion_factor, 32);
+    EXPECT_EQ(qc.n_rows, 64);
+    EXPECT_EQ(qc.n_cols, 192);
+
+    // same matrix as stored in binary form (generated by LDPCStorage.jl), independent of the number of threads
+    auto binary = read_csc_json("./test_reading_bincscjson_format_block_6144_proto_2x6_313422410401.bincsc.json");
+    EXPECT_FALSE(binary.is_qc());
+    EXPECT_EQ(expand_qc_exponents(qc, 1), binary);
+    EXPECT_EQ(expand_qc_exponents(qc, 3), binary);
+    EXPECT_EQ(read_cscmat("./LDPC_code_for_testing_2048x6144.cscmat"), binary);
+
+    auto H = LDPC4QKD::CodeSimulationHelpers::load_ldpc_from_json("./block_6144_proto_2x6_313422410401.qccsc.json");
+    EXPECT_TRUE(H == get_code_big_nora());
+}
+
+
+TEST(test_read_ldpc_from_files, convert_ldpc_file_formats) {
+    auto qc = read_csc_json("./block_6144_proto_2x6_313422410401.qccsc.json");
+    auto binary = expand_qc_exponents(qc);
+
+    // formats storing only binary matrices: exponents are expanded when writing
+    for (const std::string path : {"./test_conversion.alist", "./test_conversion.cscmat",
+                                   "./test_conversion.bincsc.json"}) {
+        write_sparse_matrix(path, qc);
+        EXPECT_EQ(read_sparse_matrix(path), binary) << path;
+        std::filesystem::remove(path);
+    }
+
+    // formats that can store the exponents keep them
+    for (const std::string path : {"./test_conversion.qccsc.json", "./test_conversion.cscbin"}) {
+        write_sparse_matrix(path, qc);
+        EXPECT_EQ(read_sparse_matrix(path), qc) << path;
+        std::filesystem::remove(path);
+    }
+    write_sparse_matrix("./test_conversion.cscbin", binary);
+    EXPECT_EQ(read_sparse_matrix("./test_conversion.cscbin"), binary);
+    std::filesystem::remove("./test_conversion.cscbin");
+
+    // C++ headers can be written but not read
+    write_sparse_matrix("./test_conversion.hpp", binary);
+    EXPECT_TRUE(std::filesystem::file_size("./test_conversion.hpp") > 0);
+    EXPECT_ANY_THROW(read_sparse_matrix("./test_conversion.hpp"));
+    std::filesystem::remove("./test_conversion.hpp");
+
+    EXPECT_ANY_THROW(write_sparse_matrix("./test_conversion.qccsc.json", binary));
+    EXPECT_ANY_THROW(read_sparse_matrix("./test_conversion.unknown_extension"));
+}
+
+
+TEST(test_read_ldpc_from_files, reject_invalid_sizes) {
+    auto binary = expand_qc_exponents(read_csc_json("./block_6144_proto_2x6_313422410401.qccsc.json"));
+    constexpr std::streamoff n_cols_offset = 8 + 4 + 4 + 8;  // magic, version, flags, n_rows
+    for (const std::uint64_t n_cols: {std::numeric_limits<std::uint64_t>::max(), std::uint64_t{1} << 40,
+                                      binary.n_cols + 1}) {
+        write_sparse_matrix("./test_invalid_sizes.cscbin", binary);
+        {
+            std::fstream f("./test_invalid_sizes.cscbin", std::ios::binary | std::ios::in | std::ios::out);
+            f.seekp(n_cols_offset);
+            f.write(reinterpret_cast<const char *>(&n_cols), sizeof(n_cols));
+        }
+        EXPECT_ANY_THROW(read_sparse_matrix("./test_invalid_sizes.cscbin")) << n_cols;
+    }
+    std::filesystem::remove("./test_invalid_sizes.cscbin");
+
+    SparseMatrixCSC m = binary;
+    m.colptr.clear();
+    m.n_cols = std::numeric_limits<std::uint64_t>::max();
+    EXPECT_ANY_THROW(m.check_consistency());
+}
+
+
+TEST(test_read_ldpc_from_files, read_decoder_config_from_json) {
+    auto config = read_decoder_config_from_json("./decoder_profile_for_testing.json");
+
+    DecoderConfig expected{};
+    expected.max_num_iter = 30;
+    expected.vsat = 25;
+    expected.check_node_rule = CheckNodeRule::normalized_min_sum;
+    expected.min_sum_normalization = 0.75;
+    // "damping" is not specified in the file. Default is used.
+    EXPECT_EQ(config, expected);
+
+    auto config_json = decoder_config_to_json(config);
+    EXPECT_EQ(config_json["check_node_rule"], "normalized_min_sum");
+    EXPECT_EQ(config_json["max_num_iter"], 30);
+
+    EXPECT_ANY_THROW(read_decoder_config_from_json("./this_file_does_not_exist.json"));
+    EXPECT_ANY_THROW(read_decoder_config_from_json(
+            "./test_reading_bincscjson_format_block_6144_proto_2x6_313422410401.bincsc.json"));  // wrong format
+}
@@ -0,0 +1,153 @@
+//
+// Created by alice on 18.10.26.
+//
+
+// Google Test framework
+#include <gtest/gtest.h>
+#include "helpers_for_testing.hpp"
+
+// Standard library
+#include <algorithm>
+#include <numeric>
+
+// To be tested
+#include "LDPC4QKD/syndrome_provisioning.hpp"
+
+// Test cases test against constants known to be correct for the LDPC-matrix defined here:
+#include "fortest_autogen_ldpc_matrix_csc.hpp"
+#include "fortest_autogen_rate_adaption.hpp"
+
+using namespace HelpersForTests;
+using namespace LDPC4QKD;
+
+namespace {
+
+    auto get_code_big_wra() {
+        std::vector<std::uint32_t> colptr(AutogenLDPC::colptr.begin(), AutogenLDPC::colptr.end());
+        std::vector<std::uint32_t> row_idx(AutogenLDPC::row_idx.begin(), AutogenLDPC::row_idx.end());
+        std::vector<std::uint32_t> rows_to_combine(AutogenRateAdapt::rows.begin(), AutogenRateAdapt::rows.end());
+        return RateAdaptiveCode<std::uint32_t>(colptr, row_idx, rows_to_combine);
+    }
+
+}
+
+TEST(syndrome_provisioning, syndrome_increments) {
+    const auto H = get_code_big_wra();
+    std::mt19937_64 rng(4);
+    std::vector<bool> x(H.getNCols());
+    noise_bitstring_inplace(rng, x, 0.5);
+    std::vector<bool> mother_syndrome;
+    H.encode_no_ra(x, mother_syndrome);
+
+    // Bob starts from the syndrome at the highest rate, and receives increments until the mother syndrome
+    std::size_t size = H.get_n_rows_mother_matrix() - H.get_max_ra_steps();
+    std::vector<bool> syndrome_bob;
+    H.rate_adapt_syndrome(mother_syndrome, syndrome_bob, size);
+    while (size < H.get_n_rows_mother_matrix()) {
+        const auto new_size = std::min<std::size_t>(size + 100, H.get_n_rows_mother_matrix());
+        const auto increment = syndrome_increment(H, mother_syndrome, size, new_size);
+        EXPECT_EQ(increment.size(), new_size - size);
+        apply_syndrome_increment(H, syndrome_bob, increment);
+
+        std::vector<bool> expected;
+        H.encode_with_ra(x, expected, new_size);
+        EXPECT_EQ(syndrome_bob, expected);
+        size = new_size;
+    }
+    EXPECT_EQ(syndrome_bob, mother_syndrome);
+
+    EXPECT_ANY_THROW(syndrome_increment(H, mother_syndrome, size, size - 1));
+    EXPECT_ANY_THROW(syndrome_increment(H, mother_syndrome, size, size + 1));
+    EXPECT_ANY_THROW(apply_syndrome_increment(H, syndrome_bob, std::vector<bool>(1)));
+}
+
+TEST(syndrome_provisioning, targeted_syndrome_increments) {
+    auto H = get_code_big_wra();
+    std::mt19937_64 rng(6);
+    std::vector<bool> x(H.getNCols());
+    noise_bitstring_inplace(rng, x, 0.5);
+    std::vector<bool> mother_syndrome;
+    H.encode_no_ra(x, mother_syndrome);
+
+    // Bob starts from the syndrome at the highest rate and requests combinations to split in any order
+    auto applied = H.combinations_at_rate(H.get_max_ra_steps());
+    std::vector<bool> syndrome_bob;
+    H.rate_adapt_syndrome(mother_syndrome, syndrome_bob, applied);
+    std::vector<std::size_t> order(H.get_max_ra_steps());
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), rng);
+    for (std::size_t begin{}; begin < order.size(); begin += 100) {
+        const std::vector<std::size_t> combinations(
+                order.begin() + static_cast<std::ptrdiff_t>(begin),
+                order.begin() + static_cast<std::ptrdiff_t>(std::min(begin + 100, order.size())));
+        const auto increment = targeted_syndrome_increment(H, mother_syndrome, combinations);
+        EXPECT_EQ(increment.size(), combinations.size());
+        apply_targeted_syndrome_increment(H, syndrome_bob, applied, combinations, increment);
+
+        std::vector<bool> expected;
+        H.set_combinations(applied);
+        H.encode_at_current_rate(x, expected);
+        EXPECT_EQ(syndrome_bob, expected);
+
+        // a combination can only be split once
+        EXPECT_ANY_THROW(apply_targeted_syndrome_increment(H, expected, applied, combinations, increment));
+    }
+    EXPECT_EQ(syndrome_bob, mother_syndrome);
+
+    EXPECT_ANY_THROW(targeted_syndrome_increment(H, mother_syndrome, {H.get_max_ra_steps()}));
+}
+
+TEST(syndrome_provisioning, policy) {
+    ProvisioningSettings settings{};
+    settings.increment = 100;
+    settings.leak_budget = 1350;
+    settings.forgetting_factor = 1;
+    settings.warmup_frames = 5;
+    settings.exploration_period = 10;
+    SyndromeProvisioningPolicy policy(1000, 2000, settings);
+
+    // until enough frames are reported, frames start at the smallest syndrome
+    for (std::size_t i{}; i < settings.warmup_frames; ++i) {
+        EXPECT_EQ(policy.next_syndrome_size(), 1000);
+        policy.report(1000, 1300, true, 50, 4);
+    }
+    for (std::size_t i{}; i < 45; ++i) {
+        policy.report(1000, 1300, true, 50, 4);
+    }
+    // all reported frames decode with 1300 bits, but not with 1200 bits
+    EXPECT_LT(policy.success_probability(1200), 0.01);
+    EXPECT_GT(policy.success_probability(1300), 0.99);
+    EXPECT_NEAR(policy.expected_rounds(1000), 4, 0.1);
+    EXPECT_NEAR(policy.expected_rounds(1300), 1, 0.1);
+    EXPECT_NEAR(policy.expected_leak(1000), 1300, 10);
+    EXPECT_NEAR(policy.expected_latency(1300), settings.round_trip_seconds, 1e-3);
+
+    // lowest latency within the leak budget (every 10th frame explores one increment lower)
+    std::vector<std::size_t> sizes;
+    for (std::size_t i{}; i < 10; ++i) {
+        sizes.push_back(policy.next_syndrome_size());
+    }
+    EXPECT_EQ(std::count(sizes.begin(), sizes.end(), 1300), 9);
+    EXPECT_EQ(std::count(sizes.begin(), sizes.end(), 1200), 1);
+
+    // no initial size is within a small budget, so the smallest is used
+    settings.leak_budget = 1250;
+    SyndromeProvisioningPolicy strict_policy(1000, 2000, settings);
+    for (std::size_t i{}; i < 50; ++i) {
+        strict_policy.report(1000, 1300, true, 50, 4);
+    }
+    EXPECT_EQ(strict_policy.next_syndrome_size(), 1000);
+
+    // failed frames lower the success probability at all sizes they tried
+    for (std::size_t i{}; i < 50; ++i) {
+        strict_policy.report(1000, 2000, false, 500, 11);
+    }
+    EXPECT_NEAR(strict_policy.success_probability(2000), 0.5, 0.01);
+
+    EXPECT_ANY_THROW(strict_policy.report(900, 1300, true, 50, 4));
+    settings.increment = 0;
+    EXPECT_ANY_THROW(SyndromeProvisioningPolicy(1000, 2000, settings));
+    settings.increment = 100;
+    settings.leak_budget = 0;
+    EXPECT_ANY_THROW(SyndromeProvisioningPolicy(1000, 2000, settings));
+}
@@ -0,0 +1,94 @@
+//
+// Created by alice on 18.10.26.
+// Note: Names and meaning of command line parameters are defined below.
+//
+constexpr auto help_text =
+        "LDPC Matrix File Format Converter\n"
+        "\n"
+        "This software is used to \n"
+        "- read an LDPC matrix from a `.qccsc.json` (quasi-cyclic exponents), `.bincsc.json`, `.cscmat`, `.alist` "
+        "or `.cscbin` (binary container) file\n"
+        "- write it in any of these formats, or as a C++ header (`.hpp`) containing `constexpr` arrays.\n"
+        "\n"
+        "The formats are chosen by the file extensions. Quasi-cyclic exponents are expanded (in parallel) when writing "
+        "a format that only stores binary matrices (`.bincsc.json`, `.cscmat`, `.alist`), or if `--expand` is given. "
+        "`.cscbin` files and C++ headers keep the exponents (header layout as in `src/LDPC4QKD/autogen_ldpc_QC.hpp`).\n"
+        "This replaces the conversion scripts in the folder `codes` (which require Julia).";
+
+// Standard library
+#include <iostream>
+#include <chrono>
+
+// Command line argument parser library
+#include "external/CmdParser-91aaa61e/cmdparser.hpp"
+
+// Project scope
+#include "LDPC4QKD/ldpc_file_conversion.hpp"
+
+
+void configure_parser(cli::Parser &parser) {
+    parser.set_required<std::string>(
+            "i", "input-path",
+            "Path to the file containing the LDPC matrix.");
+
+    parser.set_required<std::string>(
+            "o", "output-path",
+            "Path at which the converted LDPC matrix is saved. The format is chosen by the file extension.");
+
+    parser.set_optional<bool>(
+            "x", "expand", false,
+            "Expand quasi-cyclic exponents even if the output format could store them.");
+
+    parser.set_optional<std::string>(
+            "n", "namespace", "AutogenLDPC",
+            "Name of the C++ namespace (only used when writing a C++ header).");
+
+    parser.set_optional<std::size_t>(
+            "t", "threads", 0,
+            "Number of threads used to expand quasi-cyclic exponents. Specify zero to use all available cores.");
+}
+
+
+int main(int argc, char *argv[]) {
+    // parse command line arguments
+    cli::Parser parser(argc, argv, help_text);
+    configure_parser(parser);
+    parser.run_and_exit_if_error();
+
+    const auto input_path = parser.get<std::string>("i");
+    const auto output_path = parser.get<std::string>("o");
+    const auto expand = parser.get<bool>("x");
+    const auto namespace_name = parser.get<std::string>("n");
+    const auto n_threads = parser.get<std::size_t>("t");
+
+    try {
+        auto seconds_since = [](auto begin) {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        };
+
+        auto begin = std::chrono::steady_clock::now();
+        auto matrix = LDPC4QKD::read_sparse_matrix(input_path);
+        std::cout << "Read '" << input_path << "' in " << seconds_since(begin) << " seconds.\n";
+        std::cout << "Matrix size: " << matrix.n_rows << " x " << matrix.n_cols << ", stored entries: "
+                  << matrix.n_stored_entries() << '\n';
+        if (matrix.is_qc()) {
+            std::cout << "Quasi-cyclic exponents with expansion factor " << matrix.qc_expansion_factor << '\n';
+        }
+
+        if (expand && matrix.is_qc()) {
+            begin = std::chrono::steady_clock::now();
+            matrix = LDPC4QKD::expand_qc_exponents(matrix, n_threads);
+            std::cout << "Expanded to " << matrix.n_rows << " x " << matrix.n_cols << " in " << seconds_since(begin)
+                      << " seconds.\n";
+        }
+
+        begin = std::chrono::steady_clock::now();
+        LDPC4QKD::write_sparse_matrix(output_path, matrix, namespace_name, n_threads);
+        std::cout << "Saved '" << output_path << "' in " << seconds_since(begin) << " seconds." << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,247 @@
+//
+// Created by alice on 18.10.26.
+// Note: Names and meaning of command line parameters are defined below.
+//
+constexpr auto help_text =
+        "LDPC Decoder for Files\n"
+        "\n"
+        "This software is used to \n"
+        "- read a file of syndromes (packed bits, consecutive frames, each frame starting at a byte boundary)\n"
+        "- read the noisy keys, either as log likelihood ratios (32 bit floats, host byte order) "
+        "or as packed bits together with the QBER\n"
+        "- decode each frame using the chosen code and rate (in parallel)\n"
+        "- write the decoded keys (packed bits, consecutive frames) and a status file (csv) stating for each frame "
+        "whether decoding succeeded.\n"
+        "\n"
+        "Code and syndrome size of each frame are given by the frames file (e.g. the status file of `ldpc_encode`) "
+        "or by the options `--code-id` and `--syndrome-size`.\n"
+        "Available codes are the codes embedded into this program and codes loaded from files "
+        "(option `--code-paths`).";
+
+// Standard library
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <deque>
+#include <future>
+
+// Project scope
+#include "LDPC4QKD/decoding_service.hpp"
+#include "LDPC4QKD/read_ldpc_file_formats.hpp"
+#include "tool_helpers.hpp"
+
+using namespace LDPC4QKD::ToolHelpers;
+using idx_t = std::uint32_t;
+
+
+void configure_parser(cli::Parser &parser) {
+    parser.set_required<std::string>(
+            "s", "syndrome-path",
+            "Path to file containing the syndromes (packed bits).");
+
+    parser.set_optional<std::string>(
+            "l", "llr-path", "",
+            "Path to file containing the log likelihood ratios of the noisy keys (32 bit floats). "
+            "Either this or `--noisy-key-path` must be given.");
+
+    parser.set_optional<std::string>(
+            "nk", "noisy-key-path", "",
+            "Path to file containing the noisy keys (packed bits). Requires `--qber`.");
+
+    parser.set_optional<double>(
+            "q", "qber", 0,
+            "Quantum bit error rate (binary symmetric channel parameter) used to compute the log likelihood ratios "
+            "of the noisy keys.");
+
+    parser.set_required<std::string>(
+            "o", "output-path",
+            "Path at which the decoded keys (packed bits) are saved.");
+
+    parser.set_optional<std::string>(
+            "sp", "status-path", "ldpc_decode_status.csv",
+            "Path at which the status file (csv, one line per frame) is saved.");
+
+    parser.set_optional<std::size_t>(
+            "i", "max-iterations", 50,
+            "Maximum number of iterations for the decoder.");
+
+    parser.set_optional<std::string>(
+            "dc", "decoder-config-path", "",
+            "Path to a decoder profile (json, e.g. written by `decoder_autotune`). Overrides `--max-iterations`.");
+
+    parser.set_optional<std::size_t>(
+            "ts", "iterations-per-slice", 0,
+            "If non-zero, frames give up their thread after this many decoder iterations and continue later, "
+            "such that small frames do not wait for large ones. Zero decodes every frame in one go.");
+
+    parser.set_optional<std::size_t>(
+            "hp", "high-priority-max-frame-size", 0,
+            "Frames of codes with at most this many bits are decoded before larger frames that are waiting.");
+
+    parser.set_optional<std::string>(
+            "x", "execution", "frame_parallel",
+            "How threads are used: `frame_parallel` (one thread per frame), `intra_frame` (all threads decode each "
+            "frame together, one frame after the other) or `adaptive` (chosen per frame from the number of waiting "
+            "frames and the measured decoding times of the code). "
+            "Time-sliced frames (`--iterations-per-slice`) always use one thread.");
+
+    configure_code_options(parser);
+}
+
+
+int main(int argc, char *argv[]) {
+    // parse command line arguments
+    cli::Parser parser(argc, argv, help_text);
+    configure_parser(parser);
+    parser.run_and_exit_if_error();
+
+    const auto syndrome_path = parser.get<std::string>("s");
+    const auto llr_path = parser.get<std::string>("l");
+    const auto noisy_key_path = parser.get<std::string>("nk");
+    const auto qber = parser.get<double>("q");
+    const auto output_path = parser.get<std::string>("o");
+    const auto status_path = parser.get<std::string>("sp");
+    const auto decoder_config_path = parser.get<std::string>("dc");
+
+    try {
+        if (llr_path.empty() == noisy_key_path.empty()) {
+            throw std::runtime_error("Specify exactly one of `--llr-path` and `--noisy-key-path`.");
+        }
+        if (!noisy_key_path.empty() && !(qber > 0 && qber < 0.5)) {
+            throw std::runtime_error("`--noisy-key-path` requires a QBER strictly between 0 and 0.5 (`--qber`).");
+        }
+
+        LDPC4QKD::DecoderConfig decoder_config{};
+        decoder_config.max_num_iter = parser.get<std::size_t>("i");
+        if (!decoder_config_path.empty()) {
+            decoder_config = LDPC4QKD::read_decoder_config_from_json(decoder_config_path);
+        }
+
+        LDPC4QKD::CodeRegistry<idx_t> registry;
+        add_codes_from_options(parser, registry);
+
+        LDPC4QKD::ThreadPool pool(parser.get<std::size_t>("t"));
+
+        const MappedFile syndromes(syndrome_path);
+        const MappedFile noisy_keys(llr_path.empty() ? noisy_key_path : llr_path);
+        const bool use_llrs = !llr_path.empty();
+
+        auto key_bits = [&registry](const FrameSpec &frame) {
+            return registry.get_mother_code(frame.code_id)->getNCols();
+        };
+        const auto frames = get_frame_specs(parser, registry, syndromes.size(), [](const FrameSpec &frame) {
+            return frame.syndrome_size;
+        });
+        // build all codes and rates concurrently, together with one decoder workspace per thread and rate
+        auto preloading = registry.preload(pool, preload_options_for_frames(frames, true, pool.size()));
+        const auto syndrome_offsets = frame_offsets(frames, [](const FrameSpec &f) {
+            return packed_size(f.syndrome_size);
+        });
+        const auto noisy_key_offsets = frame_offsets(frames, [&](const FrameSpec &f) {
+            return use_llrs ? key_bits(f) * sizeof(float) : packed_size(key_bits(f));
+        });
+        check_file_size(syndromes, syndrome_offsets, "syndrome");
+        check_file_size(noisy_keys, noisy_key_offsets, use_llrs ? "LLR" : "noisy key");
+
+        LDPC4QKD::DecodingSchedule schedule{};
+        schedule.iterations_per_slice = parser.get<std::size_t>("ts");
+        schedule.high_priority_max_frame_size = parser.get<std::size_t>("hp");
+        const auto execution = parser.get<std::string>("x");
+        if (execution == "frame_parallel") {
+            schedule.execution = LDPC4QKD::ExecutionMode::frame_parallel;
+        } else if (execution == "intra_frame") {
+            schedule.execution = LDPC4QKD::ExecutionMode::intra_frame;
+        } else if (execution == "adaptive") {
+            schedule.execution = LDPC4QKD::ExecutionMode::adaptive;
+        } else {
+            throw std::runtime_error("Unknown execution mode '" + execution + "'.");
+        }
+        LDPC4QKD::DecodingService<idx_t> service(registry, pool, decoder_config, schedule);
+
+        std::cout << "Syndrome path: '" << syndrome_path << "'\n";
+        std::cout << (use_llrs ? "LLR path: '" : "Noisy key path: '")
+                  << (use_llrs ? llr_path : noisy_key_path) << "'\n";
+        std::cout << "Number of frames: " << frames.size() << '\n';
+        std::cout << "Decoder profile: '" << decoder_config_path << "'\n";
+        std::cout << "Max number of iterations: " << decoder_config.max_num_iter << '\n';
+        std::cout << "Threads: " << pool.size() << " (execution: " << execution << ")\n" << std::endl;
+
+        std::ofstream output(output_path, std::ios::binary);
+        std::ofstream status(status_path);
+        if (!output || !status) {
+            throw std::runtime_error("Failed to open output files.");
+        }
+        status << "frame,code_id,syndrome_size,success,decoding_seconds\n";
+
+        const auto begin = std::chrono::steady_clock::now();
+
+        // Frames are read and decoded in parallel, while results are written in order.
+        // Limiting the number of frames in flight bounds the memory used.
+        // Helpers of an intra-frame decoding only join while no other task is waiting for a worker,
+        // so with `intra_frame` execution the frames are submitted one at a time.
+        const bool one_frame_at_a_time = schedule.execution == LDPC4QKD::ExecutionMode::intra_frame
+                                         && schedule.iterations_per_slice == 0;
+        const std::size_t max_in_flight = one_frame_at_a_time ? 1 : 4 * pool.size();
+        std::deque<std::future<std::future<LDPC4QKD::DecodingResult>>> in_flight;
+        std::size_t n_written{};
+        std::size_t n_failed{};
+
+        auto write_oldest = [&]() {
+            const auto result = in_flight.front().get().get();
+            in_flight.pop_front();
+            const auto packed_key = pack_bits(result.key);
+            output.write(reinterpret_cast<const char *>(packed_key.data()),
+                         static_cast<std::streamsize>(packed_key.size()));
+            status << n_written << ',' << frames[n_written].code_id << ',' << frames[n_written].syndrome_size
+                   << ',' << result.success << ',' << result.decoding_seconds << '\n';
+            n_failed += !result.success;
+            n_written++;
+        };
+
+        for (std::size_t i{}; i < frames.size(); ++i) {
+            if (in_flight.size() == max_in_flight) {
+                write_oldest();
+            }
+            // A worker unpacks the frame and submits it to the service,
+            // which applies time slicing and priorities of the schedule.
+            const auto n_bits = key_bits(frames[i]);
+            in_flight.push_back(pool.submit([&, i, n_bits]() {
+                std::vector<double> llrs(n_bits);
+                if (use_llrs) {
+                    const auto *frame_llrs = noisy_keys.data() + noisy_key_offsets[i];
+                    for (std::size_t j{}; j < n_bits; ++j) {
+                        float llr{};
+                        std::memcpy(&llr, frame_llrs + j * sizeof(float), sizeof(float));  // may be unaligned
+                        llrs[j] = static_cast<double>(llr);
+                    }
+                } else {
+                    std::vector<std::uint8_t> noisy_key;
+                    unpack_bits(noisy_keys.data() + noisy_key_offsets[i], n_bits, noisy_key);
+                    llrs = LDPC4QKD::llrs_bsc(noisy_key, qber);
+                }
+
+                std::vector<std::uint8_t> syndrome;
+                unpack_bits(syndromes.data() + syndrome_offsets[i], frames[i].syndrome_size, syndrome);
+                return service.submit(frames[i].code_id, std::move(llrs), std::move(syndrome));
+            }, service.get_priority(n_bits)));
+        }
+        while (!in_flight.empty()) {
+            write_oldest();
+        }
+        // rethrows errors of the background builds (a frame may not have needed the failed build)
+        for (auto &f: preloading) {
+            f.get();
+        }
+
+        const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        std::cout << "DONE! Decoded " << frames.size() << " frames in " << seconds << " seconds. "
+                  << "Failed frames: " << n_failed << "\n";
+        std::cout << "Decoded keys saved to '" << output_path << "'\n";
+        std::cout << "Status saved to '" << status_path << "'" << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    exit(EXIT_SUCCESS);
+}
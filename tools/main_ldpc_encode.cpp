@@ -0,0 +1,137 @@
+//
+// Created by alice on 18.10.26.
+// Note: Names and meaning of command line parameters are defined below.
+//
+constexpr auto help_text =
+        "LDPC Encoder (Syndrome Computation) for Files\n"
+        "\n"
+        "This software is used to \n"
+        "- read a file of keys (packed bits, consecutive frames, each frame starting at a byte boundary)\n"
+        "- compute the syndrome of each frame using the chosen code and rate (in parallel)\n"
+        "- write the syndromes (packed bits, consecutive frames) and a status file (csv).\n"
+        "\n"
+        "The status file lists code and syndrome size of each frame. It can be passed to `ldpc_decode` "
+        "as the frames file (option `--frames-path`).\n"
+        "Available codes are the codes embedded into this program and codes loaded from files "
+        "(option `--code-paths`).";
+
+// Standard library
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <deque>
+#include <future>
+
+// Project scope
+#include "LDPC4QKD/thread_pool.hpp"
+#include "tool_helpers.hpp"
+
+using namespace LDPC4QKD::ToolHelpers;
+using idx_t = std::uint32_t;
+
+
+void configure_parser(cli::Parser &parser) {
+    parser.set_required<std::string>(
+            "k", "key-path",
+            "Path to file containing the keys (packed bits).");
+
+    parser.set_required<std::string>(
+            "o", "output-path",
+            "Path at which the syndromes (packed bits) are saved.");
+
+    parser.set_optional<std::string>(
+            "sp", "status-path", "ldpc_encode_status.csv",
+            "Path at which the status file (csv, one line per frame) is saved.");
+
+    configure_code_options(parser);
+}
+
+
+int main(int argc, char *argv[]) {
+    // parse command line arguments
+    cli::Parser parser(argc, argv, help_text);
+    configure_parser(parser);
+    parser.run_and_exit_if_error();
+
+    const auto key_path = parser.get<std::string>("k");
+    const auto output_path = parser.get<std::string>("o");
+    const auto status_path = parser.get<std::string>("sp");
+
+    try {
+        LDPC4QKD::CodeRegistry<idx_t> registry;
+        add_codes_from_options(parser, registry);
+
+        LDPC4QKD::ThreadPool pool(parser.get<std::size_t>("t"));
+
+        const MappedFile keys(key_path);
+        auto key_bits = [&registry](const FrameSpec &frame) {
+            return registry.get_mother_code(frame.code_id)->getNCols();
+        };
+        const auto frames = get_frame_specs(parser, registry, keys.size(), key_bits);
+        // build all codes concurrently (encoding only uses the mother codes)
+        auto preloading = registry.preload(pool, preload_options_for_frames(frames, false));
+        const auto key_offsets = frame_offsets(frames, [&](const FrameSpec &f) { return packed_size(key_bits(f)); });
+        check_file_size(keys, key_offsets, "key");
+
+        std::cout << "Key path: '" << key_path << "'\n";
+        std::cout << "Number of frames: " << frames.size() << '\n';
+        std::cout << "Threads: " << pool.size() << '\n' << std::endl;
+
+        std::ofstream output(output_path, std::ios::binary);
+        std::ofstream status(status_path);
+        if (!output || !status) {
+            throw std::runtime_error("Failed to open output files.");
+        }
+        status << "frame,code_id,syndrome_size\n";
+
+        const auto begin = std::chrono::steady_clock::now();
+
+        // Frames are encoded in parallel, while results are written in order.
+        // Limiting the number of frames in flight bounds the memory used.
+        const std::size_t max_in_flight = 4 * pool.size();
+        std::deque<std::future<std::vector<std::uint8_t>>> in_flight;
+        std::size_t n_written{};
+
+        auto write_oldest = [&]() {
+            const auto packed_syndrome = in_flight.front().get();
+            in_flight.pop_front();
+            output.write(reinterpret_cast<const char *>(packed_syndrome.data()),
+                         static_cast<std::streamsize>(packed_syndrome.size()));
+            status << n_written << ',' << frames[n_written].code_id << ','
+                   << frames[n_written].syndrome_size << '\n';
+            n_written++;
+        };
+
+        for (std::size_t i{}; i < frames.size(); ++i) {
+            if (in_flight.size() == max_in_flight) {
+                write_oldest();
+            }
+            in_flight.push_back(pool.submit([&registry, &keys, &key_offsets, frame = frames[i], i]() {
+                const auto H = registry.get_mother_code(frame.code_id);
+                std::vector<std::uint8_t> key;
+                unpack_bits(keys.data() + key_offsets[i], H->getNCols(), key);
+                std::vector<std::uint8_t> syndrome;
+                H->encode_with_ra(key, syndrome, frame.syndrome_size);
+                return pack_bits(syndrome);
+            }));
+        }
+        while (!in_flight.empty()) {
+            write_oldest();
+        }
+        // rethrows errors of the background builds (a frame may not have needed the failed build)
+        for (auto &f: preloading) {
+            f.get();
+        }
+
+        const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        std::cout << "DONE! Encoded " << frames.size() << " frames (" << keys.size() << " bytes) in " << seconds
+                  << " seconds.\n";
+        std::cout << "Syndromes saved to '" << output_path << "'\n";
+        std::cout << "Status saved to '" << status_path << "'" << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    exit(EXIT_SUCCESS);
+}
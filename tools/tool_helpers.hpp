@@ -0,0 +1,325 @@
+//
+// Created by alice on 18.10.26.
+//
+// Shared code of the command line tools `ldpc_encode` and `ldpc_decode`:
+// memory mapped input files, packed bit storage, per-frame code and rate specification and code selection.
+//
+// File formats used by the tools:
+//  - Packed bits: bit `i` of a frame is stored in byte `i / 8` at bit position `i % 8` (least significant bit first).
+//    Every frame starts at a byte boundary, i.e., a frame of `n` bits occupies `ceil(n / 8)` bytes.
+//    Keys, noisy keys and syndromes are stored as consecutive packed frames.
+//  - LLRs: 32 bit floats (host byte order), one per key bit, consecutive frames.
+//  - Frames file: csv with header `frame,code_id,syndrome_size` (further columns are ignored).
+//    The status file written by `ldpc_encode` is a valid frames file for `ldpc_decode`.
+
+#ifndef LDPC4QKD_TOOL_HELPERS_HPP
+#define LDPC4QKD_TOOL_HELPERS_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if __has_include(<sys/mman.h>) && __has_include(<sys/stat.h>) && __has_include(<fcntl.h>) && __has_include(<unistd.h>)
+#define LDPC4QKD_TOOLS_USE_MMAP
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#endif
+
+// Command line argument parser library
+#include "external/CmdParser-91aaa61e/cmdparser.hpp"
+
+// Project scope
+#include "LDPC4QKD/code_registry.hpp"
+#include "LDPC4QKD/embedded_codes.hpp"
+#include "benchmarks_error_rate/code_simulation_helpers.hpp"
+
+
+namespace LDPC4QKD::ToolHelpers {
+
+    /*!
+     * Read-only view of a whole file.
+     * Uses a memory mapping where available (POSIX), such that the operating system reads the file on demand
+     * and large files do not need to fit into memory. Otherwise, the file is read into a buffer.
+     */
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string &file_path) {
+#ifdef LDPC4QKD_TOOLS_USE_MMAP
+            const int fd = ::open(file_path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                throw std::runtime_error("Failed to open file '" + file_path + "'.");
+            }
+            struct stat file_status{};
+            if (::fstat(fd, &file_status) != 0) {
+                ::close(fd);
+                throw std::runtime_error("Failed to get size of file '" + file_path + "'.");
+            }
+            n_bytes = static_cast<std::size_t>(file_status.st_size);
+            if (n_bytes > 0) {
+                void *mapping = ::mmap(nullptr, n_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapping == MAP_FAILED) {
+                    ::close(fd);
+                    throw std::runtime_error("Failed to memory map file '" + file_path + "'.");
+                }
+                ::madvise(mapping, n_bytes, MADV_SEQUENTIAL);  // tools read files front to back.
+                mapped = mapping;
+                bytes = static_cast<const std::uint8_t *>(mapping);
+            }
+            ::close(fd);  // the mapping stays valid after closing the file descriptor.
+#else
+            std::ifstream fs(file_path, std::ios::binary);
+            if (!fs) {
+                throw std::runtime_error("Failed to open file '" + file_path + "'.");
+            }
+            buffer.assign(std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>());
+            n_bytes = buffer.size();
+            bytes = reinterpret_cast<const std::uint8_t *>(buffer.data());
+#endif
+        }
+
+        MappedFile(const MappedFile &) = delete;
+
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        ~MappedFile() {
+#ifdef LDPC4QKD_TOOLS_USE_MMAP
+            if (mapped != nullptr) {
+                ::munmap(mapped, n_bytes);
+            }
+#endif
+        }
+
+        [[nodiscard]] const std::uint8_t *data() const {
+            return bytes;
+        }
+
+        [[nodiscard]] std::size_t size() const {
+            return n_bytes;
+        }
+
+    private:
+#ifdef LDPC4QKD_TOOLS_USE_MMAP
+        void *mapped = nullptr;
+#else
+        std::vector<char> buffer;
+#endif
+        const std::uint8_t *bytes = nullptr;
+        std::size_t n_bytes{};
+    };
+
+
+    /// Number of bytes used to store `n_bits` packed bits.
+    constexpr std::size_t packed_size(std::size_t n_bits) {
+        return (n_bits + 7) / 8;
+    }
+
+    /// Unpack `n_bits` bits starting at `in` (see file header for the bit order).
+    template<typename Bit>
+    void unpack_bits(const std::uint8_t *in, std::size_t n_bits, std::vector<Bit> &out) {
+        out.resize(n_bits);
+        for (std::size_t i{}; i < n_bits; ++i) {
+            out[i] = static_cast<Bit>((in[i / 8] >> (i % 8)) & 1u);
+        }
+    }
+
+    /// Pack bits (see file header for the bit order). The last byte is padded with zeros.
+    template<typename Bit>
+    std::vector<std::uint8_t> pack_bits(const std::vector<Bit> &in) {
+        std::vector<std::uint8_t> out(packed_size(in.size()));
+        for (std::size_t i{}; i < in.size(); ++i) {
+            if (in[i]) {
+                out[i / 8] = static_cast<std::uint8_t>(out[i / 8] | (1u << (i % 8)));
+            }
+        }
+        return out;
+    }
+
+    /// Code and syndrome size (i.e., rate) of one frame.
+    struct FrameSpec {
+        std::size_t code_id{};
+        std::size_t syndrome_size{};
+    };
+
+    /// Read frames file (see file header).
+    inline std::vector<FrameSpec> read_frame_specs(const std::string &file_path) {
+        try {
+            std::ifstream fs(file_path);
+            if (!fs) {
+                throw std::runtime_error("Stream object invalid.");
+            }
+
+            std::string current_line;
+            getline(fs, current_line);  // ignores header
+
+            std::vector<FrameSpec> frames;
+            while (getline(fs, current_line)) {
+                if (current_line.find_first_not_of(" \t\r") == std::string::npos) {
+                    continue;  // ignores empty lines
+                }
+                const auto values = LDPC4QKD::HelpersReadFilesLDPC::helper_parse_sep_ints<std::size_t>(
+                        current_line, ',');
+                if (values.size() < 3) {
+                    throw std::runtime_error("Expected columns frame,code_id,syndrome_size.");
+                }
+                if (values[0] != frames.size()) {
+                    throw std::runtime_error("Frames are not numbered consecutively starting from zero.");
+                }
+                frames.push_back({values[1], values[2]});
+            }
+            return frames;
+        }
+        catch (const std::exception &e) {
+            std::stringstream s;
+            s << "Failed to read frames from file '" << file_path << "'. Reason:\n" << e.what() << "\n";
+            throw std::runtime_error(s.str());
+        }
+    }
+
+    /// Options selecting the available codes and the code and rate of each frame (shared by the tools).
+    inline void configure_code_options(cli::Parser &parser) {
+        parser.set_optional<std::string>(
+                "cp", "code-paths", "",
+                "Comma separated list of files containing additional LDPC codes "
+                "(`.cscmat`, `.bincsc.json`, `.qccsc.json`, `.alist` or `.cscbin` format). "
+                "These get the code_ids following the embedded codes.");
+
+        parser.set_optional<std::string>(
+                "rp", "rate-adaption-paths", "",
+                "Comma separated list of rate adaption files (`csv` format), one for each of `--code-paths`.");
+
+        parser.set_optional<std::size_t>(
+                "c", "code-id", 0,
+                "code_id used for every frame (if no frames file is given). Embedded codes come first, "
+                "in the order of `LDPC4QKD::all_encoders_tuple`.");
+
+        parser.set_optional<std::size_t>(
+                "ss", "syndrome-size", 0,
+                "Syndrome size used for every frame (if no frames file is given). "
+                "Specify zero to use the code without rate adaption.");
+
+        parser.set_optional<std::string>(
+                "fp", "frames-path", "",
+                "Frames file (csv with header `frame,code_id,syndrome_size`) specifying code and rate per frame. "
+                "Overrides `--code-id` and `--syndrome-size`.");
+
+        parser.set_optional<std::size_t>(
+                "t", "threads", 0,
+                "Number of worker threads. Specify zero to use all available cores.");
+    }
+
+    /// Adds embedded codes and codes given by the options of `configure_code_options` to the registry.
+    template<typename idx_t>
+    void add_codes_from_options(cli::Parser &parser, CodeRegistry<idx_t> &registry) {
+        add_embedded_codes(registry);
+
+        const auto code_paths_option = parser.get<std::string>("cp");
+        const auto rate_adaption_paths_option = parser.get<std::string>("rp");
+        if (code_paths_option.empty()) {
+            return;
+        }
+        const auto code_paths = CodeSimulationHelpers::parse_comma_separated<std::string>(code_paths_option);
+        auto rate_adaption_paths = rate_adaption_paths_option.empty()
+                                   ? std::vector<std::string>{}
+                                   : CodeSimulationHelpers::parse_comma_separated<std::string>(
+                        rate_adaption_paths_option);
+        if (!rate_adaption_paths.empty() && rate_adaption_paths.size() != code_paths.size()) {
+            throw std::runtime_error("Expected one rate adaption path per code path.");
+        }
+        rate_adaption_paths.resize(code_paths.size());
+
+        for (std::size_t i{}; i < code_paths.size(); ++i) {
+            registry.add_code(code_paths[i], [code_path = code_paths[i], ra_path = rate_adaption_paths[i]]() {
+                return CodeSimulationHelpers::load_ldpc<bool, std::uint32_t, idx_t>(code_path, ra_path);
+            });
+        }
+    }
+
+    /*!
+     * Code and syndrome size of every frame, from the frames file or from the options `--code-id` and
+     * `--syndrome-size`. In the latter case, the number of frames is determined from the size of a data file.
+     *
+     * @param parser parsed command line options (see `configure_code_options`)
+     * @param registry registry containing all codes
+     * @param data_file_size size of a file holding packed data of every frame
+     * @param data_bits_per_frame function returning the number of bits of `data_file_size` per frame
+     */
+    template<typename idx_t, typename F>
+    std::vector<FrameSpec> get_frame_specs(cli::Parser &parser, CodeRegistry<idx_t> &registry,
+                                           std::size_t data_file_size, F data_bits_per_frame) {
+        const auto frames_path = parser.get<std::string>("fp");
+        if (!frames_path.empty()) {
+            return read_frame_specs(frames_path);
+        }
+
+        FrameSpec spec{parser.get<std::size_t>("c"), parser.get<std::size_t>("ss")};
+        if (spec.syndrome_size == 0) {
+            spec.syndrome_size = registry.get_mother_code(spec.code_id)->get_n_rows_mother_matrix();
+        }
+        const auto bytes_per_frame = packed_size(data_bits_per_frame(spec));
+        if (data_file_size % bytes_per_frame != 0) {
+            std::stringstream s;
+            s << "File size " << data_file_size << " is not a multiple of the frame size " << bytes_per_frame
+              << " bytes (code " << spec.code_id << ", syndrome size " << spec.syndrome_size << ").";
+            throw std::runtime_error(s.str());
+        }
+        return std::vector<FrameSpec>(data_file_size / bytes_per_frame, spec);
+    }
+
+    /*!
+     * Preload the codes used by `frames` (see `CodeRegistry::preload`).
+     *
+     * @param frames code and rate of every frame
+     * @param rates if true, also build every rate that is used and `n_workspaces` decoder workspaces per rate
+     */
+    inline PreloadOptions preload_options_for_frames(const std::vector<FrameSpec> &frames, bool rates,
+                                                     std::size_t n_workspaces = 0) {
+        std::set<std::size_t> code_ids;
+        std::set<std::pair<std::size_t, std::size_t>> used_rates;
+        for (const auto &frame: frames) {
+            code_ids.insert(frame.code_id);
+            used_rates.emplace(frame.code_id, frame.syndrome_size);
+        }
+
+        PreloadOptions options;
+        options.code_ids.assign(code_ids.begin(), code_ids.end());
+        if (rates) {
+            options.rates.assign(used_rates.begin(), used_rates.end());
+            options.workspaces_per_rate = n_workspaces;
+        }
+        return options;
+    }
+
+    /// Byte offset of each frame (and of the end of the last frame) in a file with packed data of every frame.
+    template<typename F>
+    std::vector<std::size_t> frame_offsets(const std::vector<FrameSpec> &frames, F bytes_per_frame) {
+        std::vector<std::size_t> offsets(frames.size() + 1);
+        for (std::size_t i{}; i < frames.size(); ++i) {
+            offsets[i + 1] = offsets[i] + bytes_per_frame(frames[i]);
+        }
+        return offsets;
+    }
+
+    /// Throws unless `file` contains exactly the bytes described by `offsets` (see `frame_offsets`).
+    inline void check_file_size(const MappedFile &file, const std::vector<std::size_t> &offsets,
+                                const std::string &description) {
+        if (file.size() != offsets.back()) {
+            std::stringstream s;
+            s << "Size of " << description << " file is " << file.size() << " bytes. Expected " << offsets.back()
+              << " bytes (for " << offsets.size() - 1 << " frames).";
+            throw std::runtime_error(s.str());
+        }
+    }
+
+}
+
+#endif //LDPC4QKD_TOOL_HELPERS_HPP